@@ -3,29 +3,67 @@
 
 #include <cadmium/modeling/devs/atomic.hpp>
 #include <limits>
+#include <algorithm>
+#include <memory>
 #include "customer_data.hpp"
+#include "fork_queue.hpp"
+#include "empirical_distribution.hpp"
+#include "random_streams.hpp"
+#include "live_metrics.hpp"
+#include "lifecycle_trace.hpp"
+#include "time_weighted.hpp"
 
 using namespace cadmium;
 
+// Till data for one lane (see till_profile.hpp). The defaults keep the
+// deterministic numItems * timePerItem.
+struct LaneService {
+    std::shared_ptr<const EmpiricalDistribution> perItem;  // seconds per item; nullptr = timePerItem
+    double   speed      = 1.0;     // this cashier's relative speed; service time is divided by it
+    uint64_t key        = 0;       // keyed stream for perItem draws (random_streams.hpp)
+    bool     antithetic = false;
+    IpaParam ipaParam   = IpaParam::CASH_ITEM;   // which per-item time scales this lane
+
+    // Per-item time is drawn once per customer, keyed by their id, so the
+    // same customer gets the same draw on whichever lane they end up.
+    double serviceTime(double timePerItem, const CustomerData& cust) const {
+        const double tpi = perItem
+            ? perItem->sample(keyedUniform(key, static_cast<uint64_t>(cust.customerId), antithetic))
+            : timePerItem;
+        const double t = (cust.numItems > 0) ? (static_cast<double>(cust.numItems) * tpi) : tpi;
+        return t / speed;
+    }
+};
+
 struct CashState {
     enum class Phase { IDLE, BUSY } phase;
     int laneId;
     double timePerItem;
     double sigma;
+    double clock = 0.0;           // simulated time, for trace timestamps
     CustomerData current;
+    ForkQueue<CustomerData> q;   // customers Distributor assigned to this lane, waiting
+
+    double      lastDeparture = -std::numeric_limits<double>::infinity();
+    IpaGradient dLastDeparture;   // its derivative (ipa_gradient.hpp)
+
+    LevelIntegral busy;           // 1 while serving
+    LevelIntegral queued;         // q.size()
 
     CashState(int lane = 0, double tpi = 1.0)
         : phase(Phase::IDLE),
           laneId(lane),
           timePerItem(tpi),
           sigma(std::numeric_limits<double>::infinity()),
-          current() {}
+          current(),
+          q() {}
 };
 
 inline std::ostream& operator<<(std::ostream& os, const CashState& s) {
     os << "{phase:" << (s.phase == CashState::Phase::IDLE ? "idle" : "busy")
        << ",lane:" << s.laneId
        << ",sigma:" << s.sigma
+       << ",queued:" << s.q.size()
        << "}";
     return os;
 }
@@ -36,23 +74,41 @@ public:
     Port<CustomerData> out_toPayment; 
     Port<int>          out_free;      
 
-    Cash(const std::string& id, int lane, double timePerItem = 1.0)
-        : Atomic<CashState>(id, CashState(lane, timePerItem))
+    Cash(const std::string& id, int lane, double timePerItem = 1.0, LaneService service = LaneService())
+        : Atomic<CashState>(id, CashState(lane, timePerItem)),
+          service_(std::move(service))
     {
         in_customer   = addInPort<CustomerData>("in_customer");
         out_toPayment = addOutPort<CustomerData>("out_toPayment");
         out_free      = addOutPort<int>("out_free");
     }
 
-    void externalTransition(CashState& s, double /*e*/) const override {
-        if (s.phase == CashState::Phase::IDLE && !in_customer->empty()) {
-            s.current = in_customer->getBag().back();
-            s.phase = CashState::Phase::BUSY;
+    void externalTransition(CashState& s, double e) const override {
+        s.clock += e;
+        if (s.phase == CashState::Phase::BUSY) {
+            s.sigma = std::max(0.0, s.sigma - e);
+        }
+
+        if (in_customer->empty()) return;
 
-            s.sigma = (s.current.numItems > 0)
-                ? (static_cast<double>(s.current.numItems) * s.timePerItem)
-                : s.timePerItem;
+        // Distributor allows up to MAX_QUEUE customers per lane, so anyone
+        // arriving while the lane is busy waits here instead of being dropped.
+        for (const auto& arrived : in_customer->getBag()) {
+            CustomerData cust = arrived;
+            // Someone who waited at the entry and arrives as this lane frees
+            // was released by that departure, so arrives when it does
+            if (cust.arrivalTime < s.clock && s.lastDeparture == s.clock) cust.ipa = s.dLastDeparture;
+
+            if (s.phase == CashState::Phase::IDLE) {
+                startService(s, cust, cust.ipa);
+            } else {
+                s.q.push(cust);
+                traceBegin(s.clock, cust, TraceStage::LANE_QUEUE, s.laneId);
+            }
         }
+
+        updateStats(s);
+        if (metrics_) metrics_->lane(s.laneId, true, s.q.size());
     }
 
     void output(const CashState& s) const override {
@@ -63,9 +119,24 @@ public:
     }
 
     void internalTransition(CashState& s) const override {
-        s.phase = CashState::Phase::IDLE;
-        s.sigma = std::numeric_limits<double>::infinity();
-        s.current = CustomerData();
+        s.clock += s.sigma;
+        traceEnd(s.clock, s.current, TraceStage::CHECKOUT, s.laneId);
+        s.lastDeparture  = s.clock;
+        s.dLastDeparture = s.current.ipa;
+
+        if (!s.q.empty()) {
+            const CustomerData next = s.q.front();
+            s.q.pop();
+            traceEnd(s.clock, next, TraceStage::LANE_QUEUE, s.laneId);
+            startService(s, next, s.dLastDeparture);
+        } else {
+            s.phase = CashState::Phase::IDLE;
+            s.sigma = std::numeric_limits<double>::infinity();
+            s.current = CustomerData();
+        }
+
+        updateStats(s);
+        if (metrics_) metrics_->lane(s.laneId, s.phase == CashState::Phase::BUSY, s.q.size());
     }
 
     [[nodiscard]] double timeAdvance(const CashState& s) const override {
@@ -73,6 +144,48 @@ public:
             ? std::numeric_limits<double>::infinity()
             : s.sigma;
     }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const CashState& getState() const { return state; }
+    void setState(const CashState& s) { state = s; }
+
+    // Per-item draws are keyed by customer, so the stream key is the whole RNG state.
+    using RngState = uint64_t;
+    RngState getRng() const { return service_.key; }
+    void setRng(RngState r) { service_.key = r; }
+
+    // Optional live metrics feed (see live_metrics.hpp)
+    void setMetrics(LiveMetricsWriter* metrics) { metrics_ = metrics; }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp)
+    StationKpis kpis(double now) const {
+        StationKpis k;
+        k.busyTime    = state.busy.integral(now);
+        k.utilisation = state.busy.mean(now);
+        k.meanQueue   = state.queued.mean(now);
+        return k;
+    }
+
+private:
+    LiveMetricsWriter* metrics_ = nullptr;
+    LaneService        service_;
+
+    static void updateStats(CashState& s) {
+        s.busy.set(s.clock, s.phase == CashState::Phase::BUSY ? 1.0 : 0.0);
+        s.queued.set(s.clock, static_cast<double>(s.q.size()));
+    }
+
+    // `dStart` is the derivative of now: the customer's arrival, or the
+    // departure that freed the lane
+    void startService(CashState& s, const CustomerData& cust, const IpaGradient& dStart) const {
+        s.current = cust;
+        // Everything between store entry and now was spent queueing
+        s.current.waited = std::max(0.0, s.clock - cust.arrivalTime);
+        s.phase = CashState::Phase::BUSY;
+        traceBegin(s.clock, cust, TraceStage::CHECKOUT, s.laneId);
+        s.sigma = service_.serviceTime(s.timePerItem, cust);
+        s.current.ipa = dStart.plusService(service_.ipaParam, s.sigma);
+    }
 };
 
-#endif 
+#endif
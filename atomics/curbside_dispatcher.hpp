@@ -3,18 +3,25 @@
 
 #include <cadmium/modeling/devs/atomic.hpp>
 #include <limits>
-#include <queue>
 #include <algorithm>
 #include "customer_data.hpp"
+#include "reneging_queue.hpp"
+#include "lifecycle_trace.hpp"
+#include "time_weighted.hpp"
 
 using namespace cadmium;
 
 struct CurbsideDispatcherState {
     enum class Phase { IDLE, BUSY } phase;
-    double sigma;
+    double sigma;          // time until `current` is picked up
+    double clock = 0.0;    // simulated time, for patience deadlines
 
     CustomerData current;
-    std::queue<CustomerData> q;
+    RenegingQueue<CustomerData> q;   // waiting orders are abandoned at enqueue time + patience
+    long reneged = 0;
+
+    LevelIntegral busy;      // 1 while a pickup is in progress
+    LevelIntegral queued;    // q.size()
 
     CurbsideDispatcherState()
         : phase(Phase::IDLE),
@@ -27,6 +34,7 @@ inline std::ostream& operator<<(std::ostream& os, const CurbsideDispatcherState&
     os << "{phase:" << (s.phase == CurbsideDispatcherState::Phase::IDLE ? "idle" : "busy")
        << ",sigma:" << s.sigma
        << ",queued:" << s.q.size()
+       << ",reneged:" << s.reneged
        << "}";
     return os;
 }
@@ -44,6 +52,7 @@ public:
     }
 
     void externalTransition(CurbsideDispatcherState& s, double e) const override {
+        s.clock += e;
         if (s.phase == CurbsideDispatcherState::Phase::BUSY) {
             s.sigma = std::max(0.0, s.sigma - e);
         }
@@ -55,33 +64,84 @@ public:
                 s.current = order;
                 s.phase = CurbsideDispatcherState::Phase::BUSY;
                 s.sigma = std::max(0.0, order.travelTime); // "time until pickup"
+                s.current.ipa = order.ipa.plusService(IpaParam::PICKUP, s.sigma);
+                traceBegin(s.clock, order, TraceStage::PICKUP);
             } else {
-                s.q.push(order);
+                s.q.push(order, s.clock + order.patience);
+                traceBegin(s.clock, order, TraceStage::CURB_QUEUE);
             }
         }
+        updateStats(s);
     }
 
     void output(const CurbsideDispatcherState& s) const override {
-        if (s.phase == CurbsideDispatcherState::Phase::BUSY) {
+        if (pickupDue(s)) {
             finished->addMessage(s.current);
         }
     }
 
     void internalTransition(CurbsideDispatcherState& s) const override {
+        if (!pickupDue(s)) {
+            // A waiting customer gave up before the current pickup finished
+            const double wait = s.q.nextDeadline() - s.clock;
+            s.clock = s.q.nextDeadline();
+            if (s.phase == CurbsideDispatcherState::Phase::BUSY) s.sigma = std::max(0.0, s.sigma - wait);
+            while (!s.q.empty() && s.q.nextDeadline() <= s.clock) {
+                const CustomerData gone = s.q.popExpired();
+                traceEnd(s.clock, gone, TraceStage::CURB_QUEUE);
+                traceInstant(s.clock, gone, TraceStage::RENEGED, static_cast<int>(TraceStage::CURB_QUEUE));
+                ++s.reneged;
+            }
+            updateStats(s);
+            return;
+        }
+
+        s.clock += s.sigma;
+        traceEnd(s.clock, s.current, TraceStage::PICKUP);
         if (!s.q.empty()) {
-            s.current = s.q.front();
-            s.q.pop();
+            // IPA: starts when the previous pickup ends (ipa_gradient.hpp)
+            const IpaGradient dFreed = s.current.ipa;
+            s.current = s.q.pop();
             s.phase = CurbsideDispatcherState::Phase::BUSY;
             s.sigma = std::max(0.0, s.current.travelTime);
+            s.current.ipa = dFreed.plusService(IpaParam::PICKUP, s.sigma);
+            traceEnd(s.clock, s.current, TraceStage::CURB_QUEUE);
+            traceBegin(s.clock, s.current, TraceStage::PICKUP);
         } else {
             s.phase = CurbsideDispatcherState::Phase::IDLE;
             s.sigma = std::numeric_limits<double>::infinity();
             s.current = CustomerData();
         }
+        updateStats(s);
     }
 
     [[nodiscard]] double timeAdvance(const CurbsideDispatcherState& s) const override {
-        return s.sigma;
+        return std::min(s.sigma, std::max(0.0, s.q.nextDeadline() - s.clock));
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const CurbsideDispatcherState& getState() const { return state; }
+    void setState(const CurbsideDispatcherState& s) { state = s; }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp)
+    StationKpis kpis(double now) const {
+        StationKpis k;
+        k.busyTime    = state.busy.integral(now);
+        k.utilisation = state.busy.mean(now);
+        k.meanQueue   = state.queued.mean(now);
+        return k;
+    }
+
+private:
+    static void updateStats(CurbsideDispatcherState& s) {
+        s.busy.set(s.clock, s.phase == CurbsideDispatcherState::Phase::BUSY ? 1.0 : 0.0);
+        s.queued.set(s.clock, static_cast<double>(s.q.size()));
+    }
+
+    // The next event completes the current pickup (ties go to the pickup)
+    static bool pickupDue(const CurbsideDispatcherState& s) {
+        return s.phase == CurbsideDispatcherState::Phase::BUSY
+            && s.sigma <= s.q.nextDeadline() - s.clock;
     }
 };
 
@@ -3,7 +3,9 @@
 
 #include <ostream>
 #include <istream>
+#include <limits>
 #include <string>
+#include "ipa_gradient.hpp"
 
 struct CustomerData {
     int    customerId    = -1;
@@ -12,6 +14,12 @@ struct CustomerData {
     bool   paymentType   = true;    // true = card/tap, false = cash
     double travelTime    = 0.0;     // used by Traveler + CurbsideDispatcher
     double searchTime    = 0.0;     // used by Packer
+    double arrivalTime   = 0.0;     // stamped by Distributor on store entry (not logged)
+    double patience      = std::numeric_limits<double>::infinity(); // longest wait in any one queue (not logged)
+    bool   traced        = false;   // sampled for lifecycle tracing (see lifecycle_trace.hpp; not logged)
+    double waited        = 0.0;     // time spent queueing for checkout and payment so far (not logged)
+    double queuedAt      = 0.0;     // when the customer joined the payment queue (not logged)
+    IpaGradient ipa;                // d(time it left its last station) per service scale (not logged)
 
     CustomerData() = default;
 
@@ -2,21 +2,32 @@
 #define CUSTOMER_SINK_HPP
 
 #include <cadmium/modeling/devs/atomic.hpp>
+#include <functional>
 #include <limits>
 #include "customer_data.hpp"
+#include "live_metrics.hpp"
+#include "lifecycle_trace.hpp"
 
 using namespace cadmium;
 
 struct CustomerSinkState {
     int count = 0;
+    double clock = 0.0;          // simulated time of the last arrival
+    double totalSojourn = 0.0;   // sum of (exit - arrivalTime) over all customers
+    IpaGradient totalDSojourn;   // its derivative per service scale (ipa_gradient.hpp)
+
+    double meanSojourn() const { return count > 0 ? totalSojourn / count : 0.0; }
+    // d(meanSojourn)/d(scale of p), with the customers served held fixed
+    double meanSojournDerivative(IpaParam p) const { return count > 0 ? totalDSojourn[p] / count : 0.0; }
 };
 
 inline std::ostream& operator<<(std::ostream& os, const CustomerSinkState& s) {
-    os << "{count:" << s.count << "}";
+    os << "{count:" << s.count << ",sojourn:" << s.meanSojourn() << "}";
     return os;
 }
 
-// Simple sink: consumes CustomerData messages and counts them (no outputs).
+// Simple sink: consumes CustomerData messages, counts them and accumulates
+// their time in the store (no outputs).
 class CustomerSink : public Atomic<CustomerSinkState> {
 public:
     Port<CustomerData> in;
@@ -27,10 +38,18 @@ public:
         in = addInPort<CustomerData>("in");
     }
 
-    void externalTransition(CustomerSinkState& s, double /*e*/) const override {
-        if (!in->empty()) {
-            s.count += static_cast<int>(in->getBag().size());
+    void externalTransition(CustomerSinkState& s, double e) const override {
+        s.clock += e;
+        for (const auto& cust : in->getBag()) {
+            const double sojourn = s.clock - cust.arrivalTime;
+            s.count++;
+            s.totalSojourn += sojourn;
+            s.totalDSojourn += cust.ipa;   // arrivals are exogenous, so d(sojourn) = d(exit)
+            if (observer_) observer_(s.clock, sojourn);
+            traceInstant(s.clock, cust, TraceStage::DONE);
         }
+
+        if (metrics_) metrics_->sinkCount(metricsSink_, s.count, s.clock);
     }
 
     void internalTransition(CustomerSinkState& /*s*/) const override {}
@@ -40,6 +59,25 @@ public:
     [[nodiscard]] double timeAdvance(const CustomerSinkState& /*s*/) const override {
         return std::numeric_limits<double>::infinity();
     }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const CustomerSinkState& getState() const { return state; }
+    void setState(const CustomerSinkState& s) { state = s; }
+
+    // Optional callback per customer (exit time, sojourn), used to stream
+    // observations into output analysis without logging.
+    void setObserver(std::function<void(double, double)> observer) { observer_ = std::move(observer); }
+
+    // Optional live metrics feed (see live_metrics.hpp)
+    void setMetrics(LiveMetricsWriter* metrics, LiveMetricsWriter::Sink which) {
+        metrics_ = metrics;
+        metricsSink_ = which;
+    }
+
+private:
+    std::function<void(double, double)> observer_;
+    LiveMetricsWriter* metrics_ = nullptr;
+    LiveMetricsWriter::Sink metricsSink_ = LiveMetricsWriter::Sink::WALKIN;
 };
 
 #endif // CUSTOMER_SINK_HPP
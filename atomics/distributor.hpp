@@ -4,25 +4,61 @@
 #include <cadmium/modeling/devs/atomic.hpp>
 #include <vector>
 #include <limits>
+#include <memory>
+#include <string>
 #include <algorithm>
+#include <functional>
 #include "customer_data.hpp"
+#include "routing_policy.hpp"
+#include "live_metrics.hpp"
+#include "reneging_queue.hpp"
+#include "lifecycle_trace.hpp"
+#include "time_weighted.hpp"
+#include "shift_schedule.hpp"
+#include "fluid_walkin.hpp"
 
 using namespace cadmium;
 
-// ---- FIXED LANE COUNTS ----
-static constexpr int CASH_LANES  = 3;
-static constexpr int SELF_LANES  = 2;
-static constexpr int TOTAL_LANES = CASH_LANES + SELF_LANES;
+// ---- Store entry queue: walk-ins wait here while every open lane is full
+static constexpr int ENTRY_CAPACITY   = 10;
+static constexpr int ENTRY_HIGH_WATER = 8;   // hold the Generator once this many wait
+static constexpr int ENTRY_LOW_WATER  = 2;   // let it resume once down to this many
 
-static constexpr int SELF_ITEM_LIMIT = 15;
-
-// ---- Max queue per lane (change be changed if wanted more)
-static constexpr int MAX_QUEUE = 2;
+struct EntryQueueLimits {
+    int capacity  = ENTRY_CAPACITY;    // arrivals beyond this are lost
+    int highWater = ENTRY_HIGH_WATER;
+    int lowWater  = ENTRY_LOW_WATER;
+};
 
 struct DistributorState {
     enum class Phase { IDLE, SEND } phase;
 
     std::vector<int> queues;
+    std::vector<double> busyUntil;   // when each lane clears the work routed to it
+    LaneMask open;                   // lanes taking new customers (shift_schedule.hpp)
+    std::mt19937 routeRng;           // draws for randomised routing policies (LaneLoad::rng)
+
+    double clock = 0.0;   // simulated time, used to stamp arrivalTime on entry
+
+    // Walk-ins waiting for a lane, in arrival order; each leaves at
+    // arrival + patience if no lane has freed up by then
+    RenegingQueue<CustomerData> entry;
+    long lost = 0;          // turned away because the entry queue was full
+    long reneged = 0;       // gave up waiting in the entry queue
+    bool holding = false;   // Generator has been told to hold
+
+    std::vector<LevelIntegral> laneLoad;   // queues[i] over time
+    LevelIntegral entryQueued;             // entry.size() over time
+    LevelIntegral busyLanes;               // servers with a customer assigned
+
+    // Hybrid mode (fluid_walkin.hpp): walk-ins pass through the fluid model
+    // while it is active. The window is only checked when hybrid mode is on.
+    FluidWalkin   fluid;
+    LevelIntegral inFluid;                 // 1 while fluid mode is active
+    double windowStart = 0.0;              // current switching window
+    double windowBusy  = 0.0;              // busyLanes.integral at windowStart
+    double modeSince   = 0.0;              // last switch in or out of fluid mode
+    std::vector<LaneHold> held;            // lanes finishing a fluid customer, who pays next; no new ones until then
 
     bool emitHold = false;
     bool emitOk   = false;
@@ -36,9 +72,16 @@ struct DistributorState {
     // Online orders bypass lanes
     std::vector<CustomerData> onlineOutbox;
 
-    DistributorState()
+    // Fluid customers going on to the PaymentProcessor
+    std::vector<CustomerData> payOutbox;
+    std::vector<PaymentProcessorState::Payment> payingOutbox;   // already at a terminal
+
+    explicit DistributorState(int lanes = TOTAL_LANES)
         : phase(Phase::IDLE),
-          queues(TOTAL_LANES, 0),
+          queues(lanes, 0),
+          busyUntil(lanes, 0.0),
+          open(lanes),
+          laneLoad(lanes),
           outbox(),
           onlineOutbox() {}
 };
@@ -51,8 +94,24 @@ inline std::ostream& operator<<(std::ostream& os, const DistributorState& s) {
     for (size_t i = 0; i < s.queues.size(); ++i) {
         os << s.queues[i] << (i + 1 < s.queues.size() ? "," : "");
     }
-    os << "],outbox:" << s.outbox.size()
-       << ",online:" << s.onlineOutbox.size() << "}";
+    os << "]";
+    // Closed lanes only appear once a shift schedule closes one
+    bool anyClosed = false;
+    for (size_t i = 0; i < s.queues.size(); ++i) {
+        if (s.open.test(static_cast<int>(i))) continue;
+        os << (anyClosed ? "," : ",closed:[") << i;
+        anyClosed = true;
+    }
+    if (anyClosed) os << "]";
+    os << ",outbox:" << s.outbox.size()
+       << ",online:" << s.onlineOutbox.size()
+       << ",waiting:" << s.entry.size()
+       << ",lost:" << s.lost
+       << ",reneged:" << s.reneged;
+    if (s.fluid.active() || s.fluid.pending() > 0) {
+        os << ",fluid:{on:" << (s.fluid.active() ? "1" : "0") << ",pending:" << s.fluid.pending() << "}";
+    }
+    os << "}";
     return os;
 }
 
@@ -61,13 +120,11 @@ public:
     // Inputs
     Port<CustomerData> in_customer;
     Port<int>          in_laneFreed; 
+    Port<LaneShift>    in_shift;        // lanes opening and closing (ShiftSchedule)
 
-    // Outputs to lanes
-    Port<CustomerData> out_cash0;
-    Port<CustomerData> out_cash1;
-    Port<CustomerData> out_cash2;
-    Port<CustomerData> out_self0;
-    Port<CustomerData> out_self1;
+    // Outputs to lanes, indexed by laneId: staffed lanes "out_cash<i>"
+    // first, then self-checkout lanes "out_self<i>".
+    std::vector<Port<CustomerData>> out_lanes;
     Port<CustomerData> out_online;
 
     // Feedback to Generator
@@ -76,69 +133,157 @@ public:
 
     Port<int> out_whichLane;
 
-    explicit Distributor(const std::string& id)
-        : Atomic<DistributorState>(id, DistributorState())
+    // Walk-ins leaving the store from fluid mode, at their exit times, and
+    // fluid customers handed to the PaymentProcessor when it ends
+    Port<CustomerData> out_walkinDone;
+    Port<CustomerData> out_payment;
+    Port<PaymentProcessorState::Payment> out_paying;
+
+    // policy picks the lane for each walk-in (see routing_policy.hpp);
+    // nullptr keeps the original shortest-queue rule. fluid turns on the
+    // hybrid mode for saturated lanes (fluid_walkin.hpp); off by default.
+    explicit Distributor(const std::string& id,
+                         const LaneLayout& layout = LaneLayout(),
+                         std::shared_ptr<const RoutingPolicy> policy = nullptr,
+                         const EntryQueueLimits& entry = EntryQueueLimits(),
+                         const FluidSettings& fluid = FluidSettings())
+        : Atomic<DistributorState>(id, DistributorState(layout.total())),
+          layout_(layout),
+          policy_(policy ? std::move(policy) : std::make_shared<ShortestQueuePolicy>()),
+          entry_(entry),
+          fluid_(fluid)
     {
+        state.routeRng.seed(policy_->seed());
+        fluid_.step = std::max(1e-9, fluid_.step);
+
+        entry_.capacity  = std::max(1, entry_.capacity);
+        entry_.highWater = std::clamp(entry_.highWater, 1, entry_.capacity);
+        entry_.lowWater  = std::clamp(entry_.lowWater, 0, entry_.highWater - 1);
+
         in_customer  = addInPort<CustomerData>("in_customer");
         in_laneFreed = addInPort<int>("in_laneFreed");
+        in_shift     = addInPort<LaneShift>("in_shift");
 
-        out_cash0 = addOutPort<CustomerData>("out_cash0");
-        out_cash1 = addOutPort<CustomerData>("out_cash1");
-        out_cash2 = addOutPort<CustomerData>("out_cash2");
-        out_self0 = addOutPort<CustomerData>("out_self0");
-        out_self1 = addOutPort<CustomerData>("out_self1");
+        for (int i = 0; i < layout_.cashLanes; ++i) {
+            out_lanes.push_back(addOutPort<CustomerData>("out_cash" + std::to_string(i)));
+        }
+        for (int i = 0; i < layout_.selfLanes; ++i) {
+            out_lanes.push_back(addOutPort<CustomerData>("out_self" + std::to_string(i)));
+        }
         out_online = addOutPort<CustomerData>("out_online");
 
         out_holdOff = addOutPort<bool>("out_holdOff");
         out_okGo     = addOutPort<bool>("out_okGo");
 
         out_whichLane = addOutPort<int>("out_whichLane");
+        out_walkinDone = addOutPort<CustomerData>("out_walkinDone");
+        out_payment    = addOutPort<CustomerData>("out_payment");
+        out_paying     = addOutPort<PaymentProcessorState::Payment>("out_paying");
     }
 
     void internalTransition(DistributorState& s) const override {
-        s.phase = DistributorState::Phase::IDLE;
-        s.emitHold = false;
-        s.emitOk   = false;
-        s.outbox.clear();
-        s.onlineOutbox.clear();
-    }
-
-    void externalTransition(DistributorState& s, double /*e*/) const override {
-        // 1) Apply lane freed events
-        if (!in_laneFreed->empty()) {
-            for (int laneId : in_laneFreed->getBag()) {
-                if (0 <= laneId && laneId < TOTAL_LANES && s.queues[laneId] > 0) {
-                    s.queues[laneId]--;
-                }
+        if (s.phase == DistributorState::Phase::SEND) {
+            s.phase = DistributorState::Phase::IDLE;
+            s.emitHold = false;
+            s.emitOk   = false;
+            s.outbox.clear();
+            s.onlineOutbox.clear();
+            s.payOutbox.clear();
+            s.payingOutbox.clear();
+            return;
+        }
+
+        // Idle wake-up: patience ran out for the customers at the earliest
+        // deadline, a fluid customer left, a held lane freed up, or the fluid
+        // entry queue went down
+        s.clock = nextWake(s);
+        s.fluid.update(s.clock);
+        while (!s.entry.empty() && s.entry.nextDeadline() <= s.clock) {
+            const CustomerData gone = s.entry.popExpired();
+            traceEnd(s.clock, gone, TraceStage::ENTRY_QUEUE);
+            traceInstant(s.clock, gone, TraceStage::RENEGED, static_cast<int>(TraceStage::ENTRY_QUEUE));
+            ++s.reneged;
+        }
+        if (releaseHolds(s)) routeWaiting(s);
+        s.fluid.advance(s.clock);
+        s.entryQueued.set(s.clock, static_cast<double>(waiting(s)));
+        flowControl(s);
+        hybridStep(s);
+        if (!s.outbox.empty() || !s.payOutbox.empty() || !s.payingOutbox.empty()) {
+            s.phase = DistributorState::Phase::SEND;
+        }
+        if (metrics_) metrics_->entryQueue(s.entry.size(), s.lost);
+    }
+
+    void externalTransition(DistributorState& s, double e) const override {
+        s.clock += e;
+
+        // 1) Apply lane freed events (and lanes the fluid has finished with),
+        // then shift changes. A closed lane takes no new customers but still
+        // serves the ones assigned to it.
+        s.fluid.update(s.clock);
+        releaseHolds(s);
+        for (int laneId : in_laneFreed->getBag()) freeLanePlace(s, laneId);
+        for (const LaneShift& shift : in_shift->getBag()) {
+            if (0 <= shift.lane && shift.lane < static_cast<int>(s.queues.size())) {
+                s.open.set(shift.lane, shift.open);
             }
-            // "OK" pulse tells Generator it can resume (if it was paused)
-            s.emitOk = true;
-            s.phase  = DistributorState::Phase::SEND;
         }
 
-        // 2) Route customers
+        // 2) Freed and newly opened lanes go to the customers already waiting at the entrance.
+        routeWaiting(s);
+
+        // 3) Route arrivals; they queue behind anyone already waiting. In
+        // fluid mode walk-ins join the fluid model instead.
+        s.fluid.advance(s.clock);
         if (!in_customer->empty()) {
-            for (const CustomerData& cust : in_customer->getBag()) {
+            for (CustomerData cust : in_customer->getBag()) {
+                cust.arrivalTime = s.clock;
+                traceInstant(s.clock, cust, TraceStage::ARRIVE);
                 if (cust.isOnlineOrder) {
                     s.onlineOutbox.push_back(cust);
-                    s.phase = DistributorState::Phase::SEND;
                     continue;
                 }
-                const int lane = chooseLane(s, cust);
-                if (lane >= 0) {
-                    s.queues[lane]++;
-                    s.outbox.push_back({lane, cust});
+                if (s.fluid.active()) {
+                    if (waiting(s) < entry_.capacity) {
+                        admitFluid(s, cust);
+                    } else {
+                        traceInstant(s.clock, cust, TraceStage::LOST);
+                        ++s.lost;
+                    }
+                    continue;
+                }
+                if (s.entry.empty() && route(s, cust)) continue;
+                if (static_cast<int>(s.entry.size()) < entry_.capacity) {
+                    s.entry.push(cust, s.clock + cust.patience);
+                    traceBegin(s.clock, cust, TraceStage::ENTRY_QUEUE);
                 } else {
-                    // No lane had space: ask Generator to hold
-                    s.emitHold = true;
+                    traceInstant(s.clock, cust, TraceStage::LOST);
+                    ++s.lost;
                 }
-                s.phase = DistributorState::Phase::SEND;
             }
         }
+
+        s.entryQueued.set(s.clock, static_cast<double>(waiting(s)));
+
+        // 4) Flow control: signal the Generator only on watermark crossings
+        flowControl(s);
+        hybridStep(s);
+        if (!s.outbox.empty() || !s.onlineOutbox.empty() || !s.payOutbox.empty() || !s.payingOutbox.empty()) {
+            s.phase = DistributorState::Phase::SEND;
+        }
+
+        if (metrics_) {
+            metrics_->laneQueues(s.queues, s.clock);
+            metrics_->entryQueue(s.entry.size(), s.lost);
+        }
     }
 
     void output(const DistributorState& s) const override {
-        if (s.phase != DistributorState::Phase::SEND) return;
+        if (s.phase != DistributorState::Phase::SEND) {
+            if (const CustomerData* done = s.fluid.leaving(nextWake(s))) out_walkinDone->addMessage(*done);
+            return;
+        }
 
         if (s.emitHold) out_holdOff->addMessage(true);
         if (s.emitOk)   out_okGo->addMessage(true);
@@ -146,49 +291,271 @@ public:
         for (const auto& r : s.outbox) {
             out_whichLane->addMessage(r.lane);
 
-            if (r.lane == 0)      out_cash0->addMessage(r.cust);
-            else if (r.lane == 1) out_cash1->addMessage(r.cust);
-            else if (r.lane == 2) out_cash2->addMessage(r.cust);
-            else if (r.lane == 3) out_self0->addMessage(r.cust);
-            else if (r.lane == 4) out_self1->addMessage(r.cust);
+            if (0 <= r.lane && r.lane < static_cast<int>(out_lanes.size())) {
+                out_lanes[r.lane]->addMessage(r.cust);
+            }
         }
 
         for (const auto& cust : s.onlineOutbox) {
             out_online->addMessage(cust);
         }
+        for (const auto& cust : s.payOutbox) out_payment->addMessage(cust);
+        for (const auto& p : s.payingOutbox) out_paying->addMessage(p);
     }
 
     [[nodiscard]] double timeAdvance(const DistributorState& s) const override {
-        return (s.phase == DistributorState::Phase::IDLE)
-            ? std::numeric_limits<double>::infinity()
-            : 0.0;
+        if (s.phase == DistributorState::Phase::SEND) return 0.0;
+        return std::max(0.0, nextWake(s) - s.clock);   // infinity when nobody can renege
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const DistributorState& getState() const { return state; }
+    void setState(const DistributorState& s) { state = s; }
+
+    // Optional live metrics feed (see live_metrics.hpp)
+    void setMetrics(LiveMetricsWriter* metrics) { metrics_ = metrics; }
+
+    // What the PaymentProcessor and traveler have left at a given time, read
+    // when fluid mode starts (fluid_walkin.hpp). Without it the fluid's
+    // terminals start free.
+    void setDiscreteBacklog(std::function<DiscreteBacklog(double)> backlog) { backlog_ = std::move(backlog); }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp)
+    struct Kpis {
+        std::vector<double> meanLaneLoad;   // customers assigned per lane (in service + waiting)
+        double meanEntryQueue = 0.0;
+    };
+    Kpis kpis(double now) const {
+        Kpis k;
+        for (const auto& lane : state.laneLoad) k.meanLaneLoad.push_back(lane.mean(now));
+        k.meanEntryQueue = state.entryQueued.mean(now);
+        return k;
+    }
+
+    // Hybrid mode counters up to `now` (all zero when it is off)
+    struct HybridStats {
+        long   episodes = 0, admitted = 0, handedBack = 0, handedToPayment = 0;
+        long   renegedEntry = 0, renegedPayment = 0, missedTraveler = 0;
+        double fluidFraction = 0.0;   // share of the run spent in fluid mode
+    };
+    HybridStats hybrid(double now) const {
+        const FluidWalkin& f = state.fluid;
+        return {f.episodes, f.admitted, f.handedBack, f.handedToPayment,
+                f.renegedEntry, f.renegedPayment, f.missedTraveler, state.inFluid.mean(now)};
     }
 
 private:
-    // Prefer self-checkout for <= SELF_ITEM_LIMIT, else staffed cash.
-    // Within the chosen group: pick the smallest queue with available space.
-    static int chooseLane(const DistributorState& s, const CustomerData& cust) {
-        auto pickSmallest = [&](int start, int count) -> int {
-            int best = -1;
-            int bestLen = 1e9;
-            for (int i = 0; i < count; ++i) {
-                const int lane = start + i;
-                if (s.queues[lane] < MAX_QUEUE && s.queues[lane] < bestLen) {
-                    best = lane;
-                    bestLen = s.queues[lane];
-                }
+    LiveMetricsWriter* metrics_ = nullptr;
+    std::function<DiscreteBacklog(double)> backlog_;
+
+    LaneLayout layout_;
+    std::shared_ptr<const RoutingPolicy> policy_;
+    EntryQueueLimits entry_;
+    FluidSettings fluid_;
+
+    // Walk-ins waiting to get into a lane. In fluid mode, those not yet at a
+    // lane beyond the lanes' own queue places.
+    int waiting(const DistributorState& s) const {
+        if (!s.fluid.active()) return static_cast<int>(s.entry.size());
+        return std::max(0, s.fluid.notStarted() - laneQueuePlaces(s));
+    }
+    int laneQueuePlaces(const DistributorState& s) const {
+        int n = 0;
+        for (int i = 0; i < static_cast<int>(s.queues.size()); ++i) {
+            if (s.open.test(i)) n += layout_.capacity(i) - layout_.servers(i);
+        }
+        return n;
+    }
+    // Servers (staffed lanes and kiosks) behind the open lanes
+    int openServers(const DistributorState& s) const {
+        int n = 0;
+        for (int i = 0; i < static_cast<int>(s.queues.size()); ++i) n += s.open.test(i) ? layout_.servers(i) : 0;
+        return n;
+    }
+
+    // Next idle wake-up: a reneging deadline, a fluid exit, a held lane
+    // freeing up, or (while the Generator is held in fluid mode) the fluid
+    // queue reaching lowWater
+    double nextWake(const DistributorState& s) const {
+        double t = std::min(s.entry.nextDeadline(), s.fluid.nextEvent());
+        for (const LaneHold& h : s.held) t = std::min(t, h.until);
+        if (s.holding && s.fluid.active()) {
+            t = std::min(t, s.fluid.timeNotStartedReaches(entry_.lowWater + laneQueuePlaces(s)));
+        }
+        return t;
+    }
+
+    void flowControl(DistributorState& s) const {
+        const int waiting = this->waiting(s);
+        if (!s.holding && waiting >= entry_.highWater) {
+            s.holding  = true;
+            s.emitHold = true;
+            s.emitOk   = false;
+        } else if (s.holding && waiting <= entry_.lowWater) {
+            s.holding  = false;
+            s.emitOk   = true;
+            s.emitHold = false;
+        }
+        if (s.emitHold || s.emitOk) s.phase = DistributorState::Phase::SEND;
+    }
+
+    // Assign cust to the lane the policy picks; false when every open lane
+    // is full. Lanes still held by the fluid are skipped.
+    bool route(DistributorState& s, const CustomerData& cust) const {
+        LaneMask routable;
+        if (!s.held.empty()) {
+            routable = s.open;
+            for (const LaneHold& h : s.held) {
+                if (h.lane >= 0) routable.set(h.lane, false);
             }
-            return best;
-        };
-
-        if (cust.numItems <= SELF_ITEM_LIMIT) {
-            const int self = pickSmallest(CASH_LANES, SELF_LANES);
-            if (self >= 0) return self;
-            return pickSmallest(0, CASH_LANES);
-        } else {
-            const int cash = pickSmallest(0, CASH_LANES);
-            if (cash >= 0) return cash;
-            return pickSmallest(CASH_LANES, SELF_LANES);
+        }
+        const LaneMask* open = s.held.empty() ? &s.open : &routable;
+        const int lane = policy_->chooseLane(layout_, LaneLoad{s.queues, s.busyUntil, s.clock, open, &s.routeRng}, cust);
+        if (lane < 0) return false;
+        s.queues[lane]++;
+        s.laneLoad[lane].set(s.clock, s.queues[lane]);
+        if (s.queues[lane] <= layout_.servers(lane)) s.busyLanes.set(s.clock, s.busyLanes.level + 1);
+        // A bank's kiosks share its work
+        s.busyUntil[lane] = std::max(s.busyUntil[lane], s.clock)
+                          + layout_.serviceTime(lane, cust) / layout_.servers(lane);
+        s.outbox.push_back({lane, cust});
+        return true;
+    }
+
+    // The head of the entry queue goes to the lanes while one has space.
+    // The policy only fails when every open lane is full, so the head never
+    // blocks a customer behind it that could have been placed.
+    void routeWaiting(DistributorState& s) const {
+        while (!s.entry.empty()) {
+            if (!route(s, s.entry.front())) break;
+            traceEnd(s.clock, s.entry.front(), TraceStage::ENTRY_QUEUE);
+            s.entry.pop();
+        }
+    }
+
+    // A customer left `lane`. busyUntil is built from mean service times, so
+    // it drifts from the lane's real work; an empty lane has none left.
+    void freeLanePlace(DistributorState& s, int lane) const {
+        if (0 <= lane && lane < static_cast<int>(s.queues.size()) && s.queues[lane] > 0) {
+            s.queues[lane]--;
+            s.laneLoad[lane].set(s.clock, s.queues[lane]);
+            if (s.queues[lane] < layout_.servers(lane)) s.busyLanes.set(s.clock, s.busyLanes.level - 1);
+            if (s.queues[lane] == 0) s.busyUntil[lane] = s.clock;
+        }
+    }
+
+    // Fluid customers done at their held lanes by now go on to pay; true if
+    // there were any
+    bool releaseHolds(DistributorState& s) const {
+        const auto done = std::stable_partition(s.held.begin(), s.held.end(),
+                                                [&](const LaneHold& h) { return h.until > s.clock; });
+        if (done == s.held.end()) return false;
+        for (auto it = done; it != s.held.end(); ++it) {
+            freeLanePlace(s, it->lane);
+            s.payOutbox.push_back(it->cust);
+        }
+        s.held.erase(done, s.held.end());
+        return true;
+    }
+
+    // ---- Hybrid mode (fluid_walkin.hpp) ----
+
+    // At the end of each window: enter fluid mode when the lanes were busy
+    // at least `enter` of the window and walk-ins are still waiting; leave it
+    // when the lane work offered during the window falls below `exit` and
+    // nobody is waiting for a lane place. Either switch waits until the run
+    // has been `dwell` in its current mode, so a load hovering around the
+    // thresholds does not flip it every window.
+    void hybridStep(DistributorState& s) const {
+        if (!fluid_.enabled() || s.clock < s.windowStart + fluid_.step) return;
+        const double span    = s.clock - s.windowStart;
+        const int    servers = std::max(1, openServers(s));
+        const bool   settled = s.clock - s.modeSince >= fluid_.dwell;
+        if (!s.fluid.active()) {
+            const double util = (s.busyLanes.integral(s.clock) - s.windowBusy) / (span * servers);
+            if (settled && util >= fluid_.enter && !s.entry.empty()) enterFluid(s);
+        } else if (s.fluid.takeOffered() / span < fluid_.exit && settled && waiting(s) == 0) {
+            leaveFluid(s);
+        }
+        s.windowStart = s.clock;
+        s.windowBusy  = s.busyLanes.integral(s.clock);
+    }
+
+    // The open lanes start from the work already routed to them, and the
+    // entry queue joins the fluid in order.
+    void enterFluid(DistributorState& s) const {
+        std::vector<double> laneFree;
+        std::vector<int>    serverLane;
+        for (int i = 0; i < static_cast<int>(s.queues.size()); ++i) {
+            if (!s.open.test(i)) continue;
+            double from = std::max(s.clock, s.busyUntil[i]);
+            for (const LaneHold& h : s.held) {
+                if (h.lane == i) from = std::max(from, h.until);
+            }
+            laneFree.insert(laneFree.end(), layout_.servers(i), from);
+            serverLane.insert(serverLane.end(), layout_.servers(i), i);
+        }
+        s.fluid.begin(s.clock, std::move(laneFree), std::move(serverLane),
+                      backlog_ ? backlog_(s.clock) : DiscreteBacklog(), fluid_);
+        s.inFluid.set(s.clock, 1.0);
+        s.modeSince = s.clock;
+        while (!s.entry.empty()) {
+            traceEnd(s.clock, s.entry.front(), TraceStage::ENTRY_QUEUE);
+            admitFluid(s, s.entry.pop());
+        }
+        s.entryQueued.set(s.clock, static_cast<double>(waiting(s)));
+        flowControl(s);
+    }
+
+    // Walk-ins the fluid has not brought to a lane yet go back to the lanes
+    // and the entry queue in order, under the same capacity rule as
+    // arrivals; the lanes held for the fluid do not count as free. A lane
+    // serving one of them counts them as assigned, and takes nobody new until
+    // they are done, as if they had been routed there. Everyone who has not
+    // paid yet goes to the PaymentProcessor.
+    void leaveFluid(DistributorState& s) const {
+        FluidWalkin::Handback back = s.fluid.end(s.clock);
+        for (const LaneHold& h : back.held) {
+            s.held.push_back(h);
+            if (h.lane < 0) continue;
+            s.queues[h.lane]++;
+            s.laneLoad[h.lane].set(s.clock, s.queues[h.lane]);
+            if (s.queues[h.lane] <= layout_.servers(h.lane)) s.busyLanes.set(s.clock, s.busyLanes.level + 1);
+            s.busyUntil[h.lane] = std::max(s.busyUntil[h.lane], s.clock)
+                                + (h.until - s.clock) / layout_.servers(h.lane);
+        }
+        s.payOutbox.insert(s.payOutbox.end(), back.toPay.begin(), back.toPay.end());
+        s.payingOutbox.insert(s.payingOutbox.end(), back.paying.begin(), back.paying.end());
+        s.modeSince = s.clock;
+        for (const CustomerData& cust : back.waiting) {
+            if (s.clock - cust.arrivalTime >= cust.patience) {
+                traceInstant(s.clock, cust, TraceStage::RENEGED, static_cast<int>(TraceStage::ENTRY_QUEUE));
+                ++s.reneged;
+                continue;
+            }
+            if (s.entry.empty() && route(s, cust)) continue;
+            if (static_cast<int>(s.entry.size()) < entry_.capacity) {
+                s.entry.push(cust, cust.arrivalTime + cust.patience);
+                traceBegin(s.clock, cust, TraceStage::ENTRY_QUEUE);
+            } else {
+                traceInstant(s.clock, cust, TraceStage::LOST);
+                ++s.lost;
+            }
+        }
+        s.inFluid.set(s.clock, 0.0);
+        s.entryQueued.set(s.clock, static_cast<double>(s.entry.size()));
+        flowControl(s);
+    }
+
+    void admitFluid(DistributorState& s, const CustomerData& cust) const {
+        const int servers = std::max(1, openServers(s));
+        double service = 0.0;
+        for (int i = 0; i < static_cast<int>(s.queues.size()); ++i) {
+            if (s.open.test(i)) service += layout_.servers(i) * layout_.serviceTime(i, cust);
+        }
+        if (!s.fluid.admit(cust, s.clock, service / servers, laneQueuePlaces(s))) {
+            traceInstant(s.clock, cust, TraceStage::RENEGED, static_cast<int>(TraceStage::ENTRY_QUEUE));
+            ++s.reneged;
         }
     }
 };
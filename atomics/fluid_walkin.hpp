@@ -0,0 +1,336 @@
+#ifndef FLUID_WALKIN_HPP
+#define FLUID_WALKIN_HPP
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <set>
+#include <vector>
+#include "customer_data.hpp"
+#include "payment_processor.hpp"
+
+// ---- Fluid approximation of the walk-in path (hybrid mode) ----
+// When the lanes are saturated, almost every event in the store is a lane,
+// payment or traveler transition for a customer who is simply queueing. In
+// hybrid mode the Distributor then stops routing walk-ins to the Cash lanes
+// and passes them through this model instead, until the load drops again.
+//
+// The lanes and the payment terminals become pooled stages, each tracked by
+// the times its servers free up. Where the discrete path schedules events
+// for every queue move, the fluid one solves each stage's workload recursion
+// once per customer (the multi-server Lindley recursion):
+//
+//   laneStart = max(now, earliest free lane)          that lane frees at laneStart + S_lane
+//   payStart  = max(laneDone, earliest free terminal) that terminal frees at payStart + S_pay
+//
+// Payment is taken in order of lane completion, with the mean card or cash
+// time. The walk to the exit follows the traveler: one customer at a time,
+// and anyone who pays while it is walking someone is not seen, as in the
+// discrete path. Lane and payment completions are applied lazily, whenever
+// the Distributor wakes; it only wakes for the end of the next walk, which
+// plan() finds by playing the completions before it forward. That time holds
+// until the next admission, which can only add later completions.
+//
+// The two modes do not pay side by side. Fluid mode starts from the
+// PaymentProcessor's open terminals, each free once it has cleared
+// the payments in progress and queued there (DiscreteBacklog). Those
+// payments end in the discrete path, but their completions still occupy the
+// fluid's traveler, as does a walk the traveler is on.
+//
+// Customers are kept as tokens, so counts and identities stay exact: when it
+// leaves fluid mode, the Distributor hands those who have not reached a lane
+// yet back to its entry queue in order, and keeps each lane closed to new
+// customers until the one served there in the fluid is done (LaneHold).
+// Everyone else who has not paid yet goes to the PaymentProcessor: queued
+// with the patience they have left, paying with the time they have left, or
+// from a held lane once done there. Only a customer already walking stays in
+// the fluid. Patience is checked against the waits for a lane place and a
+// terminal.
+
+struct FluidSettings {
+    double enter = 0.0;     // lane utilisation over a window that starts fluid mode (0 = never)
+    double exit  = 0.8;     // offered lane load over a window below which it ends
+    double step  = 60.0;    // window length (simulated seconds)
+    double dwell = 1800.0;  // minimum time in either mode before switching again
+
+    int    payTerminals = 1;
+    double cardPayMean  = 10.0;
+    double cashPayMean  = 75.0;
+    double travelTime   = 10.0;
+
+    bool enabled() const { return enter > 0.0; }
+};
+
+// A lane still serving a fluid customer after fluid mode ended; they go on
+// to pay at `until`. lane is -1 when the fluid served them with every lane
+// closed.
+struct LaneHold {
+    int          lane  = -1;
+    double       until = 0.0;
+    CustomerData cust;
+};
+
+// What the discrete path still has to do when fluid mode starts
+struct DiscreteBacklog {
+    PaymentBacklog payment;   // no terminals: they start free, FluidSettings::payTerminals of them
+    double walkEnd = -std::numeric_limits<double>::infinity();   // end of the traveler's current walk
+};
+
+class FluidWalkin {
+public:
+    bool active() const { return active_; }
+
+    // Start fluid mode at `now`. laneFree holds when each open lane server
+    // clears the work already assigned to it, serverLane the laneId it
+    // belongs to; backlog what the payment terminals and the traveler have
+    // left.
+    void begin(double now, std::vector<double> laneFree, std::vector<int> serverLane,
+               const DiscreteBacklog& backlog, const FluidSettings& fs) {
+        active_     = true;
+        fs_         = fs;
+        laneFree_   = std::move(laneFree);
+        serverLane_ = std::move(serverLane);
+        if (laneFree_.empty()) {
+            laneFree_.push_back(now);
+            serverLane_.push_back(-1);
+        }
+        payFree_ = backlog.payment.terminalFree;
+        if (payFree_.empty()) payFree_.assign(static_cast<size_t>(std::max(1, fs.payTerminals)), now);
+        for (double& t : payFree_) t = std::max(t, now);
+        for (double t : backlog.payment.done) {
+            paying_.insert({std::max(t, now), 0.0, 0.0, 0, true, CustomerData()});
+            ++shadows_;
+        }
+        if (walkEnd_ == NEVER && backlog.walkEnd > now) {
+            walkEnd_      = backlog.walkEnd;
+            walkerShadow_ = true;
+        }
+        offered_ = 0.0;
+        ++episodes;
+        plan();
+    }
+
+    // Admit a walk-in at `now` (after update(now) and advance(now)).
+    // laneService is their service time on an average open lane, lanePlaces
+    // the lanes' waiting places: as in the entry queue, the wait ends when one
+    // of them frees up. False if they give up waiting instead (counted).
+    bool admit(const CustomerData& cust, double now, double laneService, int lanePlaces) {
+        auto lane = std::min_element(laneFree_.begin(), laneFree_.end());
+        const double laneStart = std::max(now, *lane);
+        const int    ahead     = notStarted();
+        const double placed    = lanePlaces <= 0    ? laneStart
+                               : ahead < lanePlaces ? now
+                                                    : starts_[ahead - lanePlaces];
+        if (placed - cust.arrivalTime > cust.patience) {
+            ++renegedEntry;
+            return false;
+        }
+        *lane     = laneStart + laneService;
+        offered_ += laneService / static_cast<double>(laneFree_.size());
+        starts_.push_back(laneStart);
+        atLane_.insert({laneStart + laneService, laneStart, 0.0, static_cast<int>(lane - laneFree_.begin()), false, cust});
+        ++admitted;
+        plan();
+        return true;
+    }
+
+    // Forget lane starts up to `now`.
+    void advance(double now) {
+        while (!starts_.empty() && starts_.front() <= now) starts_.pop_front();
+    }
+
+    // Admitted customers not at a lane yet (after advance(now)).
+    int notStarted() const { return static_cast<int>(starts_.size()); }
+
+    // When notStarted() drops to `count` (infinity if it already has).
+    double timeNotStartedReaches(int count) const {
+        const int k = notStarted() - count - 1;
+        return k >= 0 ? starts_[k] : NEVER;
+    }
+
+    // End of the next walk, the only time the fluid needs a wake-up
+    double nextEvent() const { return nextExit_; }
+
+    // The customer reaching the exit by `t`, if any
+    const CustomerData* leaving(double t) const {
+        return (nextExit_ <= t && !nextShadow_) ? &nextWalker_ : nullptr;
+    }
+
+    // Apply the completions up to `now`, in time order.
+    void update(double now) {
+        for (;;) {
+            const double laneDone = top(atLane_);
+            const double paid     = top(paying_);
+            if (walkEnd_ <= now && walkEnd_ <= std::min(laneDone, paid)) {
+                walkEnd_      = NEVER;
+                walkerShadow_ = false;
+            } else if (laneDone <= now && laneDone <= paid) {
+                pay(atLane_.begin()->cust, laneDone);
+                atLane_.erase(atLane_.begin());
+            } else if (paid <= now) {
+                const Token& tok = *paying_.begin();
+                if (walkEnd_ == NEVER) {
+                    walker_       = tok.cust;
+                    walkerShadow_ = tok.shadow;
+                    walkEnd_      = paid + fs_.travelTime;
+                } else if (!tok.shadow) {
+                    ++missedTraveler;
+                }
+                if (tok.shadow) --shadows_;
+                paying_.erase(paying_.begin());
+            } else {
+                break;
+            }
+        }
+        plan();
+    }
+
+    // What the discrete path gets back when fluid mode ends
+    struct Handback {
+        std::vector<CustomerData> waiting;   // not at a lane yet, in arrival order
+        std::vector<LaneHold>     held;      // lanes still serving a fluid customer
+        std::vector<CustomerData> toPay;     // waiting for a terminal, in lane completion order
+        std::vector<PaymentProcessorState::Payment> paying;   // at a terminal, with the time left
+    };
+
+    // End fluid mode at `now` (after update(now)). Afterwards only a
+    // customer walking to the exit is left in the fluid.
+    Handback end(double now) {
+        Handback out;
+        std::vector<Token> back;
+        for (const Token& tok : atLane_) {
+            if (tok.start > now) back.push_back(tok);
+            else                 out.held.push_back({serverLane_[tok.server], tok.at, tok.cust});
+        }
+        std::vector<Token> queued;
+        for (const Token& tok : paying_) {
+            if (tok.shadow) continue;
+            if (tok.start > now) queued.push_back(tok);
+            else                 out.paying.push_back({tok.cust, tok.at - now});
+        }
+        atLane_.clear();
+        paying_.clear();
+        shadows_ = 0;
+        starts_.clear();
+        active_ = false;
+        plan();
+
+        const auto byStart = [](const Token& a, const Token& b) { return a.start < b.start; };
+        std::sort(back.begin(), back.end(), byStart);
+        for (const Token& tok : back) out.waiting.push_back(tok.cust);
+        std::stable_sort(queued.begin(), queued.end(),
+                         [](const Token& a, const Token& b) { return a.ready < b.ready; });
+        for (const Token& tok : queued) {
+            out.toPay.push_back(tok.cust);
+            out.toPay.back().patience -= now - tok.ready;
+        }
+        handedBack      += static_cast<long>(out.waiting.size());
+        handedToPayment += static_cast<long>(out.held.size() + out.toPay.size() + out.paying.size());
+        return out;
+    }
+
+    // Lane work admitted since the last call, per lane (seconds).
+    double takeOffered() {
+        const double w = offered_;
+        offered_ = 0.0;
+        return w;
+    }
+
+    // Customers still in the fluid, walking or not
+    size_t pending() const {
+        return atLane_.size() + paying_.size() - shadows_ + (walkEnd_ < NEVER && !walkerShadow_ ? 1 : 0);
+    }
+
+    long episodes       = 0;   // times fluid mode started
+    long admitted       = 0;
+    long handedBack     = 0;   // returned to the entry queue at the end of an episode
+    long handedToPayment = 0;  // sent on to the PaymentProcessor then
+    long renegedEntry   = 0;
+    long renegedPayment = 0;
+    long missedTraveler = 0;   // paid while the traveler was walking someone
+
+private:
+    static constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+    struct Token {
+        double       at = 0.0;          // lane or payment completion
+        double       start = 0.0;       // lane or payment start
+        double       ready = 0.0;       // lane completion, while paying
+        int          server = 0;        // index into laneFree_
+        bool         shadow = false;    // a discrete payment still occupying the traveler
+        CustomerData cust;
+    };
+    struct Earlier {
+        bool operator()(const Token& a, const Token& b) const { return a.at < b.at; }
+    };
+    // Ordered on `at`, ties in insertion order, so plan() can look ahead
+    // without taking anything out
+    using Tokens = std::multiset<Token, Earlier>;
+
+    bool   active_  = false;
+    double offered_ = 0.0;
+    FluidSettings       fs_;
+    std::vector<double> laneFree_;
+    std::vector<int>    serverLane_;
+    std::vector<double> payFree_;
+    std::deque<double>  starts_;    // lane starts still ahead, ascending
+    Tokens              atLane_;
+    Tokens              paying_;
+    CustomerData        walker_;
+    double              walkEnd_ = NEVER;
+    bool                walkerShadow_ = false;   // the traveler is walking a discrete customer
+    size_t              shadows_ = 0;            // shadow tokens in paying_
+
+    // update() would start the next walk at the first payment completion
+    // once the traveler is free; found here from a copy of the terminal times
+    double              nextExit_ = NEVER;
+    CustomerData        nextWalker_;
+    bool                nextShadow_ = false;
+    std::vector<double> terminals_;
+
+    static double top(const Tokens& q) { return q.empty() ? NEVER : q.begin()->at; }
+
+    double payTime(const CustomerData& cust) const {
+        return cust.paymentType ? fs_.cardPayMean : fs_.cashPayMean;
+    }
+
+    void pay(const CustomerData& cust, double laneDone) {
+        auto terminal = std::min_element(payFree_.begin(), payFree_.end());
+        const double payStart = std::max(laneDone, *terminal);
+        if (payStart - laneDone > cust.patience) {
+            ++renegedPayment;
+            return;
+        }
+        *terminal = payStart + payTime(cust);
+        paying_.insert({*terminal, payStart, laneDone, 0, false, cust});
+    }
+
+    void plan() {
+        if (walkEnd_ < NEVER) {
+            nextExit_   = walkEnd_;
+            nextWalker_ = walker_;
+            nextShadow_ = walkerShadow_;
+            return;
+        }
+        double first = top(paying_);
+        const Token* who = paying_.empty() ? nullptr : &*paying_.begin();
+        terminals_ = payFree_;
+        for (auto it = atLane_.begin(); it != atLane_.end() && it->at < first; ++it) {
+            auto terminal = std::min_element(terminals_.begin(), terminals_.end());
+            const double payStart = std::max(it->at, *terminal);
+            if (payStart - it->at > it->cust.patience) continue;
+            *terminal = payStart + payTime(it->cust);
+            if (*terminal < first) {
+                first = *terminal;
+                who   = &*it;
+            }
+        }
+        nextExit_ = who ? first + fs_.travelTime : NEVER;
+        if (who) {
+            nextWalker_ = who->cust;
+            nextShadow_ = who->shadow;
+        }
+    }
+};
+
+#endif // FLUID_WALKIN_HPP
@@ -6,10 +6,19 @@
 #include <random>
 #include <optional>
 #include <cmath>
+#include <memory>
 #include "customer_data.hpp"
+#include "empirical_distribution.hpp"
+#include "lifecycle_trace.hpp"
+#include "random_streams.hpp"
 
 using namespace cadmium;
 
+// Basket size is uniform on [MIN_ITEMS, MAX_ITEMS] unless the Generator is
+// given a basket-size histogram (till_profile.hpp)
+static constexpr int MIN_ITEMS = 1;
+static constexpr int MAX_ITEMS = 40;
+
 struct GeneratorState {
     enum class Phase { RUNNING, PAUSED } phase;
     double sigma;
@@ -45,18 +54,29 @@ public:
               double searchMean   = 120.0,  // mean pack/search time (seconds)
               double onlineProb   = 0.30,   // probability of isOnlineOrder
               double cardProb     = 0.70,   // probability of tap/card payment
-              std::optional<unsigned int> seed = std::nullopt)
+              std::optional<unsigned int> seed = std::nullopt,
+              double patienceMean = 0.0,    // mean patience (seconds); 0 = nobody reneges
+              bool   antithetic   = false,  // draw 1 - u for every uniform u (random_streams.hpp)
+              std::shared_ptr<const EmpiricalDistribution> basketSizes = nullptr)   // items per basket
         : Atomic<GeneratorState>(id, GeneratorState()),
           arrivalDist_(1.0 / std::max(1e-9, arrivalMean)),
           travelDist_ (travelMean, travelStdDev),
           searchDist_ (1.0 / std::max(1e-9, searchMean)),
-          itemDist_   (1, 40),
+          itemDist_   (MIN_ITEMS, MAX_ITEMS),
           onlineDist_ (onlineProb),
-          cardDist_   (cardProb)
+          cardDist_   (cardProb),
+          patienceDist_(1.0 / std::max(1e-9, patienceMean)),
+          basketSizes_(std::move(basketSizes)),
+          sampledPatience_(patienceMean > 0.0)
     {
+        // Arrivals and customer attributes use separate streams, so the n-th
+        // customer looks the same however often the Distributor holds us off.
         if (seed.has_value()) {
-            rng_.seed(*seed);
+            arrivals_.seed(*seed);
+            customers_.seed(*seed ^ 0x5BD1E995u);
         }
+        arrivals_.setAntithetic(antithetic);
+        customers_.setAntithetic(antithetic);
         okGo        = addInPort<bool>("okGo");
         holdOff     = addInPort<bool>("holdOff");
         customerOut = addOutPort<CustomerData>("customerOut");
@@ -88,13 +108,18 @@ public:
         if (s.phase != GeneratorState::Phase::RUNNING) return;
 
         const int    id     = s.nextCustomerId;
-        const int    items  = itemDist_(rng_);
-        const bool   online = onlineDist_(rng_);
-        const bool   card   = cardDist_(rng_);
-        const double travel = std::max(0.0, travelDist_(rng_));
-        const double search = std::fabs(searchDist_(rng_));
-
-        customerOut->addMessage(CustomerData(id, items, online, card, travel, search));
+        const int    items  = basketSizes_ ? static_cast<int>(basketSizes_->sample(unitDist_(customers_)))
+                                           : itemDist_(customers_);
+        const bool   online = onlineDist_(customers_);
+        const bool   card   = cardDist_(customers_);
+        const double travel = std::max(0.0, travelDist_(customers_));
+        const double search = std::fabs(searchDist_(customers_));
+
+        CustomerData cust(id, items, online, card, travel, search);
+        // Only drawn when enabled, so runs without reneging keep their streams
+        if (sampledPatience_) cust.patience = patienceDist_(customers_);
+        cust.traced = LifecycleTrace::sampled(id);
+        customerOut->addMessage(cust);
     }
 
     void internalTransition(GeneratorState& s) const override {
@@ -108,17 +133,36 @@ public:
         return s.sigma;
     }
 
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const GeneratorState& getState() const { return state; }
+    void setState(const GeneratorState& s) { state = s; }
+
+    // The engines plus the one distribution that caches draws between calls;
+    // copying them lets a fork see exactly the arrivals the original would.
+    struct RngState {
+        RandomStream                     arrivals;
+        RandomStream                     customers;
+        std::normal_distribution<double> travel;
+    };
+    RngState getRng() const { return {arrivals_, customers_, travelDist_}; }
+    void setRng(const RngState& r) { arrivals_ = r.arrivals; customers_ = r.customers; travelDist_ = r.travel; }
+
 private:
-    mutable std::mt19937                          rng_{std::random_device{}()};
+    mutable RandomStream                          arrivals_;
+    mutable RandomStream                          customers_;
     mutable std::exponential_distribution<double> arrivalDist_;
     mutable std::normal_distribution<double>      travelDist_;
     mutable std::exponential_distribution<double> searchDist_;
     mutable std::uniform_int_distribution<int>    itemDist_;
     mutable std::bernoulli_distribution           onlineDist_;
     mutable std::bernoulli_distribution           cardDist_;
+    mutable std::exponential_distribution<double> patienceDist_;
+    mutable std::uniform_real_distribution<double> unitDist_;
+    std::shared_ptr<const EmpiricalDistribution>  basketSizes_;
+    bool sampledPatience_;
 
     double sampleArrival() const {
-        return std::fabs(arrivalDist_(rng_));
+        return std::fabs(arrivalDist_(arrivals_));
     }
 };
 
@@ -0,0 +1,200 @@
+#ifndef INPUT_REPLAY_HPP
+#define INPUT_REPLAY_HPP
+
+#include <cadmium/modeling/devs/atomic.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "customer_data.hpp"
+
+using namespace cadmium;
+
+// ---- Record and replay of a subsystem's input stream ----
+// InputRecorder sits beside a subsystem, coupled to the same source port, and
+// appends every message it sees, with its simulated time, to a binary file.
+// InputReplayer reads the file back and emits the same messages at the same
+// times, so the subsystem can be simulated alone and sees exactly the input
+// it saw inside the full store (e.g. pickup_system fed by the Distributor's
+// online orders; see grocery_store::recordPickupInput and grocery_replay).
+// This only holds while the subsystem's input does not depend on its own
+// output, which is true for pickup_system.
+//
+// File layout: InputFileHeader, then one InputRecord per message in time order.
+
+struct InputFileHeader {
+    char     magic[8];       // "GROCINP1"
+    uint32_t recordSize;
+    uint32_t reserved;
+    char     subsystem[16];  // what was recorded, e.g. "pickup"
+};
+
+// Every CustomerData field, so replayed customers are indistinguishable.
+struct InputRecord {
+    double   time;
+    int32_t  customerId;
+    int32_t  numItems;
+    uint8_t  flags;          // 1 = online order, 2 = card payment, 4 = traced
+    uint8_t  reserved[7];
+    double   travelTime;
+    double   searchTime;
+    double   arrivalTime;
+    double   patience;
+    double   waited;
+    double   queuedAt;
+};
+static_assert(sizeof(InputRecord) == 72, "InputRecord is written to disk as-is");
+
+inline InputRecord toRecord(double time, const CustomerData& c) {
+    InputRecord r{};
+    r.time        = time;
+    r.customerId  = c.customerId;
+    r.numItems    = c.numItems;
+    r.flags       = static_cast<uint8_t>((c.isOnlineOrder ? 1 : 0) | (c.paymentType ? 2 : 0) | (c.traced ? 4 : 0));
+    r.travelTime  = c.travelTime;
+    r.searchTime  = c.searchTime;
+    r.arrivalTime = c.arrivalTime;
+    r.patience    = c.patience;
+    r.waited      = c.waited;
+    r.queuedAt    = c.queuedAt;
+    return r;
+}
+
+inline CustomerData fromRecord(const InputRecord& r) {
+    CustomerData c(r.customerId, r.numItems, (r.flags & 1) != 0, (r.flags & 2) != 0, r.travelTime, r.searchTime);
+    c.traced      = (r.flags & 4) != 0;
+    c.arrivalTime = r.arrivalTime;
+    c.patience    = r.patience;
+    c.waited      = r.waited;
+    c.queuedAt    = r.queuedAt;
+    return c;
+}
+
+// Reads a whole input file; throws std::runtime_error if it is not one.
+inline std::vector<InputRecord> loadInputFile(const std::string& path, std::string* subsystem = nullptr) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) throw std::runtime_error("cannot open input recording " + path);
+
+    InputFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 || std::memcmp(header.magic, "GROCINP1", 8) != 0
+        || header.recordSize != sizeof(InputRecord)) {
+        throw std::runtime_error(path + " is not an input recording");
+    }
+    if (subsystem) *subsystem = std::string(header.subsystem, strnlen(header.subsystem, sizeof(header.subsystem)));
+
+    std::vector<InputRecord> records;
+    InputRecord r{};
+    while (std::fread(&r, sizeof(r), 1, file.get()) == 1) records.push_back(r);
+    return records;
+}
+
+struct InputRecorderState {
+    double clock = 0.0;
+    long   count = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const InputRecorderState& s) {
+    os << "{recorded:" << s.count << "}";
+    return os;
+}
+
+class InputRecorder : public Atomic<InputRecorderState> {
+public:
+    Port<CustomerData> in;
+
+    InputRecorder(const std::string& id, const std::string& path, const std::string& subsystem)
+        : Atomic<InputRecorderState>(id, InputRecorderState()),
+          file_(std::fopen(path.c_str(), "wb"), &std::fclose)
+    {
+        if (!file_) throw std::runtime_error("cannot open input recording " + path);
+        InputFileHeader header{};
+        std::memcpy(header.magic, "GROCINP1", 8);
+        header.recordSize = sizeof(InputRecord);
+        std::strncpy(header.subsystem, subsystem.c_str(), sizeof(header.subsystem) - 1);
+        std::fwrite(&header, sizeof(header), 1, file_.get());
+        in = addInPort<CustomerData>("in");
+    }
+
+    void externalTransition(InputRecorderState& s, double e) const override {
+        s.clock += e;
+        for (const auto& cust : in->getBag()) {
+            const InputRecord r = toRecord(s.clock, cust);
+            std::fwrite(&r, sizeof(r), 1, file_.get());
+            ++s.count;
+        }
+    }
+
+    void output(const InputRecorderState&) const override {}
+    void internalTransition(InputRecorderState&) const override {}
+
+    [[nodiscard]] double timeAdvance(const InputRecorderState&) const override {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // Write out buffered records, e.g. before reading the file in the same process.
+    void flush() const { std::fflush(file_.get()); }
+    long recorded() const { return state.count; }
+
+private:
+    std::unique_ptr<FILE, int (*)(FILE*)> file_;
+};
+
+struct InputReplayerState {
+    size_t next = 0;         // first record not yet sent
+    double sigma;            // until records[next]
+    double clock = 0.0;
+
+    InputReplayerState() : sigma(std::numeric_limits<double>::infinity()) {}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const InputReplayerState& s) {
+    os << "{next:" << s.next << ",sigma:" << s.sigma << "}";
+    return os;
+}
+
+class InputReplayer : public Atomic<InputReplayerState> {
+public:
+    Port<CustomerData> out;
+
+    InputReplayer(const std::string& id, std::vector<InputRecord> records)
+        : Atomic<InputReplayerState>(id, InputReplayerState()),
+          records_(std::move(records))
+    {
+        out = addOutPort<CustomerData>("out");
+        if (!records_.empty()) state.sigma = records_.front().time;
+    }
+
+    void externalTransition(InputReplayerState& s, double e) const override {
+        // No inputs; kept for completeness
+        s.clock += e;
+        s.sigma = std::max(0.0, s.sigma - e);
+    }
+
+    // Messages recorded at the same time arrive together, as they did
+    void output(const InputReplayerState& s) const override {
+        for (size_t i = s.next; i < records_.size() && records_[i].time == records_[s.next].time; ++i) {
+            out->addMessage(fromRecord(records_[i]));
+        }
+    }
+
+    void internalTransition(InputReplayerState& s) const override {
+        s.clock = records_[s.next].time;
+        while (s.next < records_.size() && records_[s.next].time == s.clock) ++s.next;
+        s.sigma = (s.next < records_.size())
+            ? records_[s.next].time - s.clock
+            : std::numeric_limits<double>::infinity();
+    }
+
+    [[nodiscard]] double timeAdvance(const InputReplayerState& s) const override {
+        return s.sigma;
+    }
+
+private:
+    std::vector<InputRecord> records_;
+};
+
+#endif // INPUT_REPLAY_HPP
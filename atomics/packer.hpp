@@ -3,26 +3,47 @@
 
 #include <cadmium/modeling/devs/atomic.hpp>
 #include <limits>
+#include <vector>
+#include <algorithm>
 #include "customer_data.hpp"
+#include "fork_queue.hpp"
+#include "lifecycle_trace.hpp"
+#include "time_weighted.hpp"
 
 using namespace cadmium;
 
 struct PackerState {
     enum class Phase { IDLE, PACKING } phase;
     double defaultPackTimePerItem;
+    int    packers;                // staff packing orders in parallel
     double sigma;
-    CustomerData current;
+    double clock = 0.0;            // simulated time, for trace timestamps
 
-    explicit PackerState(double ptpi = 1.0)
+    struct Job {
+        CustomerData cust;
+        double remaining = 0.0;    // pack time left for this order
+    };
+    std::vector<Job> active;       // at most `packers` orders in progress
+    ForkQueue<CustomerData> q;    // orders waiting for a free packer
+    IpaGradient dFreed;            // derivative of the latest completion (ipa_gradient.hpp)
+
+    LevelIntegral busy;            // packers at work (active.size())
+    LevelIntegral queued;          // q.size()
+
+    explicit PackerState(double ptpi = 1.0, int numPackers = 1)
         : phase(Phase::IDLE),
           defaultPackTimePerItem(ptpi),
+          packers(std::max(1, numPackers)),
           sigma(std::numeric_limits<double>::infinity()),
-          current() {}
+          active(),
+          q() {}
 };
 
 inline std::ostream& operator<<(std::ostream& os, const PackerState& s) {
     os << "{phase:" << (s.phase == PackerState::Phase::IDLE ? "idle" : "packing")
        << ",sigma:" << s.sigma
+       << ",busy:" << s.active.size()
+       << ",queued:" << s.q.size()
        << "}";
     return os;
 }
@@ -32,43 +53,49 @@ public:
     Port<CustomerData> in_order;   // from PaymentProcessor (online orders only)
     Port<CustomerData> out_packed; // to CurbsideDispatcher
 
-    Packer(const std::string& id, double packTimePerItem = 1.0)
-        : Atomic<PackerState>(id, PackerState(packTimePerItem))
+    Packer(const std::string& id, double packTimePerItem = 1.0, int packers = 1)
+        : Atomic<PackerState>(id, PackerState(packTimePerItem, packers))
     {
         in_order   = addInPort<CustomerData>("in_order");
         out_packed = addOutPort<CustomerData>("out_packed");
     }
 
-    void externalTransition(PackerState& s, double /*e*/) const override {
-        if (s.phase == PackerState::Phase::IDLE && !in_order->empty()) {
-            const CustomerData cust = in_order->getBag().back();
+    void externalTransition(PackerState& s, double e) const override {
+        advance(s, e);
 
+        for (const CustomerData& cust : in_order->getBag()) {
             // Only pack online orders; ignore walk-ins if they arrive here accidentally.
-            if (!cust.isOnlineOrder) return;
-
-            s.current = cust;
-            s.phase = PackerState::Phase::PACKING;
-
-            if (s.current.searchTime > 0.0) {
-                s.sigma = s.current.searchTime;
-            } else {
-                s.sigma = (s.current.numItems > 0)
-                    ? (static_cast<double>(s.current.numItems) * s.defaultPackTimePerItem)
-                    : s.defaultPackTimePerItem;
-            }
+            if (!cust.isOnlineOrder) continue;
+            s.q.push(cust);
+            traceBegin(s.clock, cust, TraceStage::PACK_QUEUE);
         }
+
+        // The queue was empty if a packer was free, so whoever starts now starts on arrival
+        startWaiting(s, false);
     }
 
     void output(const PackerState& s) const override {
-        if (s.phase == PackerState::Phase::PACKING) {
-            out_packed->addMessage(s.current);
+        // Every order finishing at the earliest completion time leaves together
+        for (const auto& job : s.active) {
+            if (job.remaining <= s.sigma) {
+                out_packed->addMessage(job.cust);
+            }
         }
     }
 
     void internalTransition(PackerState& s) const override {
-        s.phase = PackerState::Phase::IDLE;
-        s.sigma = std::numeric_limits<double>::infinity();
-        s.current = CustomerData();
+        const double done = s.sigma;
+        for (const auto& job : s.active) {
+            if (job.remaining <= done) {
+                traceEnd(s.clock + done, job.cust, TraceStage::PACKING);
+                s.dFreed = job.cust.ipa;
+            }
+        }
+        s.active.erase(std::remove_if(s.active.begin(), s.active.end(),
+                                      [done](const PackerState::Job& j) { return j.remaining <= done; }),
+                       s.active.end());
+        advance(s, done);
+        startWaiting(s, true);
     }
 
     [[nodiscard]] double timeAdvance(const PackerState& s) const override {
@@ -76,6 +103,60 @@ public:
             ? std::numeric_limits<double>::infinity()
             : s.sigma;
     }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const PackerState& getState() const { return state; }
+    void setState(const PackerState& s) { state = s; }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp); utilisation is per packer
+    StationKpis kpis(double now) const {
+        StationKpis k;
+        k.busyTime    = state.busy.integral(now);
+        k.utilisation = state.busy.mean(now) / state.packers;
+        k.meanQueue   = state.queued.mean(now);
+        return k;
+    }
+
+    // Remaining pack time for one order, clamped like every other duration here
+    static double packTime(const PackerState& s, const CustomerData& cust) {
+        if (cust.searchTime > 0.0) return cust.searchTime;
+        return (cust.numItems > 0)
+            ? (static_cast<double>(cust.numItems) * s.defaultPackTimePerItem)
+            : s.defaultPackTimePerItem;
+    }
+
+    // Move orders from the queue onto free packers and refresh phase/sigma.
+    // `released`: they start because a packer just finished (IPA: at that
+    // completion, see ipa_gradient.hpp), not on their own arrival.
+    static void startWaiting(PackerState& s, bool released = false) {
+        while (static_cast<int>(s.active.size()) < s.packers && !s.q.empty()) {
+            const CustomerData next = s.q.front();
+            s.q.pop();
+            s.active.push_back({next, packTime(s, next)});
+            PackerState::Job& job = s.active.back();
+            job.cust.ipa = (released ? s.dFreed : next.ipa).plusService(IpaParam::PACK, job.remaining);
+            traceEnd(s.clock, next, TraceStage::PACK_QUEUE);
+            traceBegin(s.clock, next, TraceStage::PACKING);
+        }
+
+        s.sigma = std::numeric_limits<double>::infinity();
+        for (const auto& job : s.active) {
+            s.sigma = std::min(s.sigma, job.remaining);
+        }
+        s.phase = s.active.empty() ? PackerState::Phase::IDLE : PackerState::Phase::PACKING;
+
+        // Every transition ends here, so the statistics see each change
+        s.busy.set(s.clock, static_cast<double>(s.active.size()));
+        s.queued.set(s.clock, static_cast<double>(s.q.size()));
+    }
+
+    // Elapse `e` seconds of packing on every order in progress.
+    static void advance(PackerState& s, double e) {
+        s.clock += e;
+        for (auto& job : s.active) {
+            job.remaining = std::max(0.0, job.remaining - e);
+        }
+    }
 };
 
 #endif // PACKER_HPP
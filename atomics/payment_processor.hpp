@@ -3,31 +3,76 @@
 
 #include <cadmium/modeling/devs/atomic.hpp>
 #include <limits>
-#include <queue>
 #include <random>
 #include <algorithm>
+#include <optional>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "customer_data.hpp"
+#include "empirical_distribution.hpp"
+#include "live_metrics.hpp"
+#include "reneging_queue.hpp"
+#include "lifecycle_trace.hpp"
+#include "time_weighted.hpp"
+#include "random_streams.hpp"
 
 using namespace cadmium;
 
+// Payment durations are uniform on these ranges (seconds), unless the
+// processor is given till data histograms (till_profile.hpp)
+static constexpr double CARD_PAY_MIN = 5.0;
+static constexpr double CARD_PAY_MAX = 15.0;
+static constexpr double CASH_PAY_MIN = 30.0;
+static constexpr double CASH_PAY_MAX = 120.0;
+
 struct PaymentProcessorState {
-    enum class Phase { IDLE, BUSY } phase;
-    double sigma;
+    enum class Phase { IDLE, BUSY } phase;   // BUSY while any terminal is in use
+    int    terminals = 1;  // payments taken in parallel (0 while a schedule closes them all)
+    double sigma;          // time to the earliest payment completion
+    double clock = 0.0;    // simulated time, for patience deadlines
+
+    struct Payment {
+        CustomerData cust;
+        double remaining = 0.0;      // payment time left
+    };
+    std::vector<Payment> active;     // at most `terminals` payments in progress
+    RenegingQueue<CustomerData> q;   // waiting customers leave at enqueue time + patience
+    long reneged = 0;
+    IpaGradient dFreed;              // derivative of the latest completion (ipa_gradient.hpp)
 
-    CustomerData current;
-    std::queue<CustomerData> q;
+    LevelIntegral busy;      // terminals in use (active.size())
+    LevelIntegral queued;    // q.size()
+    LevelIntegral open;      // terminals open (changes with a shift roster)
 
-    PaymentProcessorState()
+    explicit PaymentProcessorState(int numTerminals = 1)
         : phase(Phase::IDLE),
+          terminals(std::max(1, numTerminals)),
           sigma(std::numeric_limits<double>::infinity()),
-          current(),
-          q() {}
+          active(),
+          q() {
+        open.set(0.0, terminals);
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const PaymentProcessorState::Payment& p) {
+    os << "{cust:" << p.cust << ",remaining:" << p.remaining << "}";
+    return os;
+}
+
+// What the terminals still have to do at some time (PaymentProcessor::backlog)
+struct PaymentBacklog {
+    std::vector<double> terminalFree;   // when each open terminal can take a new customer
+    std::vector<double> done;           // completions of the payments in progress and queued, ascending
 };
 
+// Single-terminal logs keep their original format.
 inline std::ostream& operator<<(std::ostream& os, const PaymentProcessorState& s) {
     os << "{phase:" << (s.phase == PaymentProcessorState::Phase::IDLE ? "idle" : "busy")
-       << ",sigma:" << s.sigma
-       << ",queued:" << s.q.size()
+       << ",sigma:" << s.sigma;
+    if (s.terminals > 1) os << ",busy:" << s.active.size();
+    os << ",queued:" << s.q.size()
+       << ",reneged:" << s.reneged
        << "}";
     return os;
 }
@@ -36,65 +81,235 @@ class PaymentProcessor : public Atomic<PaymentProcessorState> {
 public:
     Port<CustomerData> custIn;   // from registers
     Port<CustomerData> custOut;  // to Traveler + Packer
+    Port<int> in_terminals;      // terminals open from now on (ShiftSchedule)
+    Port<PaymentProcessorState::Payment> in_started;   // payments under way in hybrid mode's fluid (Distributor)
 
-    explicit PaymentProcessor(const std::string& id)
-        : Atomic<PaymentProcessorState>(id, PaymentProcessorState()),
-          cardDist_(5.0,  15.0),    // tap/card: 5–15 seconds
-          cashDist_(30.0, 120.0)    // cash:    30–120 seconds
+    // Payment times are a keyed stream (random_streams.hpp): each customer's
+    // draw depends only on the seed and their id, not on the order in which
+    // customers reach the terminal, so configurations compare on equal terms.
+    explicit PaymentProcessor(const std::string& id,
+                              std::optional<unsigned int> seed = std::nullopt,
+                              bool antithetic = false,
+                              int terminals = 1,
+                              std::shared_ptr<const EmpiricalDistribution> cardTimes = nullptr,
+                              std::shared_ptr<const EmpiricalDistribution> cashTimes = nullptr)
+        : Atomic<PaymentProcessorState>(id, PaymentProcessorState(terminals)),
+          stream_(seed.has_value() ? *seed : std::random_device{}()),
+          antithetic_(antithetic),
+          cardTimes_(std::move(cardTimes)),
+          cashTimes_(std::move(cashTimes))
     {
         custIn  = addInPort<CustomerData>("custIn");
         custOut = addOutPort<CustomerData>("custOut");
+        in_terminals = addInPort<int>("in_terminals");
+        in_started   = addInPort<PaymentProcessorState::Payment>("in_started");
     }
 
     void externalTransition(PaymentProcessorState& s, double e) const override {
-        // Advance remaining service time if we're busy
-        if (s.phase == PaymentProcessorState::Phase::BUSY) {
-            s.sigma = std::max(0.0, s.sigma - e);
-        }
+        advance(s, e);
 
-        if (custIn->empty()) return;
+        // Fewer terminals: payments in progress finish, no new ones start
+        // until below the count. More: the queue moves up first.
+        for (int terminals : in_terminals->getBag()) {
+            s.terminals = std::max(0, terminals);
+            s.dFreed = IpaGradient();   // a roster change is not a completion
+        }
+        // Payments handed over mid-way already hold a terminal
+        for (const auto& p : in_started->getBag()) {
+            s.active.push_back(p);
+            traceBegin(s.clock, p.cust, TraceStage::PAYMENT);
+        }
+        startQueued(s);
 
         for (const auto& cust : custIn->getBag()) {
-            if (s.phase == PaymentProcessorState::Phase::IDLE) {
-                s.current = cust;
-                s.phase   = PaymentProcessorState::Phase::BUSY;
-                s.sigma   = samplePayTime(cust.paymentType);
+            if (static_cast<int>(s.active.size()) < s.terminals) {
+                startPayment(s, cust, cust.ipa);
             } else {
-                s.q.push(cust);
+                CustomerData waiting = cust;
+                waiting.queuedAt = s.clock;
+                s.q.push(waiting, s.clock + cust.patience);
+                traceBegin(s.clock, cust, TraceStage::PAY_QUEUE);
             }
         }
+
+        refresh(s);
+        if (metrics_) metrics_->paymentQueue(s.q.size());
     }
 
     void output(const PaymentProcessorState& s) const override {
-        if (s.phase == PaymentProcessorState::Phase::BUSY) {
-            custOut->addMessage(s.current);
+        if (!serviceDue(s)) return;
+        // Every payment finishing at the earliest completion time leaves together
+        for (const auto& p : s.active) {
+            if (p.remaining <= s.sigma) custOut->addMessage(p.cust);
         }
     }
 
     void internalTransition(PaymentProcessorState& s) const override {
-        if (!s.q.empty()) {
-            s.current = s.q.front();
-            s.q.pop();
-            s.phase = PaymentProcessorState::Phase::BUSY;
-            s.sigma = samplePayTime(s.current.paymentType);
-        } else {
-            s.phase = PaymentProcessorState::Phase::IDLE;
-            s.sigma = std::numeric_limits<double>::infinity();
-            s.current = CustomerData();
+        if (!serviceDue(s)) {
+            // A waiting customer's patience ran out before the next payment finished
+            const double deadline = s.q.nextDeadline();
+            advance(s, deadline - s.clock);
+            s.clock = deadline;
+            while (!s.q.empty() && s.q.nextDeadline() <= s.clock) {
+                const CustomerData gone = s.q.popExpired();
+                traceEnd(s.clock, gone, TraceStage::PAY_QUEUE);
+                traceInstant(s.clock, gone, TraceStage::RENEGED, static_cast<int>(TraceStage::PAY_QUEUE));
+                ++s.reneged;
+            }
+            refresh(s);
+            if (metrics_) metrics_->paymentQueue(s.q.size());
+            return;
+        }
+
+        const double done = s.sigma;
+        for (const auto& p : s.active) {
+            if (p.remaining <= done) {
+                traceEnd(s.clock + done, p.cust, TraceStage::PAYMENT);
+                s.dFreed = p.cust.ipa;
+            }
         }
+        s.active.erase(std::remove_if(s.active.begin(), s.active.end(),
+                                      [done](const PaymentProcessorState::Payment& p) { return p.remaining <= done; }),
+                       s.active.end());
+        advance(s, done);
+        startQueued(s);
+
+        refresh(s);
+        if (metrics_) metrics_->paymentQueue(s.q.size());
     }
 
     [[nodiscard]] double timeAdvance(const PaymentProcessorState& s) const override {
-        return s.sigma;
+        return std::min(s.sigma, std::max(0.0, s.q.nextDeadline() - s.clock));
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    // Customers queued while a terminal is free (a fork with more terminals
+    // than the snapshot) start paying at once.
+    const PaymentProcessorState& getState() const { return state; }
+    void setState(const PaymentProcessorState& s) {
+        state = s;
+        startQueued(state);
+        refresh(state);
+    }
+
+    // Draws are keyed by customer, so the stream key is the whole RNG state.
+    using RngState = uint64_t;
+    RngState getRng() const { return stream_; }
+    void setRng(RngState r) { stream_ = r; }
+
+    // Optional live metrics feed (see live_metrics.hpp)
+    void setMetrics(LiveMetricsWriter* metrics) { metrics_ = metrics; }
+
+    // Optional callback per customer starting payment (time, total time spent
+    // queueing for checkout and payment), e.g. for wait-time tail estimates.
+    void setObserver(std::function<void(double, double)> observer) { observer_ = std::move(observer); }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp); utilisation is
+    // busy terminal-seconds over open terminal-seconds, so roster changes count
+    StationKpis kpis(double now) const {
+        StationKpis k;
+        const double openTime = state.open.integral(now);
+        k.busyTime    = state.busy.integral(now);
+        k.utilisation = openTime > 0.0 ? k.busyTime / openTime : 0.0;
+        k.meanQueue   = state.queued.mean(now);
+        return k;
+    }
+
+    // The work left at `now`, for hybrid mode's fluid payment stage
+    // (fluid_walkin.hpp). The queue is played forward in order with each
+    // customer's own payment time; those who would give up first are left out.
+    PaymentBacklog backlog(double now) const {
+        PaymentBacklog b;
+        const double e = now - state.clock;
+        for (const auto& p : state.active) b.done.push_back(now + std::max(0.0, p.remaining - e));
+        std::sort(b.done.begin(), b.done.end());
+
+        // With more payments in progress than open terminals (a roster
+        // closed some), a terminal frees up only once the count drops below
+        const size_t open = static_cast<size_t>(std::max(0, state.terminals));
+        if (open == 0) {
+            b.terminalFree.push_back(std::numeric_limits<double>::infinity());
+            return b;
+        }
+        if (b.done.size() >= open) {
+            b.terminalFree.assign(b.done.end() - static_cast<long>(open), b.done.end());
+        } else {
+            b.terminalFree = b.done;
+            b.terminalFree.resize(open, now);
+        }
+        state.q.forEach([&](const CustomerData& cust) {
+            auto terminal = std::min_element(b.terminalFree.begin(), b.terminalFree.end());
+            const double start = std::max(now, *terminal);
+            if (start > cust.queuedAt + cust.patience) return;
+            *terminal = start + samplePayTime(cust);
+            b.done.push_back(*terminal);
+        });
+        std::sort(b.done.begin(), b.done.end());
+        return b;
+    }
+
+    // Elapse `e` seconds of every payment in progress.
+    static void advance(PaymentProcessorState& s, double e) {
+        s.clock += e;
+        for (auto& p : s.active) {
+            p.remaining = std::max(0.0, p.remaining - e);
+        }
     }
 
 private:
-    mutable std::mt19937 rng_{std::random_device{}()};
-    mutable std::uniform_real_distribution<double> cardDist_;
-    mutable std::uniform_real_distribution<double> cashDist_;
+    LiveMetricsWriter* metrics_ = nullptr;
+    std::function<void(double, double)> observer_;
+
+    uint64_t stream_;
+    bool     antithetic_;
+    std::shared_ptr<const EmpiricalDistribution> cardTimes_;   // nullptr = uniform CARD_PAY_MIN..MAX
+    std::shared_ptr<const EmpiricalDistribution> cashTimes_;   // nullptr = uniform CASH_PAY_MIN..MAX
+
+    // `dStart` is the derivative of now: the customer's arrival, or the
+    // completion that freed the terminal
+    void startPayment(PaymentProcessorState& s, const CustomerData& cust, const IpaGradient& dStart) const {
+        s.active.push_back({cust, samplePayTime(cust)});
+        PaymentProcessorState::Payment& p = s.active.back();
+        p.cust.ipa = dStart.plusService(cust.paymentType ? IpaParam::CARD_PAY : IpaParam::CASH_PAY, p.remaining);
+        traceBegin(s.clock, cust, TraceStage::PAYMENT);
+        if (observer_) observer_(s.clock, cust.waited);
+    }
+
+    // Move waiting customers onto free terminals.
+    void startQueued(PaymentProcessorState& s) const {
+        while (static_cast<int>(s.active.size()) < s.terminals && !s.q.empty()) {
+            CustomerData next = s.q.pop();
+            next.waited += s.clock - next.queuedAt;
+            traceEnd(s.clock, next, TraceStage::PAY_QUEUE);
+            startPayment(s, next, s.dFreed);
+        }
+    }
+
+    // Phase, sigma and statistics after every change
+    static void refresh(PaymentProcessorState& s) {
+        s.sigma = std::numeric_limits<double>::infinity();
+        for (const auto& p : s.active) {
+            s.sigma = std::min(s.sigma, p.remaining);
+        }
+        s.phase = s.active.empty() ? PaymentProcessorState::Phase::IDLE : PaymentProcessorState::Phase::BUSY;
+        s.busy.set(s.clock, static_cast<double>(s.active.size()));
+        s.queued.set(s.clock, static_cast<double>(s.q.size()));
+        s.open.set(s.clock, static_cast<double>(s.terminals));
+    }
+
+    // The next event completes a payment (ties go to service)
+    static bool serviceDue(const PaymentProcessorState& s) {
+        return !s.active.empty()
+            && s.sigma <= s.q.nextDeadline() - s.clock;
+    }
 
-    double samplePayTime(bool paymentType) const {
-        return paymentType ? cardDist_(rng_) : cashDist_(rng_);
+    // tap/card: 5–15 seconds, cash: 30–120 seconds, or the till data histogram
+    double samplePayTime(const CustomerData& cust) const {
+        const double u = keyedUniform(stream_, static_cast<uint64_t>(cust.customerId), antithetic_);
+        const EmpiricalDistribution* hist = cust.paymentType ? cardTimes_.get() : cashTimes_.get();
+        if (hist) return hist->sample(u);
+        return cust.paymentType ? CARD_PAY_MIN + u * (CARD_PAY_MAX - CARD_PAY_MIN)
+                                : CASH_PAY_MIN + u * (CASH_PAY_MAX - CASH_PAY_MIN);
     }
 };
 
@@ -0,0 +1,217 @@
+#ifndef ROUTING_POLICY_HPP
+#define ROUTING_POLICY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "customer_data.hpp"
+
+// ---- DEFAULT LANE COUNTS (each Distributor can override them) ----
+static constexpr int CASH_LANES  = 3;
+static constexpr int SELF_LANES  = 2;
+static constexpr int TOTAL_LANES = CASH_LANES + SELF_LANES;
+
+static constexpr int SELF_ITEM_LIMIT = 15;
+
+// ---- Max queue per lane (change be changed if wanted more)
+static constexpr int MAX_QUEUE = 2;
+
+// Lanes a Distributor routes to: staffed lanes are ids [0, cashLanes),
+// self-checkout lanes follow. Lane speeds let it track outstanding work.
+struct LaneLayout {
+    int    cashLanes       = CASH_LANES;
+    int    selfLanes       = SELF_LANES;
+    int    maxQueue        = MAX_QUEUE;
+    int    selfItemLimit   = SELF_ITEM_LIMIT;
+    double cashTimePerItem = 1.0;
+    double selfTimePerItem = 0.8;
+    std::vector<double> speed;   // per laneId, service time is divided by it; empty = all 1
+    int    selfKiosks      = 1;  // servers behind each self-checkout lane (> 1 for a SelfCheckoutBank)
+
+    int total() const { return cashLanes + selfLanes; }
+
+    // Servers behind a lane, and the customers it takes (in service + waiting)
+    int servers(int lane) const { return lane < cashLanes ? 1 : std::max(1, selfKiosks); }
+    int capacity(int lane) const { return maxQueue * servers(lane); }
+
+    // Same service time Cash will use for this customer on this lane (its
+    // mean when the lanes sample till data, see till_profile.hpp)
+    double serviceTime(int lane, const CustomerData& cust) const {
+        const double tpi = (lane < cashLanes) ? cashTimePerItem : selfTimePerItem;
+        const double t = (cust.numItems > 0) ? cust.numItems * tpi : tpi;
+        return speed.empty() ? t : t / speed[lane];
+    }
+};
+
+// laneId for a model name ("cash<i>" or "self<i>"), or -1 if the layout has no such lane.
+inline int laneIdFromName(const std::string& name, int cashLanes, int selfLanes) {
+    const bool cash = name.rfind("cash", 0) == 0;
+    const bool self = name.rfind("self", 0) == 0;
+    const std::string digits = name.substr(std::min<size_t>(4, name.size()));
+    if (!(cash || self) || digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos) {
+        return -1;
+    }
+    const int index = std::stoi(digits);
+    if (index >= (cash ? cashLanes : selfLanes)) return -1;
+    return cash ? index : cashLanes + index;
+}
+
+// Open lanes, one bit per laneId: testing or flipping a lane is O(1).
+class LaneMask {
+public:
+    explicit LaneMask(int lanes = 0) : words_((std::max(0, lanes) + 63) / 64, ~uint64_t(0)) {}
+
+    bool test(int lane) const { return (words_[lane >> 6] >> (lane & 63)) & 1u; }
+    void set(int lane, bool open) {
+        const uint64_t bit = uint64_t(1) << (lane & 63);
+        if (open) words_[lane >> 6] |= bit;
+        else      words_[lane >> 6] &= ~bit;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+};
+
+// What a policy can see of the lanes when routing one customer.
+struct LaneLoad {
+    const std::vector<int>&    queues;      // customers assigned per lane (in service + waiting)
+    const std::vector<double>& busyUntil;   // time each lane clears its assigned work
+    double now;
+    const LaneMask* open = nullptr;         // lanes taking customers; nullptr = all of them
+    std::mt19937*   rng  = nullptr;         // draws for randomised policies; owned by the caller's state
+
+    double workLeft(int lane) const { return std::max(0.0, busyUntil[lane] - now); }
+    bool isOpen(int lane) const { return !open || open->test(lane); }
+    // Open and below its capacity (maxQueue per server)
+    bool hasSpace(const LaneLayout& layout, int lane) const {
+        return queues[lane] < layout.capacity(lane) && isOpen(lane);
+    }
+};
+
+// Chooses a lane for a walk-in customer, or -1 when no open lane has space.
+// Every policy keeps Distributor's group preference: baskets up to
+// selfItemLimit try self-checkout first, larger ones try staffed lanes first,
+// and the other group is the fallback.
+class RoutingPolicy {
+public:
+    virtual ~RoutingPolicy() = default;
+    virtual int chooseLane(const LaneLayout& layout, const LaneLoad& load, const CustomerData& cust) const = 0;
+    virtual std::string name() const = 0;
+    // Seed for the caller's LaneLoad::rng (policies are stateless and shared)
+    virtual unsigned int seed() const { return 0; }
+
+protected:
+    // Calls pick(start, count) on the preferred group, then the other one.
+    template <typename Pick>
+    static int byPreference(const LaneLayout& layout, const CustomerData& cust, Pick pick) {
+        if (cust.numItems <= layout.selfItemLimit) {
+            const int self = pick(layout.cashLanes, layout.selfLanes);
+            if (self >= 0) return self;
+            return pick(0, layout.cashLanes);
+        } else {
+            const int cash = pick(0, layout.cashLanes);
+            if (cash >= 0) return cash;
+            return pick(layout.cashLanes, layout.selfLanes);
+        }
+    }
+
+    // Smallest queue with space in [start, start + count): O(count).
+    static int shortestQueue(const LaneLayout& layout, const LaneLoad& load, int start, int count) {
+        int best = -1;
+        int bestLen = 1e9;
+        for (int i = 0; i < count; ++i) {
+            const int lane = start + i;
+            if (load.queues[lane] < bestLen && load.hasSpace(layout, lane)) {
+                best = lane;
+                bestLen = load.queues[lane];
+            }
+        }
+        return best;
+    }
+};
+
+// The original rule: shortest queue (by length) within the preferred group.
+class ShortestQueuePolicy : public RoutingPolicy {
+public:
+    int chooseLane(const LaneLayout& layout, const LaneLoad& load, const CustomerData& cust) const override {
+        return byPreference(layout, cust, [&](int start, int count) {
+            return shortestQueue(layout, load, start, count);
+        });
+    }
+    std::string name() const override { return "shortest"; }
+};
+
+// Join-least-work-left: the lane with space that will clear its assigned
+// customers soonest (items x timePerItem, minus what is already served).
+class LeastWorkLeftPolicy : public RoutingPolicy {
+public:
+    int chooseLane(const LaneLayout& layout, const LaneLoad& load, const CustomerData& cust) const override {
+        return byPreference(layout, cust, [&](int start, int count) {
+            int best = -1;
+            double bestWork = 0.0;
+            for (int i = 0; i < count; ++i) {
+                const int lane = start + i;
+                if (!load.hasSpace(layout, lane)) continue;
+                const double work = load.workLeft(lane);
+                if (best < 0 || work < bestWork) {
+                    best = lane;
+                    bestWork = work;
+                }
+            }
+            return best;
+        });
+    }
+    std::string name() const override { return "lwl"; }
+};
+
+// Power-of-d choices: sample d lanes of the group and join the shortest with
+// space, O(d) per customer however many lanes there are. Only when none of
+// the samples has space does it fall back to scanning the group. Samples are
+// drawn from LaneLoad::rng, which the Distributor keeps in its state so that
+// snapshots and forks continue the same stream.
+class PowerOfDPolicy : public RoutingPolicy {
+public:
+    explicit PowerOfDPolicy(int d = 2, unsigned int seed = 0)
+        : d_(std::max(1, d)), seed_(seed) {}
+
+    int chooseLane(const LaneLayout& layout, const LaneLoad& load, const CustomerData& cust) const override {
+        return byPreference(layout, cust, [&](int start, int count) {
+            if (count <= 0) return -1;
+            if (count <= d_) return shortestQueue(layout, load, start, count);
+            if (!load.rng) throw std::logic_error("pod routing needs LaneLoad::rng");
+
+            std::uniform_int_distribution<int> pickLane(start, start + count - 1);
+            int best = -1;
+            for (int k = 0; k < d_; ++k) {
+                const int lane = pickLane(*load.rng);
+                if (load.hasSpace(layout, lane) &&
+                    (best < 0 || load.queues[lane] < load.queues[best])) {
+                    best = lane;
+                }
+            }
+            return (best >= 0) ? best : shortestQueue(layout, load, start, count);
+        });
+    }
+    std::string name() const override { return "pod" + std::to_string(d_); }
+    unsigned int seed() const override { return seed_; }
+
+private:
+    int          d_;
+    unsigned int seed_;
+};
+
+// "shortest", "lwl", or "pod<d>" (e.g. "pod2").
+inline std::shared_ptr<const RoutingPolicy> makeRoutingPolicy(const std::string& name, unsigned int seed = 0) {
+    if (name == "shortest") return std::make_shared<ShortestQueuePolicy>();
+    if (name == "lwl")      return std::make_shared<LeastWorkLeftPolicy>();
+    if (name.rfind("pod", 0) == 0 && name.size() > 3) {
+        return std::make_shared<PowerOfDPolicy>(std::stoi(name.substr(3)), seed);
+    }
+    throw std::invalid_argument("unknown routing policy: " + name);
+}
+
+#endif // ROUTING_POLICY_HPP
@@ -0,0 +1,200 @@
+#ifndef SELF_CHECKOUT_BANK_HPP
+#define SELF_CHECKOUT_BANK_HPP
+
+#include <cadmium/modeling/devs/atomic.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "cash.hpp"
+#include "fork_queue.hpp"
+
+using namespace cadmium;
+
+// ---- Self-checkout bank: one shared line feeding a bank of kiosks ----
+// Replaces the separate self-checkout Cash lanes with a single routing
+// target. Customers wait in one FIFO and take the first kiosk to free up, so
+// no kiosk is idle while someone waits. Kiosks in use are kept in a min-heap
+// on their completion time: the next event is the earliest completion, and
+// each arrival or departure costs O(log kiosks). Ports match Cash, with one
+// out_free per departing customer, so Distributor treats the bank as one lane
+// of `kiosks` servers (LaneLayout::selfKiosks).
+
+static constexpr int SELF_KIOSKS = 8;
+
+struct SelfCheckoutBankState {
+    enum class Phase { IDLE, BUSY } phase;   // BUSY while any kiosk is in use
+    int    laneId;
+    int    kiosks;
+    double timePerItem;
+    double sigma;          // time to the earliest completion
+    double clock = 0.0;    // simulated time; completions are absolute times
+
+    struct Checkout {
+        double       doneAt = 0.0;
+        CustomerData cust;
+    };
+    std::vector<Checkout>    active;   // min-heap on doneAt, at most `kiosks`
+    ForkQueue<CustomerData> q;        // the shared line
+
+    double      lastDeparture = -std::numeric_limits<double>::infinity();
+    IpaGradient dLastDeparture;        // its derivative (ipa_gradient.hpp)
+
+    LevelIntegral busy;      // kiosks in use
+    LevelIntegral queued;    // q.size()
+
+    SelfCheckoutBankState(int lane = 0, int numKiosks = SELF_KIOSKS, double tpi = 0.8)
+        : phase(Phase::IDLE),
+          laneId(lane),
+          kiosks(std::max(1, numKiosks)),
+          timePerItem(tpi),
+          sigma(std::numeric_limits<double>::infinity()),
+          active(),
+          q() {}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const SelfCheckoutBankState& s) {
+    os << "{phase:" << (s.phase == SelfCheckoutBankState::Phase::IDLE ? "idle" : "busy")
+       << ",lane:" << s.laneId
+       << ",sigma:" << s.sigma
+       << ",busy:" << s.active.size()
+       << ",queued:" << s.q.size()
+       << "}";
+    return os;
+}
+
+class SelfCheckoutBank : public Atomic<SelfCheckoutBankState> {
+public:
+    Port<CustomerData> in_customer;
+    Port<CustomerData> out_toPayment;
+    Port<int>          out_free;
+
+    SelfCheckoutBank(const std::string& id, int lane, int kiosks = SELF_KIOSKS, double timePerItem = 0.8,
+                     LaneService service = LaneService())
+        : Atomic<SelfCheckoutBankState>(id, SelfCheckoutBankState(lane, kiosks, timePerItem)),
+          service_(std::move(service))
+    {
+        in_customer   = addInPort<CustomerData>("in_customer");
+        out_toPayment = addOutPort<CustomerData>("out_toPayment");
+        out_free      = addOutPort<int>("out_free");
+    }
+
+    void externalTransition(SelfCheckoutBankState& s, double e) const override {
+        s.clock += e;
+
+        for (const auto& arrived : in_customer->getBag()) {
+            CustomerData cust = arrived;
+            // Released from the entry queue by a departure at this instant
+            if (cust.arrivalTime < s.clock && s.lastDeparture == s.clock) cust.ipa = s.dLastDeparture;
+
+            if (static_cast<int>(s.active.size()) < s.kiosks) {
+                startService(s, cust, cust.ipa);
+            } else {
+                s.q.push(cust);
+                traceBegin(s.clock, cust, TraceStage::LANE_QUEUE, s.laneId);
+            }
+        }
+
+        refresh(s);
+        if (metrics_) metrics_->lane(s.laneId, !s.active.empty(), s.q.size());
+    }
+
+    void output(const SelfCheckoutBankState& s) const override {
+        // Every kiosk finishing at the earliest completion time frees together
+        const double done = s.clock + s.sigma;
+        for (const auto& c : s.active) {
+            if (c.doneAt <= done) {
+                out_toPayment->addMessage(c.cust);
+                out_free->addMessage(s.laneId);
+            }
+        }
+    }
+
+    void internalTransition(SelfCheckoutBankState& s) const override {
+        s.clock += s.sigma;
+        while (!s.active.empty() && s.active.front().doneAt <= s.clock) {
+            std::pop_heap(s.active.begin(), s.active.end(), later);
+            const CustomerData& cust = s.active.back().cust;
+            traceEnd(s.clock, cust, TraceStage::CHECKOUT, s.laneId);
+            s.lastDeparture  = s.clock;
+            s.dLastDeparture = cust.ipa;
+            s.active.pop_back();
+        }
+        startQueued(s);
+
+        refresh(s);
+        if (metrics_) metrics_->lane(s.laneId, !s.active.empty(), s.q.size());
+    }
+
+    [[nodiscard]] double timeAdvance(const SelfCheckoutBankState& s) const override {
+        return s.sigma;
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp). Customers
+    // waiting while a kiosk is free (a fork with more kiosks) start at once.
+    const SelfCheckoutBankState& getState() const { return state; }
+    void setState(const SelfCheckoutBankState& s) {
+        state = s;
+        std::make_heap(state.active.begin(), state.active.end(), later);
+        startQueued(state);
+        refresh(state);
+    }
+
+    // Per-item draws are keyed by customer, so the stream key is the whole RNG state.
+    using RngState = uint64_t;
+    RngState getRng() const { return service_.key; }
+    void setRng(RngState r) { service_.key = r; }
+
+    // Optional live metrics feed (see live_metrics.hpp)
+    void setMetrics(LiveMetricsWriter* metrics) { metrics_ = metrics; }
+
+    // Time-weighted KPIs up to `now` (see time_weighted.hpp); utilisation is per kiosk
+    StationKpis kpis(double now) const {
+        StationKpis k;
+        k.busyTime    = state.busy.integral(now);
+        k.utilisation = state.busy.mean(now) / state.kiosks;
+        k.meanQueue   = state.queued.mean(now);
+        return k;
+    }
+
+private:
+    LiveMetricsWriter* metrics_ = nullptr;
+    LaneService        service_;
+
+    static bool later(const SelfCheckoutBankState::Checkout& a, const SelfCheckoutBankState::Checkout& b) {
+        return a.doneAt > b.doneAt;
+    }
+
+    // `dStart` is the derivative of now: the customer's arrival, or the
+    // departure that freed the kiosk
+    void startService(SelfCheckoutBankState& s, const CustomerData& cust, const IpaGradient& dStart) const {
+        const double t = service_.serviceTime(s.timePerItem, cust);
+        s.active.push_back({s.clock + t, cust});
+        CustomerData& started = s.active.back().cust;
+        // Everything between store entry and now was spent queueing
+        started.waited = std::max(0.0, s.clock - cust.arrivalTime);
+        started.ipa    = dStart.plusService(service_.ipaParam, t);
+        std::push_heap(s.active.begin(), s.active.end(), later);
+        traceBegin(s.clock, cust, TraceStage::CHECKOUT, s.laneId);
+    }
+
+    // Move the head of the line onto free kiosks.
+    void startQueued(SelfCheckoutBankState& s) const {
+        while (static_cast<int>(s.active.size()) < s.kiosks && !s.q.empty()) {
+            const CustomerData next = s.q.front();
+            s.q.pop();
+            traceEnd(s.clock, next, TraceStage::LANE_QUEUE, s.laneId);
+            startService(s, next, s.dLastDeparture);
+        }
+    }
+
+    // Phase, sigma and statistics after every change
+    static void refresh(SelfCheckoutBankState& s) {
+        s.sigma = s.active.empty() ? std::numeric_limits<double>::infinity()
+                                   : std::max(0.0, s.active.front().doneAt - s.clock);
+        s.phase = s.active.empty() ? SelfCheckoutBankState::Phase::IDLE : SelfCheckoutBankState::Phase::BUSY;
+        s.busy.set(s.clock, static_cast<double>(s.active.size()));
+        s.queued.set(s.clock, static_cast<double>(s.q.size()));
+    }
+};
+
+#endif // SELF_CHECKOUT_BANK_HPP
@@ -0,0 +1,163 @@
+#ifndef SHIFT_SCHEDULE_HPP
+#define SHIFT_SCHEDULE_HPP
+
+#include <cadmium/modeling/devs/atomic.hpp>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "routing_policy.hpp"
+
+using namespace cadmium;
+
+// ---- Staffing roster: lanes and payment terminals opening and closing ----
+// A schedule file lists changes at simulated times, one per line:
+//   # seconds  action     what
+//   0          close      cash2
+//   0          terminals  1
+//   3600       open       cash2
+//   5400       terminals  2
+//   7200       close      self0
+// Lanes are named like their models (cash<i>, self<i>). Closing a lane stops
+// the Distributor routing to it; customers already assigned to it are still
+// served, as behind a "lane closed" sign. Lowering the terminal count lets
+// payments in progress finish. Lines at the same time apply together.
+
+// Open or close one lane (laneId, as Distributor numbers them).
+struct LaneShift {
+    int  lane = -1;
+    bool open = true;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LaneShift& s) {
+    os << "{lane:" << s.lane << ",open:" << (s.open ? 1 : 0) << "}";
+    return os;
+}
+
+struct ShiftChange {
+    double time = 0.0;
+    enum class Kind { LANE, TERMINALS } kind = Kind::LANE;
+    LaneShift lane;
+    int terminals = 0;
+};
+
+// Reads a schedule file for a store with the given lane counts. Throws
+// std::invalid_argument naming the line for anything it cannot use.
+inline std::vector<ShiftChange> loadShiftSchedule(const std::string& path, int cashLanes, int selfLanes) {
+    std::ifstream in(path);
+    if (!in) throw std::invalid_argument("cannot open shift schedule " + path);
+
+    std::vector<ShiftChange> changes;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        const std::string where = path + ":" + std::to_string(lineNo);
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        ShiftChange c;
+        std::string action, what;
+        if (!(ss >> c.time)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            throw std::invalid_argument(where + ": expected '<seconds> <action> <what>'");
+        }
+        if (!(ss >> action >> what) || c.time < 0.0) {
+            throw std::invalid_argument(where + ": expected '<seconds> <action> <what>'");
+        }
+
+        if (action == "terminals") {
+            c.kind = ShiftChange::Kind::TERMINALS;
+            c.terminals = std::stoi(what);
+            if (c.terminals < 0) throw std::invalid_argument(where + ": negative terminal count");
+        } else if (action == "open" || action == "close") {
+            c.kind = ShiftChange::Kind::LANE;
+            c.lane.open = (action == "open");
+            c.lane.lane = laneIdFromName(what, cashLanes, selfLanes);
+            if (c.lane.lane < 0) throw std::invalid_argument(where + ": no lane " + what);
+        } else {
+            throw std::invalid_argument(where + ": unknown action " + action + " (open, close, terminals)");
+        }
+        changes.push_back(c);
+    }
+
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const ShiftChange& a, const ShiftChange& b) { return a.time < b.time; });
+    return changes;
+}
+
+struct ShiftScheduleState {
+    size_t next = 0;       // first change not yet applied
+    double sigma;          // until changes[next]
+    double clock = 0.0;    // simulated time, so change times stay exact
+
+    ShiftScheduleState() : sigma(std::numeric_limits<double>::infinity()) {}
+};
+
+inline std::ostream& operator<<(std::ostream& os, const ShiftScheduleState& s) {
+    os << "{next:" << s.next << ",sigma:" << s.sigma << "}";
+    return os;
+}
+
+class ShiftSchedule : public Atomic<ShiftScheduleState> {
+public:
+    Port<LaneShift> out_lane;        // to Distributor
+    Port<int>       out_terminals;   // to PaymentProcessor: terminals open from now on
+
+    ShiftSchedule(const std::string& id, std::vector<ShiftChange> changes)
+        : Atomic<ShiftScheduleState>(id, ShiftScheduleState()),
+          changes_(std::move(changes))
+    {
+        out_lane      = addOutPort<LaneShift>("out_lane");
+        out_terminals = addOutPort<int>("out_terminals");
+        if (!changes_.empty()) state.sigma = changes_.front().time;
+    }
+
+    void externalTransition(ShiftScheduleState& s, double e) const override {
+        // No inputs; kept for completeness
+        s.clock += e;
+        s.sigma = std::max(0.0, s.sigma - e);
+    }
+
+    void output(const ShiftScheduleState& s) const override {
+        for (size_t i = s.next; i < changes_.size() && changes_[i].time == changes_[s.next].time; ++i) {
+            const ShiftChange& c = changes_[i];
+            if (c.kind == ShiftChange::Kind::LANE) out_lane->addMessage(c.lane);
+            else                                   out_terminals->addMessage(c.terminals);
+        }
+    }
+
+    void internalTransition(ShiftScheduleState& s) const override {
+        s.clock = changes_[s.next].time;
+        while (s.next < changes_.size() && changes_[s.next].time == s.clock) ++s.next;
+        s.sigma = (s.next < changes_.size())
+            ? changes_[s.next].time - s.clock
+            : std::numeric_limits<double>::infinity();
+    }
+
+    [[nodiscard]] double timeAdvance(const ShiftScheduleState& s) const override {
+        return s.sigma;
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp). The
+    // position is found again from the clock, so a fork with another roster
+    // resumes at its first change not yet due; changes due exactly now were
+    // applied unless the snapshot still had them pending (sigma 0).
+    const ShiftScheduleState& getState() const { return state; }
+    void setState(const ShiftScheduleState& s) {
+        state = s;
+        auto due = [&](const ShiftChange& c) {
+            return s.sigma == 0.0 ? c.time < s.clock : c.time <= s.clock;
+        };
+        state.next = static_cast<size_t>(std::find_if_not(changes_.begin(), changes_.end(), due) - changes_.begin());
+        state.sigma = (state.next < changes_.size())
+            ? changes_[state.next].time - s.clock
+            : std::numeric_limits<double>::infinity();
+    }
+
+private:
+    std::vector<ShiftChange> changes_;
+};
+
+#endif // SHIFT_SCHEDULE_HPP
@@ -5,13 +5,18 @@
 #include <limits>
 #include <string>
 #include "customer_data.hpp"
+#include "lifecycle_trace.hpp"
 
 using namespace cadmium;
 
+// Default walk to the exit: TRAVEL_STEPS steps of 1 time unit each
+static constexpr int TRAVEL_STEPS = 10;
+
 struct travelerState {
     enum Phase { IDLE, TRAVELING } phase = IDLE;
 
     double sigma = std::numeric_limits<double>::infinity();
+    double clock = 0.0;   // simulated time, for trace timestamps
 
     int remainingSteps = 0;
     CustomerData current;
@@ -34,7 +39,7 @@ public:
 
     int steps; 
 
-    traveler(const std::string& id, int steps_ = 10)
+    traveler(const std::string& id, int steps_ = TRAVEL_STEPS)
         : Atomic<travelerState>(id, travelerState()),
           steps(steps_)
     {
@@ -46,9 +51,11 @@ public:
     void internalTransition(travelerState& s) const override {
 
         if(s.phase == travelerState::TRAVELING){
+            s.clock += s.sigma;
             s.remainingSteps--;
 
             if(s.remainingSteps <= 0){
+                traceEnd(s.clock, s.current, TraceStage::TRAVEL);
                 s.phase = travelerState::IDLE;
                 s.sigma = std::numeric_limits<double>::infinity();
                 s.hasCustomer = false;
@@ -62,6 +69,7 @@ public:
     void externalTransition(travelerState& s, double e) const override {
 
         // advance time
+        s.clock += e;
         if(s.sigma != std::numeric_limits<double>::infinity())
             s.sigma -= e;
 
@@ -79,6 +87,7 @@ public:
             s.remainingSteps = steps;
             s.phase = travelerState::TRAVELING;
             s.sigma = 1.0;
+            traceBegin(s.clock, c, TraceStage::TRAVEL);
         }
     }
 
@@ -97,6 +106,17 @@ public:
     [[nodiscard]] double timeAdvance(const travelerState& s) const override {
         return s.sigma;
     }
+
+    // When the current walk ends, or -infinity while idle; hybrid mode reads
+    // it when fluid mode starts (fluid_walkin.hpp)
+    double walkEnd() const {
+        if (state.phase != travelerState::TRAVELING) return -std::numeric_limits<double>::infinity();
+        return state.clock + state.sigma + (state.remainingSteps - 1);
+    }
+
+    // State access for warm-up snapshots (see store_snapshot.hpp)
+    const travelerState& getState() const { return state; }
+    void setState(const travelerState& s) { state = s; }
 };
 
 #endif
\ No newline at end of file
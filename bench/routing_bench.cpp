@@ -0,0 +1,163 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "generator.hpp"
+#include "distributor.hpp"
+#include "cash.hpp"
+#include "customer_sink.hpp"
+
+using namespace cadmium;
+
+// Walk-in path only: Generator -> Distributor -> lanes -> sink. The sink's
+// sojourn is time in lane (wait + service), measured from the Distributor.
+struct lane_bench : public Coupled {
+    std::shared_ptr<CustomerSink> sink;
+
+    lane_bench(const std::string& id, const LaneLayout& layout,
+               std::shared_ptr<const RoutingPolicy> policy, double arrivalMean, unsigned int seed)
+        : Coupled(id)
+    {
+        auto gen  = addComponent<Generator>("generator", arrivalMean, 300.0, 60.0, 120.0,
+                                            0.0 /* no online orders */, 0.70, seed);
+        auto dist = addComponent<Distributor>("distributor", layout, std::move(policy));
+        sink      = addComponent<CustomerSink>("sink");
+
+        addCoupling(gen->customerOut, dist->in_customer);
+        addCoupling(dist->out_holdOff, gen->holdOff);
+        addCoupling(dist->out_okGo,    gen->okGo);
+
+        for (int i = 0; i < layout.total(); ++i) {
+            const bool self = i >= layout.cashLanes;
+            auto lane = addComponent<Cash>((self ? "self" : "cash") + std::to_string(i), i,
+                                           self ? layout.selfTimePerItem : layout.cashTimePerItem);
+            addCoupling(dist->out_lanes[i], lane->in_customer);
+            addCoupling(lane->out_free, dist->in_laneFreed);
+            addCoupling(lane->out_toPayment, sink->in);
+        }
+    }
+};
+
+// Layout with `lanes` lanes, 60% staffed, and the default lane speeds.
+static LaneLayout layoutFor(int lanes, int maxQueue) {
+    LaneLayout layout;
+    layout.cashLanes = std::max(1, (lanes * 3) / 5);
+    layout.selfLanes = std::max(1, lanes - layout.cashLanes);
+    layout.maxQueue  = maxQueue;
+    return layout;
+}
+
+// Mean inter-arrival time that loads the lanes to `load` (items ~ U{MIN_ITEMS..MAX_ITEMS}).
+static double arrivalMeanFor(const LaneLayout& layout, double load) {
+    const double meanItems = 0.5 * (MIN_ITEMS + MAX_ITEMS);
+    const double capacity  = layout.cashLanes / (meanItems * layout.cashTimePerItem)
+                           + layout.selfLanes / (meanItems * layout.selfTimePerItem);
+    return 1.0 / (load * capacity);
+}
+
+// Nanoseconds per routing decision on a synthetic, partly busy store: measures the
+// policy alone, without the simulator around it.
+static double routingNanos(const RoutingPolicy& policy, const LaneLayout& layout, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> queueLen(0, layout.maxQueue);
+    std::uniform_real_distribution<double> work(0.0, 60.0);
+    std::uniform_int_distribution<int> items(MIN_ITEMS, MAX_ITEMS);
+
+    std::vector<int> queues(layout.total());
+    std::vector<double> busyUntil(layout.total());
+    for (int i = 0; i < layout.total(); ++i) {
+        queues[i] = queueLen(rng);
+        busyUntil[i] = work(rng);
+    }
+    std::vector<CustomerData> custs(1024);
+    for (auto& c : custs) c.numItems = items(rng);
+
+    std::mt19937 routeRng(policy.seed());
+    const int calls = 200000;
+    long sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < calls; ++k) {
+        sink += policy.chooseLane(layout, LaneLoad{queues, busyUntil, 0.0, nullptr, &routeRng}, custs[k & 1023]);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    if (sink == 42) std::cerr << ""; // keep the loop from being optimised away
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / calls;
+}
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> out;
+    std::stringstream ss(list);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+// routing_bench [--lanes 5,20,80,320] [--policies shortest,lwl,pod2] [--load RHO]
+//               [--maxQueue N] [--horizon SECONDS] [--seed N]
+//
+// For each lane count and policy: mean time in lane from a simulated run of the
+// walk-in path at offered load RHO (arrivals scale with the lane count), the
+// wall-clock cost of the whole run per customer, and the cost of the routing
+// decision alone.
+int main(int argc, char** argv) {
+    std::vector<std::string> laneCounts = {"5", "20", "80", "320"};
+    std::vector<std::string> policies   = {"shortest", "lwl", "pod2"};
+    double load       = 0.85;
+    int    maxQueue   = 4;
+    double horizon    = 4.0 * 3600.0;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--lanes" && i + 1 < argc)         laneCounts = split(argv[++i]);
+        else if (arg == "--policies" && i + 1 < argc) policies   = split(argv[++i]);
+        else if (arg == "--load" && i + 1 < argc)     load       = std::stod(argv[++i]);
+        else if (arg == "--maxQueue" && i + 1 < argc) maxQueue   = std::stoi(argv[++i]);
+        else if (arg == "--horizon" && i + 1 < argc)  horizon    = std::stod(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)     seed       = static_cast<unsigned int>(std::stoul(argv[++i]));
+        else {
+            std::cerr << "usage: routing_bench [--lanes 5,20,80,320] [--policies shortest,lwl,pod2] [--load RHO]\n"
+                      << "                     [--maxQueue N] [--horizon SECONDS] [--seed N]\n";
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(7) << "lanes" << std::setw(10) << "policy"
+              << std::right << std::setw(10) << "customers" << std::setw(14) << "time_in_lane"
+              << std::setw(14) << "sim_us/cust" << std::setw(14) << "route_ns" << "\n";
+
+    for (const std::string& lanesArg : laneCounts) {
+        const LaneLayout layout = layoutFor(std::stoi(lanesArg), maxQueue);
+        const double arrivalMean = arrivalMeanFor(layout, load);
+
+        for (const std::string& name : policies) {
+            // Same seed for every policy: common arrivals and baskets.
+            auto model = std::make_shared<lane_bench>("lane_bench", layout,
+                                                      makeRoutingPolicy(name, seed), arrivalMean, seed);
+            RootCoordinator root(model);
+            const auto t0 = std::chrono::steady_clock::now();
+            root.start();
+            root.simulate(horizon);
+            root.stop();
+            const auto t1 = std::chrono::steady_clock::now();
+
+            const CustomerSinkState& s = model->sink->getState();
+            const double wallUs = std::chrono::duration<double, std::micro>(t1 - t0).count();
+            std::cout << std::left << std::setw(7) << layout.total() << std::setw(10) << name
+                      << std::right << std::setw(10) << s.count
+                      << std::setw(14) << std::fixed << std::setprecision(2) << s.meanSojourn()
+                      << std::setw(14) << (s.count > 0 ? wallUs / s.count : 0.0)
+                      << std::setw(14) << routingNanos(*makeRoutingPolicy(name, seed), layout, seed)
+                      << std::defaultfloat << "\n";
+        }
+    }
+    return 0;
+}
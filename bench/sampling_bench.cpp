@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "empirical_distribution.hpp"
+#include "random_streams.hpp"
+
+// Cost of one service-time draw, and how well the alias table reproduces
+// its histogram. For each histogram size: nanoseconds per draw for the
+// parametric uniform the models used before, std::discrete_distribution
+// (CDF search), a binary search on the cumulative weights, and
+// EmpiricalDistribution (alias table); then the largest difference between a
+// bin's sampled frequency and its weight.
+
+namespace {
+
+// Zipf-like weights, like basket sizes: many small, a long tail.
+std::vector<HistogramBin> skewedBins(int n) {
+    std::vector<HistogramBin> bins(n);
+    for (int i = 0; i < n; ++i) {
+        bins[i].lo = bins[i].hi = i + 1;
+        bins[i].weight = 1.0 / std::pow(i + 1.0, 1.1);
+    }
+    return bins;
+}
+
+template <typename Draw>
+double nanosPerDraw(long draws, Draw&& draw) {
+    double sink = 0.0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (long k = 0; k < draws; ++k) sink += draw(static_cast<uint64_t>(k));
+    const auto t1 = std::chrono::steady_clock::now();
+    if (sink == 42.0) std::cerr << ""; // keep the loop from being optimised away
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(draws);
+}
+
+std::vector<int> parseSizes(const std::string& list) {
+    std::vector<int> out;
+    std::stringstream ss(list);
+    for (std::string item; std::getline(ss, item, ',');) {
+        if (!item.empty()) out.push_back(std::max(1, std::stoi(item)));
+    }
+    return out;
+}
+
+} // namespace
+
+// sampling_bench [--bins 40,1000,100000] [--draws N] [--seed N]
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {40, 1000, 100000};
+    long draws        = 10000000;
+    unsigned int seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--bins" && i + 1 < argc)       sizes = parseSizes(argv[++i]);
+        else if (arg == "--draws" && i + 1 < argc) draws = std::max(1L, std::stol(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc)  seed  = static_cast<unsigned int>(std::stoul(argv[++i]));
+        else {
+            std::cerr << "usage: sampling_bench [--bins 40,1000,100000] [--draws N] [--seed N]\n";
+            return 1;
+        }
+    }
+
+    std::cout << std::right << std::setw(8) << "bins" << std::setw(11) << "uniform"
+              << std::setw(11) << "discrete" << std::setw(11) << "bsearch" << std::setw(11) << "alias"
+              << std::setw(14) << "max |f - p|" << "   (ns per draw)\n";
+
+    for (int n : sizes) {
+        const std::vector<HistogramBin> bins = skewedBins(n);
+        const EmpiricalDistribution alias(bins);
+
+        std::vector<double> weights, cdf;
+        double total = 0.0;
+        for (const auto& b : alias.bins()) {
+            weights.push_back(b.weight);
+            cdf.push_back(total += b.weight);
+        }
+        std::discrete_distribution<int> discrete(weights.begin(), weights.end());
+        std::mt19937 engine(seed);
+
+        // The keyed uniforms the models use; std::discrete_distribution takes an engine
+        const double tUniform = nanosPerDraw(draws, [&](uint64_t k) {
+            return 1.0 + keyedUniform(seed, k) * (n - 1);
+        });
+        const double tDiscrete = nanosPerDraw(draws, [&](uint64_t) {
+            return static_cast<double>(discrete(engine));
+        });
+        const double tSearch = nanosPerDraw(draws, [&](uint64_t k) {
+            const double u = keyedUniform(seed, k);
+            return static_cast<double>(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        });
+        const double tAlias = nanosPerDraw(draws, [&](uint64_t k) {
+            return alias.sample(keyedUniform(seed, k));
+        });
+
+        std::vector<long> counts(n);
+        for (long k = 0; k < draws; ++k) {
+            const int v = static_cast<int>(alias.sample(keyedUniform(seed + 1, static_cast<uint64_t>(k))));
+            ++counts[v - 1];
+        }
+        double maxErr = 0.0;
+        for (int i = 0; i < n; ++i) {
+            maxErr = std::max(maxErr, std::abs(counts[i] / static_cast<double>(draws) - weights[i]));
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << n << std::setw(11) << tUniform << std::setw(11) << tDiscrete
+                  << std::setw(11) << tSearch << std::setw(11) << tAlias
+                  << std::scientific << std::setprecision(2) << std::setw(14) << maxErr
+                  << std::defaultfloat << "\n";
+    }
+    return 0;
+}
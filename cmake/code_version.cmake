@@ -0,0 +1,40 @@
+# Writes OUTPUT (a header defining GROCERY_CODE_VERSION) from the model sources
+# under SOURCE_DIR. Run at every build by the code_version target; the header
+# is only rewritten when the version changes, so unchanged trees do not rebuild.
+#
+# The version is `git describe --always --dirty` plus a hash of the sources'
+# contents, so uncommitted edits and rebuilds without re-running cmake both
+# get a new result cache key (experiments/result_cache.hpp).
+
+execute_process(
+	COMMAND git describe --always --dirty
+	WORKING_DIRECTORY ${SOURCE_DIR}
+	OUTPUT_VARIABLE DESCRIBE
+	OUTPUT_STRIP_TRAILING_WHITESPACE
+	ERROR_QUIET)
+if(NOT DESCRIBE)
+	set(DESCRIBE "dev")
+endif()
+
+file(GLOB_RECURSE SOURCES RELATIVE ${SOURCE_DIR}
+	${SOURCE_DIR}/atomics/*.hpp
+	${SOURCE_DIR}/coupled/*.hpp
+	${SOURCE_DIR}/experiments/*.hpp
+	${SOURCE_DIR}/utils/*.hpp
+	${SOURCE_DIR}/top_model/*.cpp)
+list(SORT SOURCES)
+set(DIGESTS "")
+foreach(SOURCE ${SOURCES})
+	file(SHA256 ${SOURCE_DIR}/${SOURCE} DIGEST)
+	string(APPEND DIGESTS "${SOURCE} ${DIGEST}\n")
+endforeach()
+string(SHA256 TREE_HASH "${DIGESTS}")
+string(SUBSTRING ${TREE_HASH} 0 12 TREE_HASH)
+
+set(CONTENT "// Generated by cmake/code_version.cmake; do not edit.\n#define GROCERY_CODE_VERSION \"${DESCRIBE}+${TREE_HASH}\"\n")
+if(EXISTS ${OUTPUT})
+	file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${CONTENT}" STREQUAL "${OLD_CONTENT}")
+	file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -2,41 +2,138 @@
 #define GROCERY_STORE_HPP
 
 #include <cadmium/modeling/devs/coupled.hpp>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "generator.hpp"
 #include "distributor.hpp"
 #include "cash.hpp"
+#include "self_checkout_bank.hpp"
 #include "payment_processor.hpp"
 #include "traveler.hpp"
 #include "pickup_system.hpp"
 #include "customer_sink.hpp"
+#include "shift_schedule.hpp"
+#include "input_replay.hpp"
+#include "alloc_accounting.hpp"
+#include "store_config.hpp"
+#include "till_profile.hpp"
 
 using namespace cadmium;
 
 // Top-level coupled model for the grocery store.
 struct grocery_store : public Coupled {
-    grocery_store(const std::string& id) : Coupled(id) {
+    // Components, kept so snapshots can read and restore their states.
+    // lanes[i] is the Cash model with laneId i (cash lanes, then self-checkout).
+    // With cfg.selfBank the self-checkout lanes are one SelfCheckoutBank
+    // instead, with laneId cashLanes, and lanes holds the cash lanes only.
+    std::shared_ptr<Generator>          gen;
+    std::shared_ptr<Distributor>        dist;
+    std::vector<std::shared_ptr<Cash>>  lanes;
+    std::shared_ptr<SelfCheckoutBank>   selfBank;   // nullptr without cfg.selfBank
+    std::shared_ptr<PaymentProcessor>   pay;
+    std::shared_ptr<traveler>           walk;
+    std::shared_ptr<pickup_system>      pickup;
+    std::shared_ptr<CustomerSink>       sink_walkin;
+    std::shared_ptr<CustomerSink>       sink_online;
+    std::shared_ptr<ShiftSchedule>      shifts;   // nullptr without cfg.schedule
+
+    // Mean of the service times each IPA parameter scales (ipa_gradient.hpp)
+    std::array<double, IPA_PARAMS>      ipaNominal{};
+
+    grocery_store(const std::string& id, const StoreConfig& cfg = StoreConfig()) : Coupled(id) {
+        const TillProfile till = cfg.tillData.empty() ? TillProfile()
+                                                      : loadTillProfile(cfg.tillData, cfg.cashLanes, selfLaneIds(cfg));
+
         // Components
-        auto gen   = addComponent<Generator>("generator");
+        // addAccountedComponent is addComponent unless allocation accounting
+        // is on (alloc_accounting.hpp)
+        gen   = addAccountedComponent<Generator>(*this, "generator",
+                                                 cfg.arrivalMean, cfg.travelMean, cfg.travelStdDev,
+                                                 cfg.searchMean, cfg.onlineProb, cfg.cardProb,
+                                                 cfg.seed, cfg.patienceMean, cfg.antithetic, till.items);
 
-        auto dist  = addComponent<Distributor>("distributor");
+        LaneLayout layout;
+        layout.cashLanes       = cfg.cashLanes;
+        layout.selfLanes       = selfLaneIds(cfg);
+        layout.selfKiosks      = std::max(1, cfg.selfBank);
+        layout.maxQueue        = cfg.maxQueue;
+        layout.selfItemLimit   = cfg.selfItemLimit;
+        layout.cashTimePerItem = cfg.cashTimePerItem;
+        layout.selfTimePerItem = cfg.selfTimePerItem;
+        // Routing estimates lane work from the mean per-item time
+        if (till.cashPerItem) layout.cashTimePerItem = till.cashPerItem->mean();
+        if (till.selfPerItem) layout.selfTimePerItem = till.selfPerItem->mean();
+        layout.speed = till.speed;
+        const unsigned int routeSeed = cfg.seed.has_value() ? (*cfg.seed ^ 0x85EBCA6Bu) : std::random_device{}();
+        EntryQueueLimits entry;
+        entry.capacity  = cfg.entryCapacity;
+        entry.highWater = cfg.entryHighWater;
+        entry.lowWater  = cfg.entryLowWater;
+        FluidSettings fluid;
+        fluid.enter        = cfg.fluidEnter;
+        fluid.exit         = cfg.fluidExit;
+        fluid.step         = cfg.fluidStep;
+        fluid.dwell        = cfg.fluidDwell;
+        fluid.payTerminals = cfg.payTerminals;
+        fluid.cardPayMean  = till.cardPay ? till.cardPay->mean() : 0.5 * (CARD_PAY_MIN + CARD_PAY_MAX);
+        fluid.cashPayMean  = till.cashPay ? till.cashPay->mean() : 0.5 * (CASH_PAY_MIN + CASH_PAY_MAX);
+        fluid.travelTime   = TRAVEL_STEPS;
+        dist  = addAccountedComponent<Distributor>(*this, "distributor", layout,
+                                                   makeRoutingPolicy(cfg.routing, routeSeed), entry, fluid);
 
-        // 3 staffed cash lanes (laneId 0..2)
-        auto cash0 = addComponent<Cash>("cash0", 0, 1.0);
-        auto cash1 = addComponent<Cash>("cash1", 1, 1.0);
-        auto cash2 = addComponent<Cash>("cash2", 2, 1.0);
+        // Per-item draws share one keyed stream, so a customer's draw does
+        // not depend on the lane they are routed to
+        const uint64_t laneKey = cfg.seed.has_value() ? (*cfg.seed ^ 0x27D4EB2Fu) : std::random_device{}();
+        auto service = [&](int lane, std::shared_ptr<const EmpiricalDistribution> perItem) {
+            LaneService ls;
+            ls.perItem    = std::move(perItem);
+            ls.speed      = till.speed.empty() ? 1.0 : till.speed[lane];
+            ls.key        = laneKey;
+            ls.antithetic = cfg.antithetic;
+            ls.ipaParam   = lane < cfg.cashLanes ? IpaParam::CASH_ITEM : IpaParam::SELF_ITEM;
+            return ls;
+        };
 
-        // 2 self-checkout lanes (laneId 3..4)
-        auto self0 = addComponent<Cash>("self0", 3, 0.8);
-        auto self1 = addComponent<Cash>("self1", 4, 0.8);
+        // Staffed cash lanes (laneId 0..cashLanes-1)
+        for (int i = 0; i < cfg.cashLanes; ++i) {
+            lanes.push_back(addAccountedComponent<Cash>(*this, "cash" + std::to_string(i), i, cfg.cashTimePerItem,
+                                                        service(i, till.cashPerItem)));
+        }
 
-        auto pay   = addComponent<PaymentProcessor>("payment");
-        auto walk  = addComponent<traveler>("traveler");
+        // Self-checkout lanes (laneId cashLanes..), or one bank of kiosks
+        if (cfg.selfBank > 0) {
+            selfBank = addAccountedComponent<SelfCheckoutBank>(*this, "selfbank", cfg.cashLanes, cfg.selfBank,
+                                                               cfg.selfTimePerItem, service(cfg.cashLanes, till.selfPerItem));
+        } else {
+            for (int i = 0; i < cfg.selfLanes; ++i) {
+                lanes.push_back(addAccountedComponent<Cash>(*this, "self" + std::to_string(i), cfg.cashLanes + i,
+                                                            cfg.selfTimePerItem, service(cfg.cashLanes + i, till.selfPerItem)));
+            }
+        }
 
-        auto pickup = addComponent<pickup_system>("pickup");
+        // Payment gets its own stream so a fixed seed reproduces the whole run.
+        // Derived by xor so consecutive replication seeds never share a stream.
+        std::optional<unsigned int> paySeed;
+        if (cfg.seed.has_value()) paySeed = *cfg.seed ^ 0x9E3779B9u;
+        pay   = addAccountedComponent<PaymentProcessor>(*this, "payment", paySeed, cfg.antithetic, cfg.payTerminals,
+                                                        till.cardPay, till.cashPay);
+        walk  = addAccountedComponent<traveler>(*this, "traveler");
 
-        auto sink_walkin = addComponent<CustomerSink>("sink_walkin");
-        auto sink_online = addComponent<CustomerSink>("sink_online");
+        ipaNominal[static_cast<size_t>(IpaParam::CASH_ITEM)] = layout.cashTimePerItem;
+        ipaNominal[static_cast<size_t>(IpaParam::SELF_ITEM)] = layout.selfTimePerItem;
+        ipaNominal[static_cast<size_t>(IpaParam::CARD_PAY)]  = fluid.cardPayMean;
+        ipaNominal[static_cast<size_t>(IpaParam::CASH_PAY)]  = fluid.cashPayMean;
+        ipaNominal[static_cast<size_t>(IpaParam::PACK)]      = cfg.searchMean;   // pack time is the order's searchTime
+        ipaNominal[static_cast<size_t>(IpaParam::PICKUP)]    = cfg.travelMean;
+
+        pickup = addComponent<pickup_system>("pickup", cfg.packTimePerItem, cfg.packers);
+
+        sink_walkin = addAccountedComponent<CustomerSink>(*this, "sink_walkin");
+        sink_online = addAccountedComponent<CustomerSink>(*this, "sink_online");
 
         // Couplings
         // Generator <-> Distributor
@@ -44,33 +141,130 @@ struct grocery_store : public Coupled {
         addCoupling(dist->out_holdOff, gen->holdOff);
         addCoupling(dist->out_okGo,    gen->okGo);
 
-        // Distributor -> lanes
-        addCoupling(dist->out_cash0, cash0->in_customer);
-        addCoupling(dist->out_cash1, cash1->in_customer);
-        addCoupling(dist->out_cash2, cash2->in_customer);
-        addCoupling(dist->out_self0, self0->in_customer);
-        addCoupling(dist->out_self1, self1->in_customer);
-
-        // lanes -> PaymentProcessor
-        addCoupling(cash0->out_toPayment, pay->custIn);
-        addCoupling(cash1->out_toPayment, pay->custIn);
-        addCoupling(cash2->out_toPayment, pay->custIn);
-        addCoupling(self0->out_toPayment, pay->custIn);
-        addCoupling(self1->out_toPayment, pay->custIn);
-
-        // lane free signals -> Distributor
-        addCoupling(cash0->out_free, dist->in_laneFreed);
-        addCoupling(cash1->out_free, dist->in_laneFreed);
-        addCoupling(cash2->out_free, dist->in_laneFreed);
-        addCoupling(self0->out_free, dist->in_laneFreed);
-        addCoupling(self1->out_free, dist->in_laneFreed);
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            // Distributor -> lane
+            addCoupling(dist->out_lanes[i], lanes[i]->in_customer);
+
+            // lane -> PaymentProcessor
+            addCoupling(lanes[i]->out_toPayment, pay->custIn);
+
+            // lane free signal -> Distributor
+            addCoupling(lanes[i]->out_free, dist->in_laneFreed);
+        }
+
+        if (selfBank) {
+            addCoupling(dist->out_lanes[cfg.cashLanes], selfBank->in_customer);
+            addCoupling(selfBank->out_toPayment, pay->custIn);
+            addCoupling(selfBank->out_free, dist->in_laneFreed);
+        }
 
         addCoupling(pay->custOut, walk->custIn);
         addCoupling(walk->custArrived, sink_walkin->in);
 
+        // Hybrid mode only: fluid walk-ins leave from the Distributor, and go
+        // on to pay when fluid mode ends, which starts from the work left here
+        addCoupling(dist->out_walkinDone, sink_walkin->in);
+        addCoupling(dist->out_payment, pay->custIn);
+        addCoupling(dist->out_paying, pay->in_started);
+        dist->setDiscreteBacklog([p = pay.get(), w = walk.get()](double now) {
+            return DiscreteBacklog{p->backlog(now), w->walkEnd()};
+        });
+
         // Online orders: bypass checkout and go directly to pickup system
         addCoupling(dist->out_online, pickup->in_order);
         addCoupling(pickup->finished, sink_online->in);
+
+        // Staffing roster: lanes and payment terminals open and close over the day
+        if (!cfg.schedule.empty()) {
+            shifts = addAccountedComponent<ShiftSchedule>(*this, "shifts",
+                                                          loadShiftSchedule(cfg.schedule, cfg.cashLanes, selfLaneIds(cfg)));
+            addCoupling(shifts->out_lane, dist->in_shift);
+            addCoupling(shifts->out_terminals, pay->in_terminals);
+        }
+    }
+
+    // Latest simulated time seen by the models that keep a clock. Cadmium's
+    // RootCoordinator does not expose its own, and simulate(double) counts
+    // from the last event, so drivers that run in chunks use this instead.
+    double clock() const {
+        return std::max({dist->getState().clock,
+                         sink_walkin->getState().clock,
+                         sink_online->getState().clock});
+    }
+
+    // Time-weighted KPIs of every station up to `now`, accumulated inside the
+    // atomics as they run (see time_weighted.hpp); no logger needed.
+    struct Kpis {
+        Distributor::Kpis        distributor;
+        std::vector<StationKpis> lanes;       // by laneId (a bank's utilisation is per kiosk)
+        StationKpis              payment;
+        StationKpis              packing;
+        StationKpis              curbside;
+    };
+    Kpis kpis(double now) const {
+        Kpis k;
+        k.distributor = dist->kpis(now);
+        for (const auto& lane : lanes) k.lanes.push_back(lane->kpis(now));
+        if (selfBank) k.lanes.push_back(selfBank->kpis(now));
+        k.payment  = pay->kpis(now);
+        k.packing  = pickup->packer->kpis(now);
+        k.curbside = pickup->curbside->kpis(now);
+        return k;
+    }
+
+    // Record every online order reaching pickup_system into `path`, for
+    // grocery_replay to re-simulate the pickup side alone (input_replay.hpp).
+    // Call before building the RootCoordinator.
+    std::shared_ptr<InputRecorder> recordPickupInput(const std::string& path) {
+        auto recorder = addAccountedComponent<InputRecorder>(*this, "pickup_recorder", path, "pickup");
+        addCoupling(dist->out_online, recorder->in);
+        return recorder;
+    }
+
+    // d(mean sojourn)/d(parameter) for every service parameter, from one run
+    // (IPA, see ipa_gradient.hpp). `perScale` is the derivative for scaling
+    // all the parameter's service times by (1 + eps); dividing by the nominal
+    // mean gives it per second (per second per item for the lanes).
+    struct Sensitivity {
+        IpaParam param;
+        double   nominal;
+        double   walkinPerScale, onlinePerScale;
+        double   walkin() const { return nominal > 0.0 ? walkinPerScale / nominal : 0.0; }
+        double   online() const { return nominal > 0.0 ? onlinePerScale / nominal : 0.0; }
+    };
+    std::vector<Sensitivity> sensitivities() const {
+        std::vector<Sensitivity> out;
+        for (size_t k = 0; k < IPA_PARAMS; ++k) {
+            const auto p = static_cast<IpaParam>(k);
+            out.push_back({p, ipaNominal[k],
+                           sink_walkin->getState().meanSojournDerivative(p),
+                           sink_online->getState().meanSojournDerivative(p)});
+        }
+        return out;
+    }
+
+    // High-water mark of every queue inside the store, by model id
+    // (LevelIntegral::peak, sampled after each transition)
+    std::vector<std::pair<std::string, double>> queuePeaks() const {
+        std::vector<std::pair<std::string, double>> peaks;
+        peaks.emplace_back(dist->getId(), dist->getState().entryQueued.peak);
+        for (const auto& lane : lanes) peaks.emplace_back(lane->getId(), lane->getState().queued.peak);
+        if (selfBank) peaks.emplace_back(selfBank->getId(), selfBank->getState().queued.peak);
+        peaks.emplace_back(pay->getId(), pay->getState().queued.peak);
+        peaks.emplace_back(pickup->packer->getId(), pickup->packer->getState().queued.peak);
+        peaks.emplace_back(pickup->curbside->getId(), pickup->curbside->getState().queued.peak);
+        return peaks;
+    }
+
+    // Publish live queue lengths and completion counts to `metrics`
+    // (nullptr turns it off). The writer must outlive the simulation.
+    void publishMetrics(LiveMetricsWriter* metrics) {
+        dist->setMetrics(metrics);
+        for (auto& lane : lanes) lane->setMetrics(metrics);
+        if (selfBank) selfBank->setMetrics(metrics);
+        pay->setMetrics(metrics);
+        sink_walkin->setMetrics(metrics, LiveMetricsWriter::Sink::WALKIN);
+        sink_online->setMetrics(metrics, LiveMetricsWriter::Sink::ONLINE);
     }
 };
 
@@ -10,9 +10,14 @@ using namespace cadmium;
 #include "traveler.hpp"
 #include "pickup_system.hpp"
 
+#include <optional>
+#include <vector>
+
 // A test-friendly top model:
 // - NO generator
 // - takes CustomerData from an input file
+// - payment times are random unless `paySeed` is given (perf runs fix it so
+//   every run does the same work)
 struct grocery_store_test : public Coupled {
 
     // external ports (so tests can hook file input + sinks)
@@ -20,7 +25,7 @@ struct grocery_store_test : public Coupled {
     Port<CustomerData> out_walkin_done;
     Port<CustomerData> out_online_done;
 
-    grocery_store_test(const std::string& id) : Coupled(id) {
+    grocery_store_test(const std::string& id, std::optional<unsigned int> paySeed = std::nullopt) : Coupled(id) {
 
         in_customer      = addInPort<CustomerData>("in_customer");
         out_walkin_done  = addOutPort<CustomerData>("out_walkin_done");
@@ -29,14 +34,15 @@ struct grocery_store_test : public Coupled {
         // Components
         auto dist  = addComponent<Distributor>("distributor");
 
-        auto cash0 = addComponent<Cash>("cash0", 0, 1.0);
-        auto cash1 = addComponent<Cash>("cash1", 1, 1.0);
-        auto cash2 = addComponent<Cash>("cash2", 2, 1.0);
-
-        auto self0 = addComponent<Cash>("self0", 3, 0.8);
-        auto self1 = addComponent<Cash>("self1", 4, 0.8);
+        std::vector<std::shared_ptr<Cash>> lanes = {
+            addComponent<Cash>("cash0", 0, 1.0),
+            addComponent<Cash>("cash1", 1, 1.0),
+            addComponent<Cash>("cash2", 2, 1.0),
+            addComponent<Cash>("self0", 3, 0.8),
+            addComponent<Cash>("self1", 4, 0.8),
+        };
 
-        auto pay   = addComponent<PaymentProcessor>("payment");
+        auto pay   = addComponent<PaymentProcessor>("payment", paySeed);
         auto walk  = addComponent<traveler>("traveler");
 
         auto pickup = addComponent<pickup_system>("pickup");
@@ -44,26 +50,16 @@ struct grocery_store_test : public Coupled {
         // Couplings
         addCoupling(in_customer, dist->in_customer);
 
-        // Distributor -> lanes
-        addCoupling(dist->out_cash0, cash0->in_customer);
-        addCoupling(dist->out_cash1, cash1->in_customer);
-        addCoupling(dist->out_cash2, cash2->in_customer);
-        addCoupling(dist->out_self0, self0->in_customer);
-        addCoupling(dist->out_self1, self1->in_customer);
-
-        // lanes -> payment
-        addCoupling(cash0->out_toPayment, pay->custIn);
-        addCoupling(cash1->out_toPayment, pay->custIn);
-        addCoupling(cash2->out_toPayment, pay->custIn);
-        addCoupling(self0->out_toPayment, pay->custIn);
-        addCoupling(self1->out_toPayment, pay->custIn);
-
-        // lane free -> distributor
-        addCoupling(cash0->out_free, dist->in_laneFreed);
-        addCoupling(cash1->out_free, dist->in_laneFreed);
-        addCoupling(cash2->out_free, dist->in_laneFreed);
-        addCoupling(self0->out_free, dist->in_laneFreed);
-        addCoupling(self1->out_free, dist->in_laneFreed);
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            // Distributor -> lanes
+            addCoupling(dist->out_lanes[i], lanes[i]->in_customer);
+
+            // lanes -> payment
+            addCoupling(lanes[i]->out_toPayment, pay->custIn);
+
+            // lane free -> distributor
+            addCoupling(lanes[i]->out_free, dist->in_laneFreed);
+        }
 
         // payment -> traveler 
         addCoupling(pay->custOut, walk->custIn);
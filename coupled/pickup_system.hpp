@@ -5,6 +5,7 @@
 
 #include "packer.hpp"
 #include "curbside_dispatcher.hpp"
+#include "alloc_accounting.hpp"
 
 using namespace cadmium;
 
@@ -14,21 +15,25 @@ struct pickup_system : public Coupled {
     Port<CustomerData> in_order;
     Port<CustomerData> finished;
 
-    pickup_system(const std::string& id) : Coupled(id) {
+    // Components, kept so snapshots can read and restore their states
+    std::shared_ptr<Packer>             packer;
+    std::shared_ptr<CurbsideDispatcher> curbside;
+
+    pickup_system(const std::string& id, double packTimePerItem = 1.0, int packers = 1) : Coupled(id) {
         in_order = addInPort<CustomerData>("in_order");
         finished = addOutPort<CustomerData>("finished");
 
-        auto pack = addComponent<Packer>("packer", 1.0);
-        auto curb = addComponent<CurbsideDispatcher>("curbside");
+        packer   = addAccountedComponent<Packer>(*this, "packer", packTimePerItem, packers);
+        curbside = addAccountedComponent<CurbsideDispatcher>(*this, "curbside");
 
         // External input -> Packer
-        addCoupling(in_order, pack->in_order);
+        addCoupling(in_order, packer->in_order);
 
         // Packer output -> Curbside input
-        addCoupling(pack->out_packed, curb->orderIn);
+        addCoupling(packer->out_packed, curbside->orderIn);
 
         // Curbside output -> External output
-        addCoupling(curb->finished, finished);
+        addCoupling(curbside->finished, finished);
     }
 };
 
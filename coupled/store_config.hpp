@@ -0,0 +1,187 @@
+#ifndef STORE_CONFIG_HPP
+#define STORE_CONFIG_HPP
+
+#include <optional>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include "distributor.hpp"
+
+// Parameters for building a grocery_store. Defaults keep the original
+// hard-wired layout, rates and lane limits; behaviour added since (Cash lane
+// queues, the Distributor's entry queue) is on in every configuration.
+struct StoreConfig {
+    // Layout and routing
+    int    cashLanes       = CASH_LANES;
+    int    selfLanes       = SELF_LANES;
+    int    selfBank        = 0;                // > 0: one shared line to this many kiosks instead of selfLanes
+    int    maxQueue        = MAX_QUEUE;        // customers per lane (in service + waiting)
+    int    selfItemLimit   = SELF_ITEM_LIMIT;  // basket size that prefers self-checkout
+    std::string routing    = "shortest";       // lane policy: shortest, lwl, pod<d> (routing_policy.hpp)
+
+    // Store entry queue (walk-ins waiting for a lane)
+    int    entryCapacity   = ENTRY_CAPACITY;
+    int    entryHighWater  = ENTRY_HIGH_WATER; // hold the Generator at this many waiting
+    int    entryLowWater   = ENTRY_LOW_WATER;  // resume it at this many
+
+    // Service speeds
+    double cashTimePerItem = 1.0;              // staffed lanes
+    double selfTimePerItem = 0.8;              // self-checkout lanes
+    double packTimePerItem = 1.0;
+    int    packers         = 1;
+    int    payTerminals    = 1;                // payments taken in parallel
+    std::string schedule;                      // shift schedule file (shift_schedule.hpp); empty = fixed staff
+    std::string tillData;                      // service-time histograms (till_profile.hpp); empty = parametric
+
+    // Generator (same meaning and defaults as its constructor)
+    double arrivalMean     = 60.0;
+    double travelMean      = 300.0;
+    double travelStdDev    = 60.0;
+    double searchMean      = 120.0;
+    double onlineProb      = 0.30;
+    double cardProb        = 0.70;
+    double patienceMean    = 0.0;              // mean patience per queue (seconds); 0 = nobody reneges
+
+    // Hybrid mode: fluid walk-in path while the lanes are saturated (fluid_walkin.hpp)
+    double fluidEnter      = 0.0;              // lane utilisation that starts it; 0 = off
+    double fluidExit       = 0.8;              // offered lane load that ends it
+    double fluidStep       = 60.0;             // switching window (seconds)
+    double fluidDwell      = 1800.0;           // minimum time in either mode before switching (seconds)
+
+    std::optional<unsigned int> seed;          // unset = random_device
+    bool   antithetic      = false;            // antithetic copy of the seed's replication
+};
+
+// Set one field from a "key=value" override, e.g. on a what-if command line.
+// Returns false for an unknown key; throws std::invalid_argument on a bad value.
+inline bool applyOverride(StoreConfig& cfg, const std::string& key, const std::string& value) {
+    if (key == "cashLanes")            cfg.cashLanes       = std::stoi(value);
+    else if (key == "selfLanes")       cfg.selfLanes       = std::stoi(value);
+    else if (key == "selfBank")        cfg.selfBank        = std::stoi(value);
+    else if (key == "maxQueue")        cfg.maxQueue        = std::stoi(value);
+    else if (key == "selfItemLimit")   cfg.selfItemLimit   = std::stoi(value);
+    else if (key == "routing")       { makeRoutingPolicy(value);  cfg.routing = value; } // throws on unknown names
+    else if (key == "entryCapacity")   cfg.entryCapacity   = std::stoi(value);
+    else if (key == "entryHighWater")  cfg.entryHighWater  = std::stoi(value);
+    else if (key == "entryLowWater")   cfg.entryLowWater   = std::stoi(value);
+    else if (key == "cashTimePerItem") cfg.cashTimePerItem = std::stod(value);
+    else if (key == "selfTimePerItem") cfg.selfTimePerItem = std::stod(value);
+    else if (key == "packTimePerItem") cfg.packTimePerItem = std::stod(value);
+    else if (key == "packers")         cfg.packers         = std::stoi(value);
+    else if (key == "payTerminals")    cfg.payTerminals    = std::stoi(value);
+    else if (key == "schedule")        cfg.schedule        = value;
+    else if (key == "tillData")        cfg.tillData        = value;
+    else if (key == "arrivalMean")     cfg.arrivalMean     = std::stod(value);
+    else if (key == "travelMean")      cfg.travelMean      = std::stod(value);
+    else if (key == "travelStdDev")    cfg.travelStdDev    = std::stod(value);
+    else if (key == "searchMean")      cfg.searchMean      = std::stod(value);
+    else if (key == "onlineProb")      cfg.onlineProb      = std::stod(value);
+    else if (key == "cardProb")        cfg.cardProb        = std::stod(value);
+    else if (key == "patienceMean")    cfg.patienceMean    = std::stod(value);
+    else if (key == "fluidEnter")      cfg.fluidEnter      = std::stod(value);
+    else if (key == "fluidExit")       cfg.fluidExit       = std::stod(value);
+    else if (key == "fluidStep")       cfg.fluidStep       = std::stod(value);
+    else if (key == "fluidDwell")      cfg.fluidDwell      = std::stod(value);
+    else if (key == "seed")            cfg.seed            = static_cast<unsigned int>(std::stoul(value));
+    else if (key == "antithetic")      cfg.antithetic      = std::stoi(value) != 0;
+    else return false;
+    return true;
+}
+
+// Current value of a numeric parameter (e.g. for a cost model over a design).
+// Throws std::invalid_argument for unknown or non-numeric keys.
+inline double numericParam(const StoreConfig& cfg, const std::string& key) {
+    if (key == "cashLanes")       return cfg.cashLanes;
+    if (key == "selfLanes")       return cfg.selfLanes;
+    if (key == "selfBank")        return cfg.selfBank;
+    if (key == "maxQueue")        return cfg.maxQueue;
+    if (key == "selfItemLimit")   return cfg.selfItemLimit;
+    if (key == "entryCapacity")   return cfg.entryCapacity;
+    if (key == "entryHighWater")  return cfg.entryHighWater;
+    if (key == "entryLowWater")   return cfg.entryLowWater;
+    if (key == "cashTimePerItem") return cfg.cashTimePerItem;
+    if (key == "selfTimePerItem") return cfg.selfTimePerItem;
+    if (key == "packTimePerItem") return cfg.packTimePerItem;
+    if (key == "packers")         return cfg.packers;
+    if (key == "payTerminals")    return cfg.payTerminals;
+    if (key == "arrivalMean")     return cfg.arrivalMean;
+    if (key == "travelMean")      return cfg.travelMean;
+    if (key == "travelStdDev")    return cfg.travelStdDev;
+    if (key == "searchMean")      return cfg.searchMean;
+    if (key == "onlineProb")      return cfg.onlineProb;
+    if (key == "cardProb")        return cfg.cardProb;
+    if (key == "patienceMean")    return cfg.patienceMean;
+    if (key == "fluidEnter")      return cfg.fluidEnter;
+    if (key == "fluidExit")       return cfg.fluidExit;
+    if (key == "fluidStep")       return cfg.fluidStep;
+    if (key == "fluidDwell")      return cfg.fluidDwell;
+    throw std::invalid_argument("not a numeric store parameter: " + key);
+}
+
+// Keys whose values must be whole numbers (sweeps round sampled values for these).
+inline bool isIntegerParam(const std::string& key) {
+    return key == "cashLanes" || key == "selfLanes" || key == "selfBank" || key == "maxQueue"
+        || key == "selfItemLimit" || key == "entryCapacity" || key == "entryHighWater"
+        || key == "entryLowWater" || key == "packers" || key == "payTerminals"
+        || key == "seed" || key == "antithetic";
+}
+
+// Self-checkout laneIds in the store: the bank counts as one lane ("self0")
+inline int selfLaneIds(const StoreConfig& cfg) { return cfg.selfBank > 0 ? 1 : cfg.selfLanes; }
+
+// Apply a comma separated list of overrides ("maxQueue=3,packers=2").
+inline void applyOverrides(StoreConfig& cfg, const std::string& list) {
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        const std::string item = list.substr(start, end - start);
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos || !applyOverride(cfg, item.substr(0, eq), item.substr(eq + 1))) {
+            throw std::invalid_argument("bad store override: " + item);
+        }
+        start = end + 1;
+    }
+}
+
+// Every parameter except the seed, in a fixed order ("cashLanes=3,selfLanes=2,...").
+// Round-trips through applyOverrides and is used as the result cache key;
+// antithetic, payTerminals, selfBank, schedule, tillData and the fluid
+// settings are only listed when they differ from the default, so existing
+// cache keys stay valid. Files are listed by path; ResultCache::key adds a
+// hash of the schedule's and till data's contents.
+inline std::string describe(const StoreConfig& cfg) {
+    std::ostringstream os;
+    os.precision(17);
+    os << "cashLanes="        << cfg.cashLanes
+       << ",selfLanes="       << cfg.selfLanes
+       << ",maxQueue="        << cfg.maxQueue
+       << ",selfItemLimit="   << cfg.selfItemLimit
+       << ",routing="         << cfg.routing
+       << ",entryCapacity="   << cfg.entryCapacity
+       << ",entryHighWater="  << cfg.entryHighWater
+       << ",entryLowWater="   << cfg.entryLowWater
+       << ",cashTimePerItem=" << cfg.cashTimePerItem
+       << ",selfTimePerItem=" << cfg.selfTimePerItem
+       << ",packTimePerItem=" << cfg.packTimePerItem
+       << ",packers="         << cfg.packers
+       << ",arrivalMean="     << cfg.arrivalMean
+       << ",travelMean="      << cfg.travelMean
+       << ",travelStdDev="    << cfg.travelStdDev
+       << ",searchMean="      << cfg.searchMean
+       << ",onlineProb="      << cfg.onlineProb
+       << ",cardProb="        << cfg.cardProb
+       << ",patienceMean="    << cfg.patienceMean;
+    if (cfg.payTerminals != 1) os << ",payTerminals=" << cfg.payTerminals;
+    if (cfg.selfBank > 0) os << ",selfBank=" << cfg.selfBank;
+    if (!cfg.schedule.empty()) os << ",schedule=" << cfg.schedule;
+    if (!cfg.tillData.empty()) os << ",tillData=" << cfg.tillData;
+    if (cfg.antithetic) os << ",antithetic=1";
+    if (cfg.fluidEnter > 0.0) {
+        os << ",fluidEnter=" << cfg.fluidEnter << ",fluidExit=" << cfg.fluidExit << ",fluidStep=" << cfg.fluidStep
+           << ",fluidDwell=" << cfg.fluidDwell;
+    }
+    return os.str();
+}
+
+#endif // STORE_CONFIG_HPP
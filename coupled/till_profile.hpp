@@ -0,0 +1,124 @@
+#ifndef TILL_PROFILE_HPP
+#define TILL_PROFILE_HPP
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "empirical_distribution.hpp"
+#include "routing_policy.hpp"
+
+// ---- Till data: empirical service-time histograms ----
+// A till profile replaces the store's parametric service times with
+// histograms exported from the point of sale. It is a text file of sections;
+// every section is optional and a missing one keeps the parametric default:
+//
+//   [items]          # basket size: <items> <weight>
+//   1  140
+//   2  118
+//   [cash_lane]      # staffed lanes, seconds per item: <lo> <hi> <weight>
+//   0.6 0.8  12
+//   [self_lane]      # self-checkout lanes, seconds per item
+//   [card_payment]   # tap/card payment seconds: <lo> <hi> <weight>
+//   [cash_payment]   # cash payment seconds
+//   [speed]          # per cashier: <lane> <relative speed>
+//   cash0  1.15      # 15% faster than the histogram
+//
+// Rows with two numbers in a histogram section are point masses (<value>
+// <weight>); [items] only takes those. `#` starts a comment.
+
+struct TillProfile {
+    std::shared_ptr<const EmpiricalDistribution> items;        // basket sizes (Generator)
+    std::shared_ptr<const EmpiricalDistribution> cashPerItem;  // staffed lanes (Cash)
+    std::shared_ptr<const EmpiricalDistribution> selfPerItem;  // self-checkout lanes (Cash)
+    std::shared_ptr<const EmpiricalDistribution> cardPay;      // PaymentProcessor
+    std::shared_ptr<const EmpiricalDistribution> cashPay;
+    std::vector<double> speed;                                 // per laneId; empty = all 1
+};
+
+// Reads a till profile for a store with the given lane counts. Throws
+// std::invalid_argument naming the line for anything it cannot use.
+inline TillProfile loadTillProfile(const std::string& path, int cashLanes, int selfLanes) {
+    std::ifstream in(path);
+    if (!in) throw std::invalid_argument("cannot open till profile " + path);
+
+    TillProfile profile;
+    std::vector<HistogramBin> bins[5];
+    const char* names[5] = {"items", "cash_lane", "self_lane", "card_payment", "cash_payment"};
+    int section = -1;      // index into bins, 5 = [speed]
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        const std::string where = path + ":" + std::to_string(lineNo);
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        std::string first;
+        if (!(ss >> first)) continue;
+
+        if (first.front() == '[') {
+            section = -1;
+            for (int k = 0; k < 5; ++k) {
+                if (first == "[" + std::string(names[k]) + "]") section = k;
+            }
+            if (first == "[speed]") section = 5;
+            if (section < 0) throw std::invalid_argument(where + ": unknown section " + first);
+            continue;
+        }
+        if (section < 0) throw std::invalid_argument(where + ": data before the first [section]");
+
+        if (section == 5) {
+            const int lane = laneIdFromName(first, cashLanes, selfLanes);
+            double speed = 0.0;
+            if (lane < 0) throw std::invalid_argument(where + ": no lane " + first);
+            if (!(ss >> speed) || speed <= 0.0) throw std::invalid_argument(where + ": expected '<lane> <speed>'");
+            if (profile.speed.empty()) profile.speed.assign(cashLanes + selfLanes, 1.0);
+            profile.speed[lane] = speed;
+            continue;
+        }
+
+        std::vector<double> row;
+        try {
+            row.push_back(std::stod(first));
+        } catch (const std::exception&) {
+            throw std::invalid_argument(where + ": expected numbers");
+        }
+        for (double x; ss >> x;) row.push_back(x);
+        if (!ss.eof()) throw std::invalid_argument(where + ": expected numbers");
+
+        HistogramBin b;
+        if (row.size() == 2) {
+            b.lo = b.hi = row[0];
+            b.weight = row[1];
+        } else if (row.size() == 3 && section != 0) {
+            b.lo = row[0];
+            b.hi = row[1];
+            b.weight = row[2];
+        } else {
+            throw std::invalid_argument(where + (section == 0 ? ": expected '<items> <weight>'"
+                                                               : ": expected '<lo> <hi> <weight>'"));
+        }
+        if (b.weight < 0.0 || b.hi < b.lo || b.lo < 0.0 || (section == 0 && b.lo != static_cast<int>(b.lo))) {
+            throw std::invalid_argument(where + ": bad bin");
+        }
+        bins[section].push_back(b);
+    }
+
+    auto build = [&](int k) -> std::shared_ptr<const EmpiricalDistribution> {
+        if (bins[k].empty()) return nullptr;
+        try {
+            return std::make_shared<const EmpiricalDistribution>(bins[k]);
+        } catch (const std::invalid_argument& ex) {
+            throw std::invalid_argument(path + ": [" + names[k] + "] " + ex.what());
+        }
+    };
+    profile.items       = build(0);
+    profile.cashPerItem = build(1);
+    profile.selfPerItem = build(2);
+    profile.cardPay     = build(3);
+    profile.cashPay     = build(4);
+    return profile;
+}
+
+#endif // TILL_PROFILE_HPP
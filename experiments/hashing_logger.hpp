@@ -0,0 +1,174 @@
+#ifndef HASHING_LOGGER_HPP
+#define HASHING_LOGGER_HPP
+
+#include <cadmium/simulation/logger/logger.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---- Event-stream hashing ----
+// Two runs that should be identical (before and after an optimisation) are
+// compared by hashing their event streams instead of diffing text logs.
+// HashingLogger folds every (time, model, port, message) it is given into a
+// rolling 128-bit hash, and writes the hash of everything before each
+// multiple of `every` simulated seconds as a checkpoint. Since each checkpoint
+// covers the whole prefix, the first mismatching checkpoint (found by
+// bisection, see tools/hash_compare.cpp) bounds where the runs diverge.
+//
+// States are hashed as logged with an empty port name. Model ids are left out
+// so that renumbering models does not count as a change. Times are hashed by
+// their bits, so any floating-point difference shows up.
+
+// Rolling 128-bit hash; fast, not cryptographic.
+class EventHash {
+public:
+    void word(uint64_t w) {
+        lo_ = fold(lo_ ^ w, 0xA0761D6478BD642Full) + hi_;
+        hi_ = rotl(hi_ ^ w, 29) * 0xE7037ED1A0B428DBull + lo_;
+    }
+
+    void bytes(const std::string& s) {
+        size_t i = 0;
+        for (; i + 8 <= s.size(); i += 8) {
+            uint64_t w;
+            std::memcpy(&w, s.data() + i, 8);
+            word(w);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, s.data() + i, s.size() - i);
+        word(tail);
+        word(s.size());   // the length also separates consecutive strings
+    }
+
+    void event(double time, const std::string& model, const std::string& port, const std::string& msg) {
+        uint64_t t;
+        std::memcpy(&t, &time, sizeof(t));
+        word(t);
+        bytes(model);
+        bytes(port);
+        bytes(msg);
+    }
+
+    std::string hex() const {
+        char buf[33];
+        std::snprintf(buf, sizeof(buf), "%016llx%016llx",
+                      static_cast<unsigned long long>(hi_), static_cast<unsigned long long>(lo_));
+        return buf;
+    }
+
+private:
+    uint64_t lo_ = 0x9E3779B97F4A7C15ull;
+    uint64_t hi_ = 0xC2B2AE3D27D4EB4Full;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t fold(uint64_t a, uint64_t b) {
+        const __uint128_t r = static_cast<__uint128_t>(a) * b;
+        return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+    }
+};
+
+// One checkpoint line: hash of the `events` logged before `time`.
+// The last line of a file (`final`) covers the whole run.
+struct HashCheckpoint {
+    double      time = 0.0;
+    long        events = 0;
+    std::string hash;
+    bool        final = false;
+};
+
+// Checkpoint file: a "# hash every <seconds>" header, then "<time> <events> <hash>"
+// lines and a closing "final <time> <events> <hash>".
+inline std::vector<HashCheckpoint> readHashCheckpoints(const std::string& path, double* every = nullptr) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::vector<HashCheckpoint> all;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        if (line[0] == '#') {
+            std::string mark, tag, key;
+            if (fields >> mark >> tag >> key && key == "every" && every) fields >> *every;
+            continue;
+        }
+        HashCheckpoint c;
+        if (line.compare(0, 5, "final") == 0) {
+            std::string tag;
+            fields >> tag;
+            c.final = true;
+        }
+        if (!(fields >> c.time >> c.events >> c.hash)) {
+            throw std::runtime_error("bad checkpoint line in " + path + ": " + line);
+        }
+        all.push_back(c);
+    }
+    return all;
+}
+
+class HashingLogger : public cadmium::Logger {
+public:
+    // Checkpoints every `every` simulated seconds go to `path`. Events with
+    // from <= time < until are also written as text to `path`.events, so the
+    // interval a comparison points at can be diffed line by line.
+    HashingLogger(const std::string& path, double every,
+                  double from  = std::numeric_limits<double>::infinity(),
+                  double until = std::numeric_limits<double>::infinity())
+        : out_(path), every_(every > 0.0 ? every : 3600.0), next_(every_), from_(from), until_(until) {
+        if (!out_) throw std::runtime_error("cannot write " + path);
+        out_.precision(17);
+        out_ << "# hash every " << every_ << "\n";
+        if (from_ < until_) {
+            window_.open(path + ".events");
+            window_.precision(17);
+        }
+    }
+
+    void start() override {}
+
+    void stop() override {
+        out_ << "final " << last_ << " " << events_ << " " << hash_.hex() << "\n";
+        out_.flush();
+    }
+
+    void logOutput(double time, long, const std::string& modelName, const std::string& portName,
+                   const std::string& output) override {
+        add(time, modelName, portName, output);
+    }
+
+    void logState(double time, long, const std::string& modelName, const std::string& state) override {
+        add(time, modelName, EMPTY_PORT, state);
+    }
+
+private:
+    inline static const std::string EMPTY_PORT;
+
+    std::ofstream out_;
+    std::ofstream window_;
+    EventHash hash_;
+    long   events_ = 0;
+    double last_   = 0.0;
+    double every_;
+    double next_;
+    double from_, until_;
+
+    void add(double time, const std::string& model, const std::string& port, const std::string& msg) {
+        while (time >= next_) {
+            out_ << next_ << " " << events_ << " " << hash_.hex() << "\n";
+            next_ += every_;
+        }
+        hash_.event(time, model, port, msg);
+        ++events_;
+        last_ = time;
+        if (window_.is_open() && time >= from_ && time < until_) {
+            window_ << time << "," << model << "," << port << "," << msg << "\n";
+        }
+    }
+};
+
+#endif // HASHING_LOGGER_HPP
@@ -0,0 +1,52 @@
+#ifndef MEMORY_REPORT_HPP
+#define MEMORY_REPORT_HPP
+
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "alloc_accounting.hpp"
+
+// ---- Per-model memory report ----
+// One row per accounted model (alloc_accounting.hpp) plus "(simulator)" for
+// everything outside a model call: events (outputs, transitions and time
+// advances), heap allocations and allocations per event, bytes allocated,
+// peak and final live bytes, and the queue high-water mark where the model
+// has a queue. `queuePeaks` pairs model ids with their peak, e.g. from
+// grocery_store::queuePeaks(); models without one show "-".
+
+inline void printMemoryReport(std::ostream& os, const std::vector<std::pair<std::string, double>>& queuePeaks) {
+    const auto rows = AllocAccounting::rows();
+    os << "Memory by model:\n"
+       << std::left << std::setw(20) << "  model"
+       << std::right << std::setw(11) << "events" << std::setw(11) << "allocs" << std::setw(10) << "per evt"
+       << std::setw(13) << "bytes" << std::setw(12) << "peak live" << std::setw(12) << "live end"
+       << std::setw(11) << "queue max" << "\n";
+
+    long events = 0, allocs = 0, bytes = 0, live = 0;
+    for (const auto& r : rows) {
+        os << "  " << std::left << std::setw(18) << r.name << std::right
+           << std::setw(11) << r.events << std::setw(11) << r.allocs << std::setw(10) << std::fixed
+           << std::setprecision(2) << (r.events > 0 ? static_cast<double>(r.allocs) / r.events : 0.0)
+           << std::setw(13) << r.bytes << std::setw(12) << r.peak << std::setw(12) << r.live;
+
+        std::string peak = "-";
+        for (const auto& q : queuePeaks) {
+            if (q.first == r.name) peak = std::to_string(static_cast<long>(q.second));
+        }
+        os << std::setw(11) << peak << "\n";
+
+        events += r.events;
+        allocs += r.allocs;
+        bytes  += r.bytes;
+        live   += r.live;
+    }
+    os << "  " << std::left << std::setw(18) << "total" << std::right
+       << std::setw(11) << events << std::setw(11) << allocs << std::setw(10)
+       << (events > 0 ? static_cast<double>(allocs) / events : 0.0)
+       << std::setw(13) << bytes << std::setw(12) << "" << std::setw(12) << live << "\n";
+}
+
+#endif // MEMORY_REPORT_HPP
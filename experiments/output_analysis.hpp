@@ -0,0 +1,130 @@
+#ifndef OUTPUT_ANALYSIS_HPP
+#define OUTPUT_ANALYSIS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "student_t.hpp"
+
+// ---- Steady-state output analysis for one KPI stream ----
+// Observations (e.g. each walk-in customer's sojourn time, streamed from a
+// CustomerSink observer) are folded into groups of 5 as they arrive, so
+// memory is one double pair per five customers.
+//
+// - Warm-up: MSER-5 picks the truncation point d (in groups) minimising
+//   the marginal standard error of the remaining group means. If the best d
+//   falls in the second half of the data the run is not yet warmed up.
+// - Precision: the retained groups are split into a fixed number of batches;
+//   the batch-means confidence interval on the mean is reported, and the run
+//   has converged when its half-width / |mean| is at or below the target.
+
+struct BatchMeansEstimate {
+    double mean      = 0.0;
+    double halfWidth = std::numeric_limits<double>::infinity();
+    size_t used      = 0;       // observations after warm-up truncation
+    size_t truncated = 0;       // observations dropped as warm-up
+    double warmupEnd = 0.0;     // time of the last dropped observation
+    bool   warmedUp  = false;
+
+    double relativeHalfWidth() const {
+        return (mean != 0.0) ? halfWidth / std::fabs(mean) : std::numeric_limits<double>::infinity();
+    }
+};
+
+class OutputAnalyzer {
+public:
+    static constexpr size_t GROUP = 5;            // MSER-5
+
+    explicit OutputAnalyzer(size_t batches = 20, double confidence = 0.95)
+        : batches_(batches), t_(studentTwoSided(confidence, static_cast<long>(batches) - 1)) {}
+
+    void observe(double time, double value) {
+        pendingSum_ += value;
+        if (++pendingCount_ == GROUP) {
+            groupMeans_.push_back(pendingSum_ / GROUP);
+            groupEnds_.push_back(time);
+            pendingSum_ = 0.0;
+            pendingCount_ = 0;
+        }
+        ++count_;
+    }
+
+    size_t count() const { return count_; }
+
+    // MSER-5 truncation point in groups, searched over the first half.
+    // Uses suffix sums, so each call is O(groups).
+    size_t mserTruncation() const {
+        const size_t k = groupMeans_.size();
+        if (k < 2) return 0;
+
+        double s1 = 0.0, s2 = 0.0;
+        std::vector<double> mser(k, std::numeric_limits<double>::infinity());
+        for (size_t j = k; j-- > 0;) {
+            s1 += groupMeans_[j];
+            s2 += groupMeans_[j] * groupMeans_[j];
+            const double n = static_cast<double>(k - j);
+            mser[j] = (s2 - s1 * s1 / n) / (n * n);
+        }
+
+        size_t best = 0;
+        for (size_t d = 1; d <= k / 2; ++d) {
+            if (mser[d] < mser[best]) best = d;
+        }
+        return best;
+    }
+
+    BatchMeansEstimate estimate() const {
+        BatchMeansEstimate est;
+        const size_t k = groupMeans_.size();
+        const size_t d = mserTruncation();
+
+        est.truncated = d * GROUP;
+        est.warmupEnd = (d > 0) ? groupEnds_[d - 1] : 0.0;
+        est.warmedUp  = (k >= 2) && (d < k / 2);
+
+        // Whole groups per batch; leftover groups at the front are dropped too
+        const size_t perBatch = (k - d) / batches_;
+        if (perBatch == 0) return est;
+        const size_t start = k - perBatch * batches_;
+
+        std::vector<double> batchMeans(batches_, 0.0);
+        double grand = 0.0;
+        for (size_t b = 0; b < batches_; ++b) {
+            for (size_t j = 0; j < perBatch; ++j) {
+                batchMeans[b] += groupMeans_[start + b * perBatch + j];
+            }
+            batchMeans[b] /= static_cast<double>(perBatch);
+            grand += batchMeans[b];
+        }
+        grand /= static_cast<double>(batches_);
+
+        double var = 0.0;
+        for (double m : batchMeans) var += (m - grand) * (m - grand);
+        var /= static_cast<double>(batches_ - 1);
+
+        est.mean      = grand;
+        est.used      = perBatch * batches_ * GROUP;
+        est.halfWidth = t_ * std::sqrt(var / static_cast<double>(batches_));
+        return est;
+    }
+
+    // Warmed up and the CI is tight enough (e.g. target 0.05 = +/-5% of the mean).
+    bool converged(double targetRelativeHalfWidth) const {
+        const BatchMeansEstimate est = estimate();
+        return est.warmedUp && est.relativeHalfWidth() <= targetRelativeHalfWidth;
+    }
+
+private:
+    size_t batches_;
+    double t_;        // Student t multiplier, batches_ - 1 degrees of freedom
+
+    std::vector<double> groupMeans_;
+    std::vector<double> groupEnds_;
+    double pendingSum_   = 0.0;
+    size_t pendingCount_ = 0;
+    size_t count_        = 0;
+};
+
+#endif // OUTPUT_ANALYSIS_HPP
@@ -0,0 +1,371 @@
+#ifndef PROCESS_FARM_HPP
+#define PROCESS_FARM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ---- Replications in worker processes ----
+// processFor() is parallelFor() (worker_pool.hpp) with each worker in its own
+// forked process, so a replication that crashes, aborts or hangs takes down
+// one worker rather than the whole sweep. Everything lives on this machine:
+// the coordinator and its workers share one anonymous MAP_SHARED mapping,
+// created before the fork, that holds
+//
+//   - a task deque per worker: a [head, tail) range of task ids packed in one
+//     64-bit word. The owner takes tasks from the head; an idle worker steals
+//     the back half of the fullest deque. Both are a single CAS, so work
+//     balances itself without locks or a central queue;
+//   - a result ring per worker (single producer, single consumer): the worker
+//     appends (task, result or error message), the coordinator drains it
+//     while the workers run. A worker dying mid-write never publishes a
+//     half-written entry, and its replacement continues the same ring;
+//   - per worker, the task in progress and when it started.
+//
+// The coordinator reaps workers with waitpid(). A worker killed by a signal
+// or exiting non-zero is replaced at once, and the replacement first retries
+// the task that was in progress. A task that fails `maxAttempts` times is
+// reported as an error instead of retried forever, and with `taskTimeout`
+// a worker stuck on one task is killed and handled the same way.
+//
+// Jobs run in the forked child, so they see a copy of the caller's memory at
+// the time of the call and must return their output as `Result`, which has
+// to be trivially copyable (e.g. RunResult). Call it before starting other
+// threads: only the calling thread exists in the children.
+
+struct FarmOptions {
+    size_t workers     = 1;
+    int    maxAttempts = 3;      // crashes of the same task before giving up on it
+    double taskTimeout = 0.0;    // seconds per task before its worker is killed; 0 = none
+};
+
+struct FarmReport {
+    std::vector<std::string> errors;   // per task; empty = succeeded
+    size_t restarts = 0;               // workers replaced after a crash or timeout
+    size_t steals   = 0;               // ranges taken from another worker's deque
+    size_t failed() const {
+        return static_cast<size_t>(std::count_if(errors.begin(), errors.end(),
+                                                 [](const std::string& e) { return !e.empty(); }));
+    }
+};
+
+namespace farm_detail {
+
+constexpr size_t RING_SLOTS = 64;
+constexpr size_t ERROR_LEN  = 200;
+
+inline uint64_t pack(uint32_t head, uint32_t tail) { return (static_cast<uint64_t>(head) << 32) | tail; }
+inline uint32_t headOf(uint64_t w) { return static_cast<uint32_t>(w >> 32); }
+inline uint32_t tailOf(uint64_t w) { return static_cast<uint32_t>(w); }
+
+inline double monotonicSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+inline void sleepMicros(long micros) {
+    timespec ts{0, micros * 1000};
+    nanosleep(&ts, nullptr);
+}
+
+static_assert(std::atomic<double>::is_always_lock_free, "the farm needs lock-free doubles in shared memory");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the farm needs lock-free 64-bit words in shared memory");
+
+template <typename Result>
+struct Entry {
+    uint32_t task = 0;
+    bool     ok   = false;
+    char     error[ERROR_LEN] = {};
+    Result   value{};
+};
+
+// One worker's share of the mapping; aligned so workers do not share lines.
+template <typename Result>
+struct alignas(64) Slot {
+    std::atomic<uint64_t> deque;                 // pack(head, tail)
+    std::atomic<int64_t>  current;               // task in progress, -1 = none
+    std::atomic<double>   started;               // monotonicSeconds() when it began
+    std::atomic<int64_t>  retry;                 // task the next process in this slot runs first
+    std::atomic<uint64_t> steals;
+    alignas(64) std::atomic<uint64_t> ringHead;  // next entry the coordinator reads
+    alignas(64) std::atomic<uint64_t> ringTail;  // next entry the worker writes
+    Entry<Result> ring[RING_SLOTS];
+};
+
+// The whole mapping: slots, then the task order the deques index into.
+template <typename Result>
+class SharedArea {
+public:
+    SharedArea(size_t workers, size_t tasks) : workers_(workers) {
+        bytes_ = sizeof(Slot<Result>) * workers + sizeof(uint32_t) * std::max<size_t>(1, tasks);
+        void* p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::runtime_error(std::string("mmap: ") + std::strerror(errno));
+        base_ = p;
+        for (size_t w = 0; w < workers; ++w) {
+            Slot<Result>* s = new (slot(w)) Slot<Result>();
+            s->current.store(-1);
+            s->retry.store(-1);
+        }
+    }
+    ~SharedArea() {
+        for (size_t w = 0; w < workers_; ++w) slot(w)->~Slot<Result>();
+        munmap(base_, bytes_);
+    }
+    SharedArea(const SharedArea&) = delete;
+    SharedArea& operator=(const SharedArea&) = delete;
+
+    Slot<Result>* slot(size_t w) const { return static_cast<Slot<Result>*>(base_) + w; }
+    uint32_t* order() const {
+        return reinterpret_cast<uint32_t*>(static_cast<char*>(base_) + sizeof(Slot<Result>) * workers_);
+    }
+    size_t workers() const { return workers_; }
+
+private:
+    size_t workers_, bytes_ = 0;
+    void*  base_ = nullptr;
+};
+
+// Next task for worker `w`: its own head, else half of the fullest deque.
+template <typename Result>
+int64_t claim(const SharedArea<Result>& area, size_t w) {
+    Slot<Result>* mine = area.slot(w);
+    for (;;) {
+        uint64_t d = mine->deque.load();
+        while (headOf(d) < tailOf(d)) {
+            if (mine->deque.compare_exchange_weak(d, pack(headOf(d) + 1, tailOf(d)))) {
+                return area.order()[headOf(d)];
+            }
+        }
+
+        size_t victim = area.workers();
+        uint32_t most = 0;
+        for (size_t v = 0; v < area.workers(); ++v) {
+            const uint64_t dv = area.slot(v)->deque.load();
+            if (v != w && tailOf(dv) > headOf(dv) && tailOf(dv) - headOf(dv) > most) {
+                most = tailOf(dv) - headOf(dv);
+                victim = v;
+            }
+        }
+        if (victim == area.workers()) return -1;
+
+        uint64_t dv = area.slot(victim)->deque.load();
+        const uint32_t left = tailOf(dv) - std::min(tailOf(dv), headOf(dv));
+        if (left == 0) continue;
+        const uint32_t take = (left + 1) / 2;
+        const uint32_t from = tailOf(dv) - take;
+        if (area.slot(victim)->deque.compare_exchange_strong(dv, pack(headOf(dv), from))) {
+            // Our deque is empty, so nobody else writes it meanwhile
+            mine->deque.store(pack(from, from + take));
+            mine->steals.fetch_add(1);
+        }
+    }
+}
+
+template <typename Result>
+void publish(Slot<Result>* s, uint32_t task, const Result* value, const std::string& error) {
+    const uint64_t tail = s->ringTail.load(std::memory_order_relaxed);
+    while (tail - s->ringHead.load(std::memory_order_acquire) >= RING_SLOTS) sleepMicros(100);
+    Entry<Result>& e = s->ring[tail % RING_SLOTS];
+    e.task = task;
+    e.ok   = value != nullptr;
+    if (value) e.value = *value;
+    std::strncpy(e.error, error.c_str(), ERROR_LEN - 1);
+    e.error[ERROR_LEN - 1] = '\0';
+    s->ringTail.store(tail + 1, std::memory_order_release);
+}
+
+// Body of a worker process; never returns.
+template <typename Result, typename Job>
+[[noreturn]] void workerMain(const SharedArea<Result>& area, size_t w, Job& job) {
+    Slot<Result>* s = area.slot(w);
+    int64_t task = s->retry.exchange(-1);
+    if (task < 0) task = claim(area, w);
+    while (task >= 0) {
+        s->started.store(monotonicSeconds());
+        s->current.store(task);
+        try {
+            const Result r = job(static_cast<size_t>(task));
+            publish(s, static_cast<uint32_t>(task), &r, "");
+        } catch (const std::exception& ex) {
+            publish<Result>(s, static_cast<uint32_t>(task), nullptr, ex.what());
+        } catch (...) {
+            publish<Result>(s, static_cast<uint32_t>(task), nullptr, "unknown exception");
+        }
+        s->current.store(-1);
+        task = claim(area, w);
+    }
+    _exit(0);   // skip the parent's atexit handlers and stdio buffers
+}
+
+inline std::string describeExit(int status) {
+    if (WIFSIGNALED(status)) return std::string("killed by signal ") + std::to_string(WTERMSIG(status))
+                                    + " (" + strsignal(WTERMSIG(status)) + ")";
+    return "exited with status " + std::to_string(WEXITSTATUS(status));
+}
+
+} // namespace farm_detail
+
+// Run job(i) -> Result for every i in [0, n) on `opt.workers` processes and
+// store the results in `out` (resized to n). Tasks whose job threw, or whose
+// worker crashed `maxAttempts` times, keep a default Result and have their
+// message in the report's errors[i].
+template <typename Result, typename Job>
+FarmReport processFor(size_t n, const FarmOptions& opt, Job&& job, std::vector<Result>& out) {
+    using namespace farm_detail;
+    static_assert(std::is_trivially_copyable<Result>::value, "processFor results cross process boundaries");
+
+    FarmReport report;
+    report.errors.assign(n, "");
+    out.assign(n, Result{});
+    if (n == 0) return report;
+    if (n > UINT32_MAX) throw std::invalid_argument("too many tasks for one farm");
+
+    const size_t workers = std::max<size_t>(1, std::min(opt.workers, n));
+    SharedArea<Result> area(workers, n);
+
+    std::vector<bool> done(n, false);
+    std::vector<int>  attempts(n, 0);
+    std::vector<pid_t> pids(workers, -1);
+    std::vector<bool> timedOut(workers, false);
+
+    auto drain = [&]() {
+        bool any = false;
+        for (size_t w = 0; w < workers; ++w) {
+            Slot<Result>* s = area.slot(w);
+            const uint64_t tail = s->ringTail.load(std::memory_order_acquire);
+            for (uint64_t h = s->ringHead.load(std::memory_order_relaxed); h < tail; ++h) {
+                const Entry<Result>& e = s->ring[h % RING_SLOTS];
+                if (e.task < n && !done[e.task]) {
+                    done[e.task] = true;
+                    if (e.ok) out[e.task] = e.value;
+                    else      report.errors[e.task] = e.error;
+                }
+                s->ringHead.store(h + 1, std::memory_order_release);
+                any = true;
+            }
+        }
+        return any;
+    };
+
+    auto spawn = [&](size_t w) {
+        const pid_t pid = fork();
+        if (pid < 0) throw std::runtime_error(std::string("fork: ") + std::strerror(errno));
+        if (pid == 0) workerMain(area, w, job);
+        pids[w] = pid;
+    };
+
+    // Hand the tasks out as even contiguous ranges; stealing evens them up
+    // again as run times differ
+    auto deal = [&](const std::vector<uint32_t>& tasks) {
+        for (size_t k = 0; k < tasks.size(); ++k) area.order()[k] = tasks[k];
+        const size_t per = (tasks.size() + workers - 1) / workers;
+        for (size_t w = 0; w < workers; ++w) {
+            const uint32_t lo = static_cast<uint32_t>(std::min(tasks.size(), w * per));
+            const uint32_t hi = static_cast<uint32_t>(std::min(tasks.size(), lo + per));
+            area.slot(w)->deque.store(pack(lo, hi));
+        }
+    };
+
+    std::vector<uint32_t> pending(n);
+    for (size_t i = 0; i < n; ++i) pending[i] = static_cast<uint32_t>(i);
+
+    try {
+        // Normally one round; another only picks up tasks lost when a worker
+        // died between claiming them (or stealing a range) and recording one
+        // as in progress
+        while (!pending.empty()) {
+            deal(pending);
+            size_t live = 0;
+            for (size_t w = 0; w < workers; ++w) {
+                spawn(w);
+                ++live;
+            }
+
+            while (live > 0) {
+                bool progressed = drain();
+
+                int status = 0;
+                const pid_t pid = waitpid(-1, &status, WNOHANG);
+                if (pid > 0) {
+                    progressed = true;
+                    const size_t w = static_cast<size_t>(std::find(pids.begin(), pids.end(), pid) - pids.begin());
+                    if (w == workers) continue;
+                    pids[w] = -1;
+                    --live;
+                    drain();
+
+                    // Exiting in the middle of a task counts as a crash, even with status 0
+                    Slot<Result>* s = area.slot(w);
+                    const int64_t task = s->current.exchange(-1);
+                    const bool crashed = !(WIFEXITED(status) && WEXITSTATUS(status) == 0) || task >= 0;
+                    const std::string why = timedOut[w]
+                        ? "timed out after " + std::to_string(opt.taskTimeout) + " s"
+                        : describeExit(status);
+                    timedOut[w] = false;
+                    if (!crashed) continue;
+
+                    if (task >= 0 && !done[task]) {
+                        if (++attempts[task] >= opt.maxAttempts) {
+                            done[task] = true;
+                            report.errors[task] = "worker " + why + " on all "
+                                                  + std::to_string(attempts[task]) + " attempts";
+                        } else {
+                            s->retry.store(task);
+                        }
+                    }
+                    ++report.restarts;
+                    spawn(w);
+                    ++live;
+                } else if (pid < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::string("waitpid: ") + std::strerror(errno));
+                }
+
+                if (opt.taskTimeout > 0.0) {
+                    const double now = monotonicSeconds();
+                    for (size_t w = 0; w < workers; ++w) {
+                        Slot<Result>* s = area.slot(w);
+                        if (pids[w] > 0 && !timedOut[w] && s->current.load() >= 0
+                            && now - s->started.load() > opt.taskTimeout) {
+                            timedOut[w] = true;
+                            kill(pids[w], SIGKILL);   // reaped and retried above
+                        }
+                    }
+                }
+                if (!progressed) sleepMicros(500);
+            }
+            drain();
+
+            pending.clear();
+            for (size_t i = 0; i < n; ++i) {
+                if (!done[i]) pending.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    } catch (...) {
+        for (pid_t pid : pids) {
+            if (pid > 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+        throw;
+    }
+
+    for (size_t w = 0; w < workers; ++w) report.steals += area.slot(w)->steals.load();
+    return report;
+}
+
+#endif // PROCESS_FARM_HPP
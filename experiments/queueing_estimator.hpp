@@ -0,0 +1,212 @@
+#ifndef QUEUEING_ESTIMATOR_HPP
+#define QUEUEING_ESTIMATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "store_config.hpp"
+#include "till_profile.hpp"
+#include "generator.hpp"
+#include "payment_processor.hpp"
+#include "traveler.hpp"
+
+// ---- Analytical queueing-network estimate of a StoreConfig ----
+// Closed-form approximations, evaluated in well under a microsecond, used to
+// screen sweep candidates before paying for a full simulation:
+//
+//   walk-in:  lane group (M/G/c, Allen-Cunneen) -> PaymentProcessor (M/G/c,
+//             one server per terminal) -> traveler (deterministic walk)
+//   online:   Packer (M/M/c, exponential search time) -> CurbsideDispatcher (M/G/1)
+//
+// Arrival rates and service moments come from the same StoreConfig fields and
+// distribution constants that Generator, Cash and PaymentProcessor use, or
+// from the till profile histograms when cfg.tillData is set. Lane
+// groups follow Distributor's rule (basket <= selfItemLimit goes to
+// self-checkout), treating each group as pooled and ignoring the maxQueue
+// overflow, so estimates are optimistic near saturation. Unstable stations
+// (utilisation >= 1) give an infinite sojourn.
+
+struct StationEstimate {
+    double utilisation = 0.0;
+    double wait        = 0.0;   // mean time in queue
+    double service     = 0.0;   // mean service time
+    double sojourn() const { return wait + service; }
+};
+
+struct QueueingEstimate {
+    StationEstimate cashLanes, selfLanes, payment, packer, curbside;
+
+    double walkinSojourn = 0.0;
+    double onlineSojourn = 0.0;
+    double walkinRate    = 0.0;   // customers per second reaching sink_walkin
+    double onlineRate    = 0.0;
+    bool   stable        = true;
+};
+
+namespace queueing_detail {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// Erlang C: probability an arrival waits in M/M/c with offered load a = lambda/mu.
+inline double erlangC(int c, double a) {
+    double term = 1.0;     // a^k / k!
+    double sum  = 1.0;
+    for (int k = 1; k < c; ++k) {
+        term *= a / k;
+        sum  += term;
+    }
+    const double top = term * a / c / (1.0 - a / c);
+    return top / (sum + top);
+}
+
+// M/G/c with Poisson arrivals, mean service es and squared CV cs2.
+inline StationEstimate mgc(double lambda, int c, double es, double cs2) {
+    StationEstimate st;
+    st.service = es;
+    if (lambda <= 0.0) return st;
+    if (c <= 0) {
+        st.utilisation = INF;
+        st.wait = INF;
+        return st;
+    }
+    const double a = lambda * es;
+    st.utilisation = a / c;
+    if (st.utilisation >= 1.0) {
+        st.wait = INF;
+        return st;
+    }
+    const double wqMMc = erlangC(c, a) * es / (c - a);
+    st.wait = wqMMc * (1.0 + cs2) / 2.0;
+    return st;
+}
+
+// Moments of a basket uniform on the integers [lo, hi]
+inline void basketMoments(int lo, int hi, double& m1, double& m2) {
+    m1 = 0.0;
+    m2 = 0.0;
+    if (hi < lo) return;
+    const double n = hi - lo + 1;
+    for (int k = lo; k <= hi; ++k) {
+        m1 += k;
+        m2 += static_cast<double>(k) * k;
+    }
+    m1 /= n;
+    m2 /= n;
+}
+
+// Moments of the basket sizes in [lo, hi] of a basket histogram, and their share
+inline double basketMoments(const EmpiricalDistribution& items, int lo, int hi, double& m1, double& m2) {
+    double p = 0.0;
+    m1 = 0.0;
+    m2 = 0.0;
+    for (const auto& b : items.bins()) {
+        if (b.lo < lo || b.lo > hi) continue;
+        p  += b.weight;
+        m1 += b.weight * b.lo;
+        m2 += b.weight * b.lo * b.lo;
+    }
+    if (p > 0.0) {
+        m1 /= p;
+        m2 /= p;
+    }
+    return p;
+}
+
+// E[X] and E[X^2] of a uniform on [a, b]
+inline double uniformMean(double a, double b)   { return (a + b) / 2.0; }
+inline double uniformSecond(double a, double b) { return (a * a + a * b + b * b) / 3.0; }
+
+} // namespace queueing_detail
+
+inline QueueingEstimate estimateStore(const StoreConfig& cfg, const TillProfile& till) {
+    using namespace queueing_detail;
+    QueueingEstimate est;
+
+    const double lambda = 1.0 / std::max(1e-9, cfg.arrivalMean);
+    const double lambdaOnline = lambda * cfg.onlineProb;
+    const double lambdaWalkin = lambda - lambdaOnline;
+
+    // ---- Lane groups (Distributor routing by basket size) ----
+    // With one group missing, Distributor's fallback sends everyone to the other.
+    int maxBasket = MAX_ITEMS;
+    if (till.items) {
+        maxBasket = MIN_ITEMS;
+        for (const auto& b : till.items->bins()) maxBasket = std::max(maxBasket, static_cast<int>(b.lo));
+    }
+    const int minBasket = till.items ? 0 : MIN_ITEMS;
+    int limit = std::clamp(cfg.selfItemLimit, minBasket - 1, maxBasket);
+    if (cfg.selfLanes <= 0 && cfg.selfBank <= 0) limit = minBasket - 1;
+    else if (cfg.cashLanes <= 0) limit = maxBasket;
+
+    double selfM1, selfM2, cashM1, cashM2, pSelf;
+    if (till.items) {
+        pSelf = basketMoments(*till.items, 0, limit, selfM1, selfM2);
+        basketMoments(*till.items, limit + 1, maxBasket, cashM1, cashM2);
+    } else {
+        pSelf = (limit - MIN_ITEMS + 1) / static_cast<double>(MAX_ITEMS - MIN_ITEMS + 1);
+        basketMoments(MIN_ITEMS, limit, selfM1, selfM2);
+        basketMoments(limit + 1, MAX_ITEMS, cashM1, cashM2);
+    }
+
+    // Service = basket x per-item time / cashier speed, the three independent;
+    // a group's cashiers are pooled, so their speeds are averaged. A
+    // self-checkout bank is one laneId with selfBank kiosks.
+    auto laneGroup = [&](double share, int first, int lanes, int servers, double tpi,
+                         const std::shared_ptr<const EmpiricalDistribution>& perItem, double m1, double m2) {
+        const double t1 = perItem ? perItem->mean() : tpi;
+        const double t2 = perItem ? perItem->secondMoment() : tpi * tpi;
+        double s1 = 1.0, s2 = 1.0;
+        if (!till.speed.empty() && lanes > 0) {
+            s1 = s2 = 0.0;
+            for (int i = first; i < first + lanes; ++i) {
+                s1 += 1.0 / till.speed[i];
+                s2 += 1.0 / (till.speed[i] * till.speed[i]);
+            }
+            s1 /= lanes;
+            s2 /= lanes;
+        }
+        const double es  = t1 * m1 * s1;
+        const double es2 = t2 * m2 * s2;
+        const double cs2 = (es > 0.0) ? es2 / (es * es) - 1.0 : 0.0;
+        return mgc(lambdaWalkin * share, servers, es, cs2);
+    };
+    est.selfLanes = laneGroup(pSelf, cfg.cashLanes, selfLaneIds(cfg), cfg.selfBank > 0 ? cfg.selfBank : cfg.selfLanes,
+                              cfg.selfTimePerItem, till.selfPerItem, selfM1, selfM2);
+    est.cashLanes = laneGroup(1.0 - pSelf, 0, cfg.cashLanes, cfg.cashLanes, cfg.cashTimePerItem, till.cashPerItem,
+                              cashM1, cashM2);
+
+    // ---- PaymentProcessor: one server per terminal, card or cash ----
+    const double p = cfg.cardProb;
+    const double cardM1 = till.cardPay ? till.cardPay->mean() : uniformMean(CARD_PAY_MIN, CARD_PAY_MAX);
+    const double cardM2 = till.cardPay ? till.cardPay->secondMoment() : uniformSecond(CARD_PAY_MIN, CARD_PAY_MAX);
+    const double cashM1p = till.cashPay ? till.cashPay->mean() : uniformMean(CASH_PAY_MIN, CASH_PAY_MAX);
+    const double cashM2p = till.cashPay ? till.cashPay->secondMoment() : uniformSecond(CASH_PAY_MIN, CASH_PAY_MAX);
+    const double payM1 = p * cardM1 + (1.0 - p) * cashM1p;
+    const double payM2 = p * cardM2 + (1.0 - p) * cashM2p;
+    est.payment = mgc(lambdaWalkin, cfg.payTerminals, payM1, payM2 / (payM1 * payM1) - 1.0);
+
+    // ---- Online: packers (exponential search time), then one curbside bay ----
+    est.packer = mgc(lambdaOnline, cfg.packers, cfg.searchMean, 1.0);
+    const double travelM2 = cfg.travelMean * cfg.travelMean + cfg.travelStdDev * cfg.travelStdDev;
+    est.curbside = mgc(lambdaOnline, 1, cfg.travelMean, travelM2 / (cfg.travelMean * cfg.travelMean) - 1.0);
+
+    // ---- Journeys ----
+    const double laneSojourn = pSelf * est.selfLanes.sojourn() + (1.0 - pSelf) * est.cashLanes.sojourn();
+    est.walkinSojourn = laneSojourn + est.payment.sojourn() + TRAVEL_STEPS * 1.0;
+    est.onlineSojourn = est.packer.sojourn() + est.curbside.sojourn();
+
+    est.stable = std::isfinite(est.walkinSojourn) && std::isfinite(est.onlineSojourn);
+    est.walkinRate = est.stable ? lambdaWalkin : 0.0;
+    est.onlineRate = est.stable ? lambdaOnline : 0.0;
+    return est;
+}
+
+// Reads cfg.tillData, if set, on every call; screening many configurations
+// that share a profile should load it once and use the overload above.
+inline QueueingEstimate estimateStore(const StoreConfig& cfg) {
+    return estimateStore(cfg, cfg.tillData.empty() ? TillProfile()
+                                                   : loadTillProfile(cfg.tillData, cfg.cashLanes, selfLaneIds(cfg)));
+}
+
+#endif // QUEUEING_ESTIMATOR_HPP
@@ -0,0 +1,246 @@
+#ifndef RANKING_SELECTION_HPP
+#define RANKING_SELECTION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "store_config.hpp"
+#include "student_t.hpp"
+#include "worker_pool.hpp"
+
+// ---- Cheapest configuration meeting a KPI target ----
+// Candidates are ordered by a linear staffing cost. Each one is simulated
+// until its mean KPI is shown to be below the target (feasible) or above it
+// (infeasible) at the requested confidence, but only while it is still
+// cheaper than the cheapest candidate already shown feasible: once a cheap
+// configuration is known to work, dearer ones are never simulated.
+//
+// Replications go where they settle a decision fastest (OCBA for feasibility
+// determination): a candidate with KPI standard deviation s and mean m gets
+// a share of each batch proportional to s^2 / (m - target)^2, so the ones
+// close to the target get the runs and the clear-cut ones stop early.
+//
+// Each decision is a one-sided Student t test at level (1 - confidence) / K
+// for K candidates (Bonferroni), with n - 1 degrees of freedom for the n
+// replications seen so far. Taken once, the K tests are all right with the
+// stated confidence, and then the selected configuration both meets the
+// target and is the cheapest that does. With a tolerance d, candidates whose
+// mean is within d of the target may be decided either way (an indifference
+// zone, as in KN-type procedures), which bounds the replications spent on
+// them. Decisions are re-checked after every batch, and these repeated looks
+// add error the bound does not account for, so the confidence is nominal.
+
+// Welford mean and variance.
+struct SampleStats {
+    long   n    = 0;
+    double mean = 0.0;
+    double m2   = 0.0;
+
+    void add(double x) {
+        ++n;
+        const double d = x - mean;
+        mean += d / static_cast<double>(n);
+        m2 += d * (x - mean);
+    }
+    double variance() const { return (n > 1) ? m2 / static_cast<double>(n - 1) : 0.0; }
+};
+
+// Linear cost over StoreConfig parameters, "cashLanes=25,selfLanes=10".
+// Negative coefficients make smaller values dearer (e.g. a faster
+// cashTimePerItem means better trained, better paid staff).
+using CostModel = std::vector<std::pair<std::string, double>>;
+
+inline CostModel parseCostModel(const std::string& list) {
+    CostModel model;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("bad cost term (want parameter=coefficient): " + item);
+        }
+        numericParam(StoreConfig(), item.substr(0, eq));   // throws on unknown names
+        model.emplace_back(item.substr(0, eq), std::stod(item.substr(eq + 1)));
+    }
+    return model;
+}
+
+inline double staffingCost(const StoreConfig& cfg, const CostModel& model) {
+    double cost = 0.0;
+    for (const auto& term : model) cost += term.second * numericParam(cfg, term.first);
+    return cost;
+}
+
+struct SelectionOptions {
+    double target       = 0.0;    // KPI must be at most this
+    double tolerance    = 0.0;    // indifference zone: within this of the target, either answer will do
+    double confidence   = 0.95;   // joint, over all decisions
+    long   initialReps  = 10;     // per candidate before the first decision
+    long   maxReps      = 200;    // per candidate; still open then = undecided
+    size_t batch        = 8;      // replications allocated per round
+};
+
+enum class Feasibility { OPEN, FEASIBLE, INFEASIBLE, UNDECIDED };
+
+inline const char* feasibilityName(Feasibility f) {
+    switch (f) {
+        case Feasibility::OPEN:       return "open";
+        case Feasibility::FEASIBLE:   return "feasible";
+        case Feasibility::INFEASIBLE: return "infeasible";
+        case Feasibility::UNDECIDED:  return "undecided";
+    }
+    return "?";
+}
+
+struct SelectionCandidate {
+    std::string label;          // overrides that define it
+    StoreConfig cfg;
+    double      cost = 0.0;
+    SampleStats kpi;
+    Feasibility status = Feasibility::OPEN;
+    double      halfWidth = std::numeric_limits<double>::infinity();   // at the decision level
+};
+
+struct SelectionResult {
+    long   replications = 0;
+    size_t rounds       = 0;
+    double alpha        = 0.0;     // one-sided level of each decision
+    // Cheapest feasible candidate (lowest mean among equal costs), or npos
+    size_t selected     = static_cast<size_t>(-1);
+};
+
+namespace selection_detail {
+
+// Open candidates that could still beat the cheapest feasible one.
+inline std::vector<size_t> activeSet(const std::vector<SelectionCandidate>& cands) {
+    double bestCost = std::numeric_limits<double>::infinity();
+    for (const auto& c : cands) {
+        if (c.status == Feasibility::FEASIBLE) bestCost = std::min(bestCost, c.cost);
+    }
+    std::vector<size_t> active;
+    for (size_t i = 0; i < cands.size(); ++i) {
+        if (cands[i].status == Feasibility::OPEN && cands[i].cost <= bestCost) active.push_back(i);
+    }
+    return active;
+}
+
+// Candidate index for every replication of the next batch.
+inline std::vector<size_t> allocate(const std::vector<SelectionCandidate>& cands,
+                                    const std::vector<size_t>& active,
+                                    const SelectionOptions& opt) {
+    std::vector<size_t> plan;
+
+    // Candidates are started cheapest first, about a batch at a time, so the
+    // dearer ones may never need to start
+    for (size_t i : active) {
+        if (plan.size() >= opt.batch) break;
+        for (long r = cands[i].kpi.n; r < opt.initialReps; ++r) plan.push_back(i);
+    }
+    if (!plan.empty()) return plan;
+
+    // Then OCBA weights s^2 / (m - target)^2, filled greedily: each run goes
+    // to the candidate furthest below its share
+    std::vector<double> weight(active.size());
+    std::vector<long>   planned(active.size());
+    for (size_t k = 0; k < active.size(); ++k) {
+        const SelectionCandidate& c = cands[active[k]];
+        const double gap = std::max({std::abs(c.kpi.mean - opt.target), opt.tolerance,
+                                     1e-9 * std::max(1.0, opt.target)});
+        weight[k]  = std::max(c.kpi.variance(), 1e-12) / (gap * gap);
+        planned[k] = c.kpi.n;
+    }
+    for (size_t b = 0; b < opt.batch; ++b) {
+        size_t pick = active.size();
+        double best = 0.0;
+        for (size_t k = 0; k < active.size(); ++k) {
+            if (planned[k] >= opt.maxReps) continue;
+            const double need = weight[k] / static_cast<double>(planned[k] + 1);
+            if (pick == active.size() || need > best) { pick = k; best = need; }
+        }
+        if (pick == active.size()) break;
+        ++planned[pick];
+        plan.push_back(active[pick]);
+    }
+    return plan;
+}
+
+inline void decide(SelectionCandidate& c, double alpha, const SelectionOptions& opt) {
+    if (c.status != Feasibility::OPEN || c.kpi.n < std::max(2L, opt.initialReps)) return;
+    const double t = studentUpperQuantile(alpha, c.kpi.n - 1);
+    c.halfWidth = t * std::sqrt(c.kpi.variance() / static_cast<double>(c.kpi.n));
+    if (c.kpi.mean + c.halfWidth <= opt.target + opt.tolerance)     c.status = Feasibility::FEASIBLE;
+    else if (c.kpi.mean - c.halfWidth > opt.target - opt.tolerance) c.status = Feasibility::INFEASIBLE;
+    else if (c.kpi.n >= opt.maxReps)                                c.status = Feasibility::UNDECIDED;
+}
+
+} // namespace selection_detail
+
+// Runs the procedure; `cands` is sorted by cost first. run(i, rep) returns
+// the KPI of replication `rep` of candidate i. It is called concurrently on
+// `workers` threads and must be deterministic in (i, rep) for results to be
+// reproducible; a replication that throws stops the search with
+// std::runtime_error.
+template <typename Run>
+SelectionResult selectCheapestFeasible(std::vector<SelectionCandidate>& cands,
+                                       const SelectionOptions& opt,
+                                       size_t workers,
+                                       Run&& run) {
+    using namespace selection_detail;
+
+    std::stable_sort(cands.begin(), cands.end(), [](const SelectionCandidate& a, const SelectionCandidate& b) {
+        return a.cost < b.cost;
+    });
+
+    SelectionResult result;
+    result.alpha = (1.0 - opt.confidence) / static_cast<double>(std::max<size_t>(1, cands.size()));
+
+    for (;;) {
+        const std::vector<size_t> active = activeSet(cands);
+        if (active.empty()) break;
+        const std::vector<size_t> plan = allocate(cands, active, opt);
+        if (plan.empty()) break;
+
+        // Replication numbers are fixed before the batch runs
+        std::vector<long> reps(plan.size());
+        std::vector<long> next(cands.size());
+        for (size_t i = 0; i < cands.size(); ++i) next[i] = cands[i].kpi.n;
+        for (size_t k = 0; k < plan.size(); ++k) reps[k] = next[plan[k]]++;
+
+        std::vector<double> kpi(plan.size());
+        std::vector<std::string> errors(plan.size());
+        parallelFor(plan.size(), workers, [&](size_t k) {
+            try {
+                kpi[k] = run(plan[k], reps[k]);
+            } catch (const std::exception& ex) {
+                errors[k] = ex.what();
+            }
+        });
+        for (const auto& e : errors) {
+            if (!e.empty()) throw std::runtime_error(e);
+        }
+
+        for (size_t k = 0; k < plan.size(); ++k) cands[plan[k]].kpi.add(kpi[k]);
+        for (size_t i : active) decide(cands[i], result.alpha, opt);
+        result.replications += static_cast<long>(plan.size());
+        ++result.rounds;
+    }
+
+    for (size_t i = 0; i < cands.size(); ++i) {
+        if (cands[i].status != Feasibility::FEASIBLE) continue;
+        const size_t s = result.selected;
+        if (s == static_cast<size_t>(-1) || cands[i].cost < cands[s].cost
+            || (cands[i].cost == cands[s].cost && cands[i].kpi.mean < cands[s].kpi.mean)) {
+            result.selected = i;
+        }
+    }
+    return result;
+}
+
+#endif // RANKING_SELECTION_HPP
@@ -0,0 +1,203 @@
+#ifndef RARE_EVENT_SPLITTING_HPP
+#define RARE_EVENT_SPLITTING_HPP
+
+#include <cadmium/simulation/root_coordinator.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "grocery_store.hpp"
+#include "store_snapshot.hpp"
+#include "random_streams.hpp"
+#include "student_t.hpp"
+
+// ---- Multilevel splitting for tail waits ----
+// Estimates the fraction of walk-ins, among those starting payment in a peak
+// window, who queued longer than `waitThreshold` (entry, lane and payment
+// queues together; see PaymentProcessor::setObserver). Such waits only happen
+// when the checkout backlog is large, so the backlog is the importance
+// function:
+//   backlog = entry queue + customers assigned to lanes + payment queue
+//
+// Each root trajectory warms up from an empty store, then runs the window
+// with splitting and Russian roulette on `levels`, an increasing list of
+// backlog thresholds:
+//   - when the backlog first reaches the next level, the trajectory is cloned
+//     (snapshot + restore, fresh random streams) into `split` copies, each
+//     carrying 1/split of its weight;
+//   - when it falls back below the level under the one it was split at, it
+//     survives with probability 1/split and multiplies its weight by `split`.
+// Both steps keep the expected weighted count of every outcome unchanged, so
+// the weighted counts summed over a root's tree are unbiased for the crude
+// counts. Roots are independent, run on a worker pool, and give the ratio
+// estimate and its delta-method confidence interval.
+
+struct SplittingConfig {
+    StoreConfig store;                   // the peak-hour store
+    double warmup        = 3600.0;       // from empty, before the window
+    double window        = 3600.0;       // peak window length (simulated seconds)
+    double waitThreshold = 900.0;        // "waited too long" (seconds)
+    std::vector<int> levels;             // backlog thresholds; empty = crude Monte Carlo
+    int    split         = 2;            // clones per level crossing
+    long   maxParticles  = 200000;       // per root, guards against a runaway tree
+};
+
+// Weighted counts from one root's tree (or one crude run).
+struct SplittingSample {
+    double rare      = 0.0;   // weighted walk-ins over the threshold
+    double total     = 0.0;   // weighted walk-ins starting payment in the window
+    long   particles = 0;     // trajectories simulated, including the root
+    double simulated = 0.0;   // simulated seconds over all trajectories
+};
+
+struct SplittingEstimate {
+    size_t roots     = 0;
+    double p         = 0.0;   // estimated fraction of walk-ins waiting too long
+    double variance  = 0.0;   // of p (ratio estimator over the roots)
+    double halfWidth = 0.0;   // 95% CI, Student t with roots - 1 df
+    double relError  = 0.0;   // halfWidth / p
+    long   particles = 0;
+    double simulated = 0.0;
+};
+
+// Checkout backlog seen by the importance function.
+inline int storeBacklog(const grocery_store& store) {
+    const DistributorState& d = store.dist->getState();
+    int backlog = static_cast<int>(d.entry.size() + store.pay->getState().q.size());
+    for (int q : d.queues) backlog += q;
+    return backlog;
+}
+
+namespace splitting_detail {
+
+struct Particle {
+    std::shared_ptr<const StoreSnapshot> snap;   // null = the root, from an empty store
+    double   weight = 1.0;
+    size_t   level  = 0;      // levels crossed (and split at) so far
+    uint32_t seed   = 0;
+};
+
+// Clones must not replay each other's future: give the restored store new
+// arrival, customer-attribute, lane and payment streams.
+inline void reseed(grocery_store& store, uint32_t seed) {
+    Generator::RngState g = store.gen->getRng();
+    g.arrivals  = RandomStream(seed, g.arrivals.antithetic());
+    g.customers = RandomStream(seed ^ 0x5BD1E995u, g.customers.antithetic());
+    g.travel.reset();
+    store.gen->setRng(g);
+    store.pay->setRng((static_cast<uint64_t>(seed) << 32) ^ 0x9E3779B97F4A7C15ull);
+    for (auto& lane : store.lanes) lane->setRng((static_cast<uint64_t>(seed) << 32) ^ 0xC2B2AE3D27D4EB4Full);
+    if (store.selfBank) store.selfBank->setRng((static_cast<uint64_t>(seed) << 32) ^ 0xC2B2AE3D27D4EB4Full);
+}
+
+} // namespace splitting_detail
+
+// One root: warm-up, then the window with splitting. Deterministic for a seed.
+inline SplittingSample runSplittingRoot(const SplittingConfig& cfg, uint32_t rootSeed) {
+    using namespace splitting_detail;
+
+    const double start = cfg.warmup;
+    const double end   = cfg.warmup + cfg.window;
+    std::mt19937 engine(rootSeed);   // clone seeds and roulette draws
+    std::uniform_real_distribution<double> roulette(0.0, 1.0);
+
+    SplittingSample out;
+    std::vector<Particle> pending;
+    pending.push_back({nullptr, 1.0, 0, rootSeed});
+
+    while (!pending.empty()) {
+        Particle p = pending.back();
+        pending.pop_back();
+        if (++out.particles > cfg.maxParticles) {
+            throw std::runtime_error("splitting tree exceeded " + std::to_string(cfg.maxParticles)
+                                     + " trajectories; use fewer levels or a smaller split factor");
+        }
+
+        StoreConfig storeCfg = cfg.store;
+        storeCfg.seed = p.seed;
+        auto store = std::make_shared<grocery_store>("grocery_store_split", storeCfg);
+        if (p.snap) {
+            restoreSnapshot(*store, *p.snap);
+            reseed(*store, p.seed);
+        }
+
+        // Weighted counts use the particle's weight at the time of each event
+        double weight = p.weight;
+        store->pay->setObserver([&](double t, double waited) {
+            if (t < start || t >= end) return;
+            out.total += weight;
+            if (waited > cfg.waitThreshold) out.rare += weight;
+        });
+
+        auto clock = std::make_shared<TransitionClockLogger::Clock>();
+        const double t0 = p.snap ? p.snap->time : 0.0;
+        cadmium::RootCoordinator root(store, t0);
+        root.setLogger<TransitionClockLogger>(clock);
+        const auto top = root.getTopCoordinator();
+        root.start();
+
+        size_t level = p.level;
+        bool alive = true;
+        while (alive && top->getTimeNext() < end) {
+            root.simulate(1L);
+            const double now = top->getTimeLast();
+            if (now < start || cfg.levels.empty()) continue;
+
+            const int backlog = storeBacklog(*store);
+            if (level < cfg.levels.size() && backlog >= cfg.levels[level]) {
+                // Split: this trajectory continues as one of the copies
+                auto snap = std::make_shared<const StoreSnapshot>(takeSnapshot(*store, *clock, now));
+                weight /= cfg.split;
+                ++level;
+                for (int c = 1; c < cfg.split; ++c) {
+                    pending.push_back({snap, weight, level, static_cast<uint32_t>(engine())});
+                }
+            } else if (level >= 2 && backlog < cfg.levels[level - 2]) {
+                // Russian roulette back to the weight of the level below
+                if (roulette(engine) * cfg.split < 1.0) {
+                    weight *= cfg.split;
+                    --level;
+                } else {
+                    alive = false;
+                }
+            }
+        }
+        out.simulated += (alive ? end : top->getTimeLast()) - t0;
+        root.stop();
+    }
+    return out;
+}
+
+// Ratio estimate over independent roots: sum(rare) / sum(total), with the
+// delta-method variance of a ratio of means.
+inline SplittingEstimate estimateTail(const std::vector<SplittingSample>& samples) {
+    SplittingEstimate e;
+    e.roots = samples.size();
+    double rare = 0.0, total = 0.0;
+    for (const auto& s : samples) {
+        rare  += s.rare;
+        total += s.total;
+        e.particles += s.particles;
+        e.simulated += s.simulated;
+    }
+    if (e.roots < 2 || total <= 0.0) return e;
+    e.p = rare / total;
+
+    const double n = static_cast<double>(e.roots);
+    const double meanTotal = total / n;
+    double ss = 0.0;
+    for (const auto& s : samples) {
+        const double r = s.rare - e.p * s.total;
+        ss += r * r;
+    }
+    e.variance  = ss / (n - 1.0) / n / (meanTotal * meanTotal);
+    e.halfWidth = studentTwoSided(0.95, static_cast<long>(e.roots) - 1) * std::sqrt(e.variance);
+    e.relError  = (e.p > 0.0) ? e.halfWidth / e.p : std::numeric_limits<double>::infinity();
+    return e;
+}
+
+#endif // RARE_EVENT_SPLITTING_HPP
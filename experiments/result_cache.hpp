@@ -0,0 +1,109 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "store_config.hpp"
+#include "store_run.hpp"
+
+// Generated at build time from git describe and a hash of the model sources
+// (cmake/code_version.cmake); results from other code never match.
+#if __has_include("code_version.hpp")
+#include "code_version.hpp"
+#endif
+#ifndef GROCERY_CODE_VERSION
+#define GROCERY_CODE_VERSION "dev"
+#endif
+
+// On-disk cache of replication results keyed by (parameters, seed, horizon,
+// code version, contents of the input files the parameters name). One small file per run, named by a hash of the key; the full
+// key is stored on the first line and checked on lookup, so hash collisions
+// and stale files are simply misses.
+class ResultCache {
+public:
+    explicit ResultCache(std::string dir)
+        : dir_(std::move(dir))
+    {
+        if (!dir_.empty()) std::filesystem::create_directories(dir_);
+    }
+
+    static std::string key(const StoreConfig& cfg, unsigned int seed, double horizon) {
+        std::ostringstream os;
+        os.precision(17);
+        os << "version=" << GROCERY_CODE_VERSION
+           << ";seed=" << seed
+           << ";horizon=" << horizon
+           << ";" << describe(cfg);
+        // describe() names the roster and till data by path; key on what they
+        // contain, so an edited file, or the same relative path from another
+        // directory, misses
+        if (!cfg.schedule.empty()) os << ";schedule=" << cfg.schedule << '#' << fileDigest(cfg.schedule);
+        if (!cfg.tillData.empty()) os << ";tillData=" << cfg.tillData << '#' << fileDigest(cfg.tillData);
+        return os.str();
+    }
+
+    std::optional<RunResult> find(const std::string& key) const {
+        if (dir_.empty()) return std::nullopt;
+        std::ifstream in(pathFor(key));
+        std::string storedKey;
+        RunResult r;
+        if (!in || !std::getline(in, storedKey) || storedKey != key || !(in >> r)) {
+            return std::nullopt;
+        }
+        return r;
+    }
+
+    // Safe from several threads: each write goes to a private temp file that
+    // is renamed into place, so readers never see a half-written entry.
+    void store(const std::string& key, const RunResult& r) const {
+        if (dir_.empty()) return;
+        const std::string path = pathFor(key);
+        std::ostringstream tmpName;
+        tmpName << path << ".tmp" << std::this_thread::get_id();
+        {
+            std::ofstream out(tmpName.str());
+            out << key << '\n' << std::setprecision(17) << r << '\n';
+        }
+        std::rename(tmpName.str().c_str(), path.c_str());
+    }
+
+private:
+    std::string dir_;
+
+    // FNV-1a, 64 bit
+    static std::uint64_t hashKey(const std::string& key) {
+        std::uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    // FNV-1a of a file's contents in hex, "missing" if it cannot be read
+    static std::string fileDigest(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return "missing";
+        const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ostringstream os;
+        os << std::hex << std::setw(16) << std::setfill('0') << hashKey(contents);
+        return os.str();
+    }
+
+    std::string pathFor(const std::string& key) const {
+        std::ostringstream os;
+        os << dir_ << '/' << std::hex << std::setw(16) << std::setfill('0') << hashKey(key) << ".run";
+        return os.str();
+    }
+};
+
+#endif // RESULT_CACHE_HPP
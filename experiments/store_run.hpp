@@ -0,0 +1,46 @@
+#ifndef STORE_RUN_HPP
+#define STORE_RUN_HPP
+
+#include <memory>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "grocery_store.hpp"
+
+// KPIs of one grocery_store replication, read from the sinks at the end.
+struct RunResult {
+    int    walkinDone    = 0;
+    int    onlineDone    = 0;
+    double walkinSojourn = 0.0;   // mean seconds from store entry to exit
+    double onlineSojourn = 0.0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const RunResult& r) {
+    os << r.walkinDone << ' ' << r.onlineDone << ' '
+       << r.walkinSojourn << ' ' << r.onlineSojourn;
+    return os;
+}
+
+inline std::istream& operator>>(std::istream& is, RunResult& r) {
+    return is >> r.walkinDone >> r.onlineDone >> r.walkinSojourn >> r.onlineSojourn;
+}
+
+inline RunResult collectResult(const grocery_store& store) {
+    RunResult r;
+    r.walkinDone    = store.sink_walkin->getState().count;
+    r.onlineDone    = store.sink_online->getState().count;
+    r.walkinSojourn = store.sink_walkin->getState().meanSojourn();
+    r.onlineSojourn = store.sink_online->getState().meanSojourn();
+    return r;
+}
+
+// One replication without logging. Set cfg.seed for a reproducible run.
+inline RunResult runStore(const StoreConfig& cfg, double horizon) {
+    auto model = std::make_shared<grocery_store>("grocery_store", cfg);
+    cadmium::RootCoordinator root(model);
+    root.start();
+    root.simulate(horizon);
+    root.stop();
+    return collectResult(*model);
+}
+
+#endif // STORE_RUN_HPP
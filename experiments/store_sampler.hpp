@@ -0,0 +1,110 @@
+#ifndef STORE_SAMPLER_HPP
+#define STORE_SAMPLER_HPP
+
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "grocery_store.hpp"
+#include "state_sampler.hpp"
+
+// Default fields for a dashboard feed
+static const char* const DEFAULT_SAMPLE_FIELDS = "dist.queues,pay.queued,sink_walkin.count,cash.phase";
+
+// Register grocery_store state fields as sampler columns. `fields` is a comma
+// separated list; per-lane fields expand to one column per lane:
+//   dist.queues   customers assigned to each lane      (dist.queue<i>)
+//   dist.waiting  walk-ins in the entry queue
+//   cash.phase    1 while each lane is serving         (<lane id>.phase)
+//   cash.queued   waiting behind each lane's customer  (<lane id>.queued)
+//                 (a self-checkout bank gives kiosks in use and its line)
+//   pay.phase, pay.queued, packer.busy, packer.queued,
+//   curbside.phase, curbside.queued,
+//   sink_walkin.count, sink_online.count
+// Throws std::invalid_argument for an unknown field.
+inline void addStoreFields(StateSampler& sampler, const grocery_store& store, const std::string& fields) {
+    std::stringstream list(fields);
+    for (std::string field; std::getline(list, field, ',');) {
+        if (field.empty()) continue;
+
+        if (field == "dist.queues") {
+            auto dist = store.dist;
+            for (size_t i = 0; i < dist->getState().queues.size(); ++i) {
+                sampler.addColumn("dist.queue" + std::to_string(i), ColumnType::INT32,
+                                  [dist, i] { return dist->getState().queues[i]; });
+            }
+        } else if (field == "dist.waiting") {
+            auto dist = store.dist;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [dist] { return static_cast<double>(dist->getState().entry.size()); });
+        } else if (field == "cash.phase" || field == "cash.queued") {
+            const bool phase = (field == "cash.phase");
+            for (const auto& lane : store.lanes) {
+                sampler.addColumn(lane->getId() + (phase ? ".phase" : ".queued"), ColumnType::INT32,
+                                  [lane, phase] {
+                                      const CashState& s = lane->getState();
+                                      return phase ? (s.phase == CashState::Phase::BUSY ? 1.0 : 0.0)
+                                                   : static_cast<double>(s.q.size());
+                                  });
+            }
+            if (auto bank = store.selfBank) {
+                sampler.addColumn(bank->getId() + (phase ? ".phase" : ".queued"), ColumnType::INT32,
+                                  [bank, phase] {
+                                      const SelfCheckoutBankState& s = bank->getState();
+                                      return static_cast<double>(phase ? s.active.size() : s.q.size());
+                                  });
+            }
+        } else if (field == "pay.phase") {
+            auto pay = store.pay;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [pay] { return pay->getState().phase == PaymentProcessorState::Phase::BUSY ? 1.0 : 0.0; });
+        } else if (field == "pay.queued") {
+            auto pay = store.pay;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [pay] { return static_cast<double>(pay->getState().q.size()); });
+        } else if (field == "packer.busy") {
+            auto packer = store.pickup->packer;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [packer] { return static_cast<double>(packer->getState().active.size()); });
+        } else if (field == "packer.queued") {
+            auto packer = store.pickup->packer;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [packer] { return static_cast<double>(packer->getState().q.size()); });
+        } else if (field == "curbside.phase") {
+            auto curb = store.pickup->curbside;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [curb] { return curb->getState().phase == CurbsideDispatcherState::Phase::BUSY ? 1.0 : 0.0; });
+        } else if (field == "curbside.queued") {
+            auto curb = store.pickup->curbside;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [curb] { return static_cast<double>(curb->getState().q.size()); });
+        } else if (field == "sink_walkin.count" || field == "sink_online.count") {
+            auto sink = (field == "sink_walkin.count") ? store.sink_walkin : store.sink_online;
+            sampler.addColumn(field, ColumnType::INT32,
+                              [sink] { return static_cast<double>(sink->getState().count); });
+        } else {
+            throw std::invalid_argument("unknown sample field: " + field);
+        }
+    }
+}
+
+// grocery_store plus a StateSampler, as one top model. Nothing is coupled to
+// the sampler; it only reads the store's states on its own schedule.
+struct sampled_store : public Coupled {
+    std::shared_ptr<grocery_store> store;
+    std::shared_ptr<StateSampler>  sampler;
+
+    sampled_store(const std::string& id, const StoreConfig& cfg,
+                  const std::string& path, double interval,
+                  const std::string& fields = DEFAULT_SAMPLE_FIELDS)
+        : Coupled(id)
+    {
+        store   = addComponent<grocery_store>("grocery_store", cfg);
+        sampler = addComponent<StateSampler>("sampler", interval);
+        addStoreFields(*sampler, *store, fields);
+        sampler->open(path);
+    }
+};
+
+#endif // STORE_SAMPLER_HPP
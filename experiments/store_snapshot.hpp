@@ -0,0 +1,274 @@
+#ifndef STORE_SNAPSHOT_HPP
+#define STORE_SNAPSHOT_HPP
+
+#include <cadmium/simulation/logger/logger.hpp>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "grocery_store.hpp"
+
+// ---- Warm-up snapshots ----
+// Simulate a grocery_store to a warm-up time once, copy every atomic state
+// (plus the RNG engines) into a StoreSnapshot, then restore that snapshot into
+// any number of freshly built stores with different StoreConfigs and continue
+// each one from the warm-up time with RootCoordinator(model, snap.time).
+//
+// The snapshot is shared read-only between forks, and its queues are frozen
+// (ForkQueue, RenegingQueue::freeze): the customers waiting at the fork live
+// in blocks every fork shares. restoreSnapshot() copies the fixed-size part of
+// each state, so a fork's memory grows with the customers who join its queues
+// after the fork (plus one bit per frozen customer who reneges mid-queue),
+// not with the queues it started from. Hybrid-mode fluid tokens are the one
+// exception and are copied in full.
+
+// Cadmium does not expose when each model last transitioned, but every
+// transition is logged. This logger keeps just that time per model name, which
+// is what we need to rebase each remaining sigma onto the snapshot time.
+class TransitionClockLogger : public cadmium::Logger {
+public:
+    using Clock = std::unordered_map<std::string, double>;
+
+    explicit TransitionClockLogger(std::shared_ptr<Clock> clock)
+        : clock_(std::move(clock)) {}
+
+    void start() override {}
+    void stop() override {}
+
+    void logOutput(double, long, const std::string&, const std::string&, const std::string&) override {}
+
+    void logState(double time, long, const std::string& modelName, const std::string&) override {
+        (*clock_)[modelName] = time;
+    }
+
+private:
+    std::shared_ptr<Clock> clock_;
+};
+
+struct StoreSnapshot {
+    double time = 0.0;
+
+    GeneratorState             gen;
+    Generator::RngState        genRng;
+    DistributorState           dist;
+    std::vector<CashState>     lanes;
+    Cash::RngState             laneRng = 0;   // shared by every lane
+    std::optional<SelfCheckoutBankState> selfBank;   // set when the store has a self-checkout bank
+    PaymentProcessorState      pay;
+    PaymentProcessor::RngState payRng;
+    travelerState              walk;
+    PackerState                packer;
+    CurbsideDispatcherState    curbside;
+    CustomerSinkState          sinkWalkin;
+    CustomerSinkState          sinkOnline;
+    std::optional<ShiftScheduleState> shifts;   // set when the store has a shift schedule
+};
+
+namespace snapshot_detail {
+
+// Remaining sigma is relative to each model's last transition; shift it so the
+// restored model can start at the snapshot time instead.
+template <typename S>
+void rebase(S& s, double elapsed) {
+    if (s.sigma != std::numeric_limits<double>::infinity()) {
+        s.sigma = std::max(0.0, s.sigma - elapsed);
+    }
+}
+
+// advance() moves the packer's clock along with its orders
+inline void rebase(PackerState& s, double elapsed) {
+    Packer::advance(s, elapsed);
+    rebase<PackerState>(s, elapsed);
+}
+
+// Models that keep their own clock advance it instead.
+inline void rebase(DistributorState& s, double elapsed)  { s.clock += elapsed; }
+inline void rebase(CustomerSinkState& s, double elapsed) { s.clock += elapsed; }
+
+// ... or both, when the clock only dates deadlines and trace events.
+inline void rebase(CashState& s, double elapsed) {
+    s.clock += elapsed;
+    rebase<CashState>(s, elapsed);
+}
+inline void rebase(SelfCheckoutBankState& s, double elapsed) {
+    s.clock += elapsed;
+    rebase<SelfCheckoutBankState>(s, elapsed);
+}
+inline void rebase(travelerState& s, double elapsed) {
+    s.clock += elapsed;
+    rebase<travelerState>(s, elapsed);
+}
+inline void rebase(ShiftScheduleState& s, double elapsed) {
+    s.clock += elapsed;
+    rebase<ShiftScheduleState>(s, elapsed);
+}
+inline void rebase(PaymentProcessorState& s, double elapsed) {
+    PaymentProcessor::advance(s, elapsed);
+    rebase<PaymentProcessorState>(s, elapsed);
+}
+inline void rebase(CurbsideDispatcherState& s, double elapsed) {
+    s.clock += elapsed;
+    rebase<CurbsideDispatcherState>(s, elapsed);
+}
+
+// Move every waiting customer into blocks the forks share
+inline void freezeQueues(StoreSnapshot& snap) {
+    snap.dist.entry.freeze();
+    for (CashState& lane : snap.lanes) lane.q.freeze();
+    if (snap.selfBank) snap.selfBank->q.freeze();
+    snap.pay.q.freeze();
+    snap.packer.q.freeze();
+    snap.curbside.q.freeze();
+}
+
+inline double elapsedFor(const TransitionClockLogger::Clock& clock, const std::string& name, double time) {
+    auto it = clock.find(name);
+    return (it == clock.end()) ? 0.0 : std::max(0.0, time - it->second);
+}
+
+} // namespace snapshot_detail
+
+// Capture `store` at `time`. Call after root.simulate(...) and before root.stop(),
+// with `clock` filled by a TransitionClockLogger attached to that root.
+inline StoreSnapshot takeSnapshot(const grocery_store& store,
+                                  const TransitionClockLogger::Clock& clock,
+                                  double time) {
+    using snapshot_detail::rebase;
+    using snapshot_detail::elapsedFor;
+
+    StoreSnapshot snap;
+    snap.time = time;
+
+    snap.gen    = store.gen->getState();
+    snap.genRng = store.gen->getRng();
+    rebase(snap.gen, elapsedFor(clock, store.gen->getId(), time));
+
+    snap.dist = store.dist->getState();
+    rebase(snap.dist, elapsedFor(clock, store.dist->getId(), time));
+
+    for (const auto& lane : store.lanes) {
+        CashState s = lane->getState();
+        rebase(s, elapsedFor(clock, lane->getId(), time));
+        snap.lanes.push_back(s);
+    }
+    if (!store.lanes.empty()) snap.laneRng = store.lanes.front()->getRng();
+    if (store.selfBank) {
+        SelfCheckoutBankState s = store.selfBank->getState();
+        rebase(s, elapsedFor(clock, store.selfBank->getId(), time));
+        snap.selfBank = s;
+        if (store.lanes.empty()) snap.laneRng = store.selfBank->getRng();
+    }
+
+    snap.pay    = store.pay->getState();
+    snap.payRng = store.pay->getRng();
+    rebase(snap.pay, elapsedFor(clock, store.pay->getId(), time));
+
+    snap.walk = store.walk->getState();
+    rebase(snap.walk, elapsedFor(clock, store.walk->getId(), time));
+
+    snap.packer = store.pickup->packer->getState();
+    rebase(snap.packer, elapsedFor(clock, store.pickup->packer->getId(), time));
+
+    snap.curbside = store.pickup->curbside->getState();
+    rebase(snap.curbside, elapsedFor(clock, store.pickup->curbside->getId(), time));
+
+    snap.sinkWalkin = store.sink_walkin->getState();
+    rebase(snap.sinkWalkin, elapsedFor(clock, store.sink_walkin->getId(), time));
+    snap.sinkOnline = store.sink_online->getState();
+    rebase(snap.sinkOnline, elapsedFor(clock, store.sink_online->getId(), time));
+
+    if (store.shifts) {
+        snap.shifts = store.shifts->getState();
+        rebase(*snap.shifts, elapsedFor(clock, store.shifts->getId(), time));
+    }
+    snapshot_detail::freezeQueues(snap);
+    return snap;
+}
+
+// Load `snap` into a store built with (possibly different) StoreConfig.
+// Parameters come from the target store, dynamic state from the snapshot:
+// lanes keep their own timePerItem, and if the fork has fewer packers the
+// orders they were packing go back to the front of the packing queue. Payments
+// in progress always finish; a fork with more terminals starts the queue on them,
+// and a self-checkout bank treats its kiosks the same way. A shift schedule
+// resumes at the snapshot's position in the roster, and owns the open lanes
+// and terminal count until its next change.
+// The lane layout, and whether there is a schedule, must match: throws
+// std::invalid_argument otherwise.
+inline void restoreSnapshot(grocery_store& store, const StoreSnapshot& snap) {
+    if (store.lanes.size() != snap.lanes.size()) {
+        throw std::invalid_argument("snapshot has " + std::to_string(snap.lanes.size())
+                                    + " lanes, store has " + std::to_string(store.lanes.size()));
+    }
+    if (snap.selfBank.has_value() != (store.selfBank != nullptr)) {
+        throw std::invalid_argument(std::string("snapshot ") + (snap.selfBank ? "has" : "has no")
+                                    + " self-checkout bank, store " + (store.selfBank ? "has one" : "has none"));
+    }
+    if (snap.shifts.has_value() != (store.shifts != nullptr)) {
+        throw std::invalid_argument(std::string("snapshot ") + (snap.shifts ? "has" : "has no")
+                                    + " shift schedule, store " + (store.shifts ? "has one" : "has none"));
+    }
+
+    store.gen->setState(snap.gen);
+    store.gen->setRng(snap.genRng);
+
+    store.dist->setState(snap.dist);
+
+    for (size_t i = 0; i < store.lanes.size(); ++i) {
+        CashState s = snap.lanes[i];
+        const CashState& target = store.lanes[i]->getState();
+        s.laneId      = target.laneId;
+        s.timePerItem = target.timePerItem;
+        store.lanes[i]->setState(s);
+        store.lanes[i]->setRng(snap.laneRng);
+    }
+    if (store.selfBank) {
+        SelfCheckoutBankState s = *snap.selfBank;
+        const SelfCheckoutBankState& target = store.selfBank->getState();
+        s.laneId      = target.laneId;
+        s.kiosks      = target.kiosks;
+        s.timePerItem = target.timePerItem;
+        store.selfBank->setState(s);
+        store.selfBank->setRng(snap.laneRng);
+    }
+
+    // A schedule owns the terminal count; otherwise it is a parameter
+    PaymentProcessorState pay = snap.pay;
+    if (!store.shifts) pay.terminals = store.pay->getState().terminals;
+    store.pay->setState(pay);
+    store.pay->setRng(snap.payRng);
+    if (store.shifts) store.shifts->setState(*snap.shifts);
+
+    store.walk->setState(snap.walk);
+
+    PackerState pack = snap.packer;
+    const PackerState& target = store.pickup->packer->getState();
+    pack.defaultPackTimePerItem = target.defaultPackTimePerItem;
+    pack.packers                = target.packers;
+    if (static_cast<int>(pack.active.size()) > pack.packers) {
+        ForkQueue<CustomerData> requeued;
+        for (size_t i = pack.packers; i < pack.active.size(); ++i) {
+            requeued.push(pack.active[i].cust);
+        }
+        while (!pack.q.empty()) {
+            requeued.push(pack.q.front());
+            pack.q.pop();
+        }
+        pack.active.resize(pack.packers);
+        pack.q = std::move(requeued);
+    }
+    Packer::startWaiting(pack);
+    store.pickup->packer->setState(pack);
+
+    store.pickup->curbside->setState(snap.curbside);
+
+    store.sink_walkin->setState(snap.sinkWalkin);
+    store.sink_online->setState(snap.sinkOnline);
+}
+
+#endif // STORE_SNAPSHOT_HPP
@@ -0,0 +1,64 @@
+#ifndef STUDENT_T_HPP
+#define STUDENT_T_HPP
+
+#include <algorithm>
+#include <cmath>
+
+// ---- Student t quantiles ----
+// The one implementation behind every t-based interval and test in
+// experiments/ (batch means, paired differences, splitting, feasibility
+// decisions): exact up to the bisection tolerance for any df, where a table
+// or a Cornish-Fisher expansion is only right for some.
+
+// Regularised incomplete beta I_x(a, b), by its continued fraction
+// (modified Lentz), using the symmetry I_x(a, b) = 1 - I_{1-x}(b, a) where
+// that converges faster.
+inline double incompleteBeta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    if (x > (a + 1.0) / (a + b + 2.0)) return 1.0 - incompleteBeta(b, a, 1.0 - x);
+
+    const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b)
+                                  + a * std::log(x) + b * std::log1p(-x)) / a;
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+    double f = d;
+    for (int m = 1; m <= 300; ++m) {
+        for (int half = 0; half < 2; ++half) {
+            const double num = half == 0
+                ? m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m))
+                : -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+            d = 1.0 + num * d;
+            d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+            c = 1.0 + num / c;
+            if (std::abs(c) < tiny) c = tiny;
+            f *= c * d;
+            if (half == 1 && std::abs(c * d - 1.0) < 1e-14) return front * f;
+        }
+    }
+    return front * f;
+}
+
+// Upper quantile t with P(T > t) = alpha for Student's t with df degrees of
+// freedom, by bisection on P(T > t) = I_{df/(df+t^2)}(df/2, 1/2) / 2.
+inline double studentUpperQuantile(double alpha, long df) {
+    const double v = static_cast<double>(std::max(1L, df));
+    auto tail = [v](double t) { return 0.5 * incompleteBeta(0.5 * v, 0.5, v / (v + t * t)); };
+    double lo = 0.0, hi = 1.0;
+    while (tail(hi) > alpha && hi < 1e12) hi *= 2.0;
+    for (int i = 0; i < 100; ++i) {
+        const double mid = 0.5 * (lo + hi);
+        if (tail(mid) > alpha) lo = mid;
+        else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Two-sided interval multiplier: P(|T| > t) = 1 - confidence.
+inline double studentTwoSided(double confidence, long df) {
+    return studentUpperQuantile(0.5 * (1.0 - confidence), df);
+}
+
+#endif // STUDENT_T_HPP
@@ -0,0 +1,124 @@
+#ifndef SWEEP_DESIGN_HPP
+#define SWEEP_DESIGN_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "store_config.hpp"
+
+// One swept StoreConfig parameter, parsed from "name=v1,v2,v3" (explicit
+// levels) or "name=lo:hi" (continuous range, Latin hypercube only).
+struct Factor {
+    std::string name;
+    std::vector<std::string> levels;
+    bool   isRange = false;
+    double lo = 0.0;
+    double hi = 0.0;
+};
+
+// A design point: (parameter, value) pairs in factor order.
+using DesignPoint = std::vector<std::pair<std::string, std::string>>;
+
+inline Factor parseFactor(const std::string& spec) {
+    const size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq + 1 >= spec.size()) {
+        throw std::invalid_argument("bad factor (want name=v1,v2 or name=lo:hi): " + spec);
+    }
+    Factor f;
+    f.name = spec.substr(0, eq);
+    StoreConfig probe;
+    const std::string values = spec.substr(eq + 1);
+
+    const size_t colon = values.find(':');
+    if (colon != std::string::npos) {
+        f.isRange = true;
+        f.lo = std::stod(values.substr(0, colon));
+        f.hi = std::stod(values.substr(colon + 1));
+        if (!applyOverride(probe, f.name, values.substr(0, colon))) {
+            throw std::invalid_argument("unknown parameter: " + f.name);
+        }
+        return f;
+    }
+
+    std::stringstream ss(values);
+    std::string level;
+    while (std::getline(ss, level, ',')) {
+        if (!applyOverride(probe, f.name, level)) {
+            throw std::invalid_argument("unknown parameter: " + f.name);
+        }
+        f.levels.push_back(level);
+    }
+    return f;
+}
+
+// Full factorial over explicit levels (ranges are not allowed here).
+inline std::vector<DesignPoint> gridDesign(const std::vector<Factor>& factors) {
+    std::vector<DesignPoint> points{DesignPoint{}};
+    for (const auto& f : factors) {
+        if (f.isRange) {
+            throw std::invalid_argument("grid design needs explicit levels for " + f.name);
+        }
+        std::vector<DesignPoint> expanded;
+        for (const auto& p : points) {
+            for (const auto& level : f.levels) {
+                DesignPoint q = p;
+                q.emplace_back(f.name, level);
+                expanded.push_back(std::move(q));
+            }
+        }
+        points = std::move(expanded);
+    }
+    return points;
+}
+
+// Latin hypercube with n points: each factor's range (or level list) is cut
+// into n strata, every stratum is used exactly once, and the strata are
+// paired across factors by independent random permutations.
+inline std::vector<DesignPoint> latinHypercube(const std::vector<Factor>& factors, size_t n, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<DesignPoint> points(n);
+
+    for (const auto& f : factors) {
+        std::vector<size_t> strata(n);
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+
+        for (size_t i = 0; i < n; ++i) {
+            const double u = (static_cast<double>(strata[i]) + unit(rng)) / static_cast<double>(n);
+            std::string value;
+            if (f.isRange) {
+                const double x = f.lo + u * (f.hi - f.lo);
+                std::ostringstream os;
+                if (isIntegerParam(f.name)) os << std::lround(x);
+                else os << x;
+                value = os.str();
+            } else {
+                const size_t idx = std::min(f.levels.size() - 1,
+                                            static_cast<size_t>(u * static_cast<double>(f.levels.size())));
+                value = f.levels[idx];
+            }
+            points[i].emplace_back(f.name, value);
+        }
+    }
+    return points;
+}
+
+// "k1=v1,k2=v2" for applyOverrides.
+inline std::string toOverrides(const DesignPoint& p) {
+    std::string out;
+    for (const auto& kv : p) {
+        if (!out.empty()) out += ',';
+        out += kv.first + '=' + kv.second;
+    }
+    return out;
+}
+
+#endif // SWEEP_DESIGN_HPP
@@ -0,0 +1,50 @@
+#ifndef VARIANCE_REDUCTION_HPP
+#define VARIANCE_REDUCTION_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "student_t.hpp"
+
+// ---- Comparing two configurations with fewer replications ----
+// The quantity of interest is the mean difference B - A of a KPI. With R
+// simulation runs per configuration it is estimated from:
+//   independent  A and B on different seeds: R differences
+//   crn          A and B on the same seed (common random numbers): R differences
+//   antithetic   CRN on R/2 seeds, each run once plain and once antithetic;
+//                the average of the two differences is one observation
+// The variance of the estimated mean difference, relative to independent
+// runs, says how many runs each method needs for the same CI width.
+
+struct DifferenceEstimate {
+    std::string method;
+    size_t n          = 0;     // observations
+    double mean       = 0.0;   // estimated B - A
+    double variance   = 0.0;   // of the estimated mean (s^2 / n)
+    double halfWidth  = 0.0;   // 95% CI
+};
+
+inline DifferenceEstimate estimateDifference(const std::string& method, const std::vector<double>& obs) {
+    DifferenceEstimate e;
+    e.method = method;
+    e.n = obs.size();
+    if (e.n == 0) return e;
+    for (double x : obs) e.mean += x;
+    e.mean /= static_cast<double>(e.n);
+    if (e.n < 2) return e;
+    double ss = 0.0;
+    for (double x : obs) ss += (x - e.mean) * (x - e.mean);
+    e.variance  = ss / static_cast<double>(e.n - 1) / static_cast<double>(e.n);
+    e.halfWidth = studentTwoSided(0.95, static_cast<long>(e.n) - 1) * std::sqrt(e.variance);
+    return e;
+}
+
+// How much smaller `e`'s variance is than `baseline`'s for the same number of
+// runs, i.e. how many times fewer runs it needs for the same CI width.
+inline double varianceReduction(const DifferenceEstimate& baseline, const DifferenceEstimate& e) {
+    return (e.variance > 0.0) ? baseline.variance / e.variance : 0.0;
+}
+
+#endif // VARIANCE_REDUCTION_HPP
@@ -0,0 +1,34 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller does not say.
+inline size_t defaultWorkers() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Run job(i) for every i in [0, n) on up to `workers` threads. Jobs are
+// claimed one at a time, so long and short simulations balance themselves.
+// `job` must be safe to call concurrently for different i.
+template <typename Job>
+void parallelFor(size_t n, size_t workers, Job&& job) {
+    workers = std::max<size_t>(1, std::min(workers, n));
+    std::atomic<size_t> next{0};
+
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (size_t i = next++; i < n; i = next++) {
+                job(i);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+}
+
+#endif // WORKER_POOL_HPP
@@ -0,0 +1,249 @@
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <cadmium/simulation/root_coordinator.hpp>
+#include <cadmium/lib/iestream.hpp>
+
+#include "grocery_store_test.hpp"
+#include "customer_data.hpp"
+
+using namespace cadmium;
+
+// Performance regression gate for full-system runs (registered with ctest):
+//   perf_full_system --scale N [--baselines FILE] [--update] [--repeat R]
+//                    [--tolerance F] [--rss-tolerance F]
+// Runs grocery_store_test on a generated input of N * PERF_BASE_CUSTOMERS
+// customers until every customer has left, then compares simulation cycles
+// per CPU second (best of R runs) and peak RSS against the baseline stored for
+// this host and scale. Fails when throughput drops more than `tolerance` or
+// peak RSS grows more than `rss-tolerance` (fractions). Baselines are per
+// host: with no baseline for this host it only reports; --update records the
+// measured values. Built with -O2 (CMakeLists.txt).
+
+static constexpr int      PERF_BASE_CUSTOMERS = 5000;
+static constexpr unsigned PERF_INPUT_SEED     = 20240601u;
+static constexpr unsigned PERF_PAY_SEED       = 7u;
+
+struct top_perf_full_system : public Coupled {
+    top_perf_full_system(const std::string& id, const std::string& input) : Coupled(id) {
+        auto in_reader = addComponent<cadmium::lib::IEStream<CustomerData>>("cust_reader", input.c_str());
+        auto store     = addComponent<grocery_store_test>("store_test", PERF_PAY_SEED);
+        addCoupling(in_reader->out, store->in_customer);
+    }
+};
+
+// The same customers on every machine: only raw mt19937 output is used,
+// because the standard distributions are implementation-defined.
+static std::string writeInput(int customers) {
+    const auto path = std::filesystem::temp_directory_path()
+                    / ("grocery_perf_" + std::to_string(customers) + ".txt");
+    std::ofstream out(path);
+    std::mt19937 rng(PERF_INPUT_SEED);
+    long t = 0;
+    for (int id = 0; id < customers; ++id) {
+        t += 1 + rng() % 40;                          // ~20 s between arrivals
+        const int  items  = 1 + rng() % 40;
+        const bool online = rng() % 10 < 3;
+        const bool card   = rng() % 10 < 7;
+        const int  travel = 60 + rng() % 540;
+        const int  search = online ? static_cast<int>(rng() % 300) : 0;
+        out << t << " " << id << " " << items << " " << (online ? 1 : 0) << " "
+            << (card ? "card" : "cash") << " " << travel << " " << search << "\n";
+    }
+    if (!out) throw std::runtime_error("cannot write " + path.string());
+    return path.string();
+}
+
+struct PerfResult {
+    long   cycles = 0;
+    double seconds = 0.0;
+};
+
+// CPU time of this process: unlike wall time, it does not count the time
+// other processes on a shared machine hold the core.
+static double cpuSeconds() {
+    timespec ts {};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static PerfResult runOnce(const std::string& input) {
+    auto top = std::make_shared<top_perf_full_system>("perf_full_system", input);
+    cadmium::RootCoordinator root(top);
+    const auto coordinator = root.getTopCoordinator();
+
+    PerfResult r;
+    const double started = cpuSeconds();
+    root.start();
+    while (coordinator->getTimeNext() < std::numeric_limits<double>::infinity()) {
+        root.simulate(1L);
+        ++r.cycles;
+    }
+    root.stop();
+    r.seconds = cpuSeconds() - started;
+    return r;
+}
+
+static long peakRssKb() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;   // kilobytes on Linux
+}
+
+static std::string hostName() {
+    char buf[256] = {};
+    if (gethostname(buf, sizeof(buf) - 1) != 0 || buf[0] == '\0') return "unknown";
+    return buf;
+}
+
+// One line per host and scale: host scale customers cycles_per_sec peak_rss_kb
+struct Baseline {
+    std::string host;
+    int    scale = 0;
+    int    customers = 0;
+    double cyclesPerSec = 0.0;
+    long   peakRssKb = 0;
+};
+
+static std::vector<Baseline> readBaselines(const std::string& path) {
+    std::vector<Baseline> all;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        Baseline b;
+        if (fields >> b.host >> b.scale >> b.customers >> b.cyclesPerSec >> b.peakRssKb) all.push_back(b);
+    }
+    return all;
+}
+
+static void writeBaselines(const std::string& path, const std::vector<Baseline>& all) {
+    std::ofstream out(path);
+    out << "# perf_full_system baselines, one line per host and scale (-O2 build).\n"
+        << "# Baselines are per host: a line is only compared on the host whose name it\n"
+        << "# carries, and a host without lines is only reported on. Record this host's\n"
+        << "# with `perf_full_system --scale N --baselines test/perf_baselines.txt --update`.\n"
+        << "# host scale customers cycles_per_sec peak_rss_kb\n";
+    for (const auto& b : all) {
+        out << b.host << " " << b.scale << " " << b.customers << " "
+            << std::fixed << std::setprecision(0) << b.cyclesPerSec << " " << b.peakRssKb << "\n";
+    }
+    if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+int main(int argc, char** argv) {
+    int    scale = 1;
+    int    repeat = 5;
+    double tolerance = 0.20;
+    double rssTolerance = 0.25;
+    bool   update = false;
+    std::string baselinePath = "perf_baselines.txt";
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc)              scale = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--repeat" && i + 1 < argc)        repeat = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--tolerance" && i + 1 < argc)     tolerance = std::stod(argv[++i]);
+        else if (arg == "--rss-tolerance" && i + 1 < argc) rssTolerance = std::stod(argv[++i]);
+        else if (arg == "--baselines" && i + 1 < argc)     baselinePath = argv[++i];
+        else if (arg == "--update")                        update = true;
+        else {
+            std::cerr << "usage: perf_full_system --scale N [--baselines FILE] [--update] [--repeat R]\n"
+                         "                        [--tolerance F] [--rss-tolerance F]\n";
+            return 2;
+        }
+    }
+
+    try {
+        const int customers = scale * PERF_BASE_CUSTOMERS;
+        const std::string input = writeInput(customers);
+
+        auto measure = [&]() {
+            PerfResult best;
+            for (int r = 0; r < repeat; ++r) {
+                const PerfResult run = runOnce(input);
+                if (r == 0 || run.seconds < best.seconds) best = run;
+            }
+            return best;
+        };
+        PerfResult best = measure();
+
+        double rate = best.cycles / std::max(1e-9, best.seconds);
+        const long   rss  = peakRssKb();
+        const std::string host = hostName();
+        std::cout << "=== Full System Perf: scale " << scale << " (" << customers << " customers) ===\n"
+                  << std::fixed << std::setprecision(0)
+                  << best.cycles << " cycles in " << std::setprecision(3) << best.seconds << " s: "
+                  << std::setprecision(0) << rate << " cycles/s, peak RSS " << rss << " KB\n";
+
+        std::vector<Baseline> all = readBaselines(baselinePath);
+        auto done = [&](int status) {
+            std::filesystem::remove(input);
+            return status;
+        };
+        auto it = std::find_if(all.begin(), all.end(), [&](const Baseline& b) {
+            return b.host == host && b.scale == scale;
+        });
+
+        if (update) {
+            const Baseline now{host, scale, customers, rate, rss};
+            if (it != all.end()) *it = now;
+            else                 all.push_back(now);
+            writeBaselines(baselinePath, all);
+            std::cout << "baseline for " << host << " recorded in " << baselinePath << "\n";
+            return done(0);
+        }
+        if (it == all.end()) {
+            std::cout << "no baseline for " << host << " at scale " << scale
+                      << " (record one with --update); not checked\n";
+            return done(0);
+        }
+        if (it->customers != customers) {
+            std::cout << "baseline was recorded with " << it->customers << " customers; not checked\n";
+            return done(0);
+        }
+
+        bool ok = true;
+        std::cout << "baseline " << it->cyclesPerSec << " cycles/s, " << it->peakRssKb << " KB\n";
+        // A slow spell on a shared machine can last a whole measurement, so a
+        // drop must show up again in a second measurement before it fails.
+        if (1.0 - rate / it->cyclesPerSec > tolerance) {
+            const PerfResult again = measure();
+            const double retry = again.cycles / std::max(1e-9, again.seconds);
+            std::cout << "re-measured: " << std::setprecision(0) << retry << " cycles/s\n";
+            rate = std::max(rate, retry);
+        }
+        const double drop = 1.0 - rate / it->cyclesPerSec;
+        if (drop > tolerance) {
+            std::cout << "FAIL: throughput " << std::setprecision(1) << 100.0 * drop
+                      << "% below baseline (tolerance " << 100.0 * tolerance << "%)\n";
+            ok = false;
+        }
+        const double growth = static_cast<double>(rss) / it->peakRssKb - 1.0;
+        if (growth > rssTolerance) {
+            std::cout << "FAIL: peak RSS " << std::setprecision(1) << 100.0 * growth
+                      << "% above baseline (tolerance " << 100.0 * rssTolerance << "%)\n";
+            ok = false;
+        }
+        if (ok) std::cout << "PASS\n";
+        return done(ok ? 0 : 1);
+    } catch (const std::exception& ex) {
+        std::cerr << "perf_full_system: " << ex.what() << "\n";
+        return 2;
+    }
+}
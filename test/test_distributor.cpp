@@ -20,7 +20,8 @@ struct top_test_distributor : public Coupled {
     Port<bool>         out_hold_test;
     Port<bool>         out_ok_test;
 
-    top_test_distributor(const std::string& id) : Coupled(id) {
+    top_test_distributor(const std::string& id, const std::string& customers, const std::string& laneFreed)
+        : Coupled(id) {
         out_cash0_test = addOutPort<CustomerData>("out_cash0_test");
         out_cash1_test = addOutPort<CustomerData>("out_cash1_test");
         out_cash2_test = addOutPort<CustomerData>("out_cash2_test");
@@ -32,10 +33,10 @@ struct top_test_distributor : public Coupled {
         out_ok_test    = addOutPort<bool>("out_ok_test");
 
         auto cust_reader = addComponent<cadmium::lib::IEStream<CustomerData>>(
-            "cust_reader", "input_data/distributor_customers.txt"
+            "cust_reader", customers.c_str()
         );
         auto lane_reader = addComponent<cadmium::lib::IEStream<int>>(
-            "lane_reader", "input_data/distributor_lane_freed.txt"
+            "lane_reader", laneFreed.c_str()
         );
 
         auto dist = addComponent<Distributor>("distributor");
@@ -43,11 +44,11 @@ struct top_test_distributor : public Coupled {
         addCoupling(cust_reader->out, dist->in_customer);
         addCoupling(lane_reader->out, dist->in_laneFreed);
 
-        addCoupling(dist->out_cash0, out_cash0_test);
-        addCoupling(dist->out_cash1, out_cash1_test);
-        addCoupling(dist->out_cash2, out_cash2_test);
-        addCoupling(dist->out_self0, out_self0_test);
-        addCoupling(dist->out_self1, out_self1_test);
+        addCoupling(dist->out_lanes[0], out_cash0_test);
+        addCoupling(dist->out_lanes[1], out_cash1_test);
+        addCoupling(dist->out_lanes[2], out_cash2_test);
+        addCoupling(dist->out_lanes[3], out_self0_test);
+        addCoupling(dist->out_lanes[4], out_self1_test);
         addCoupling(dist->out_online, out_online_test);
         addCoupling(dist->out_whichLane, out_lane_test);
         addCoupling(dist->out_holdOff, out_hold_test);
@@ -57,11 +58,32 @@ struct top_test_distributor : public Coupled {
 
 int main() {
     std::cout << "=== Distributor Test: Routing + Lane Freed ===\n";
-    auto sys = std::make_shared<top_test_distributor>("test_distributor");
-    auto rc  = cadmium::RootCoordinator(sys);
+    {
+        auto sys = std::make_shared<top_test_distributor>("test_distributor", "input_data/distributor_customers.txt",
+                                                          "input_data/distributor_lane_freed.txt");
+        auto rc  = cadmium::RootCoordinator(sys);
 
-    rc.setLogger<cadmium::STDOUTLogger>();
-    rc.start();
-    rc.simulate(20.0);
-    rc.stop();
+        rc.setLogger<cadmium::STDOUTLogger>();
+        rc.start();
+        rc.simulate(20.0);
+        rc.stop();
+    }
+
+    // 21 walk-ins with 20 items, one per second, then a cash lane frees up
+    // every second from t=30. The 10 lane places fill first; the entry queue
+    // reaches highWater (8) at t=18 (one holdOff), is full at t=21 so the
+    // last walk-in is lost, drains to lowWater (2) at t=37 (one okGo) and is
+    // empty at t=39.
+    std::cout << "=== Distributor Test: Entry Queue Watermarks + Capacity ===\n";
+    {
+        auto sys = std::make_shared<top_test_distributor>("test_distributor_overflow",
+                                                          "input_data/distributor_overflow_customers.txt",
+                                                          "input_data/distributor_overflow_lane_freed.txt");
+        auto rc  = cadmium::RootCoordinator(sys);
+
+        rc.setLogger<cadmium::STDOUTLogger>();
+        rc.start();
+        rc.simulate(60.0);
+        rc.stop();
+    }
 }
@@ -0,0 +1,43 @@
+#include <iostream>
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <cadmium/simulation/root_coordinator.hpp>
+#include <cadmium/simulation/logger/stdout.hpp>
+#include <cadmium/lib/iestream.hpp>
+
+#include "self_checkout_bank.hpp"
+#include "customer_data.hpp"
+
+using namespace cadmium;
+
+// Two kiosks, four customers: 3 and 4 wait in the shared line and take the
+// first kiosk to free up (3 at t=4, 4 at t=10 when both kiosks finish).
+struct top_test_self_checkout_bank : public Coupled {
+    Port<CustomerData> out_to_payment_test;
+    Port<int>          out_free_test;
+
+    top_test_self_checkout_bank(const std::string& id) : Coupled(id) {
+        out_to_payment_test = addOutPort<CustomerData>("out_to_payment_test");
+        out_free_test       = addOutPort<int>("out_free_test");
+
+        auto in_reader = addComponent<cadmium::lib::IEStream<CustomerData>>(
+            "bank_reader", "input_data/self_bank_customers.txt"
+        );
+
+        auto bank = addComponent<SelfCheckoutBank>("selfbank", 3, 2, 1.0);
+
+        addCoupling(in_reader->out, bank->in_customer);
+        addCoupling(bank->out_toPayment, out_to_payment_test);
+        addCoupling(bank->out_free, out_free_test);
+    }
+};
+
+int main() {
+    std::cout << "=== Self-Checkout Bank Test: Two Kiosks, Shared Line ===\n";
+    auto sys = std::make_shared<top_test_self_checkout_bank>("test_self_checkout_bank");
+    auto rc  = cadmium::RootCoordinator(sys);
+
+    rc.setLogger<cadmium::STDOUTLogger>();
+    rc.start();
+    rc.simulate(100.0);
+    rc.stop();
+}
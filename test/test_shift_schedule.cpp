@@ -0,0 +1,62 @@
+#include <iostream>
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <cadmium/simulation/root_coordinator.hpp>
+#include <cadmium/simulation/logger/stdout.hpp>
+#include <cadmium/lib/iestream.hpp>
+
+#include "distributor.hpp"
+#include "shift_schedule.hpp"
+#include "customer_data.hpp"
+
+using namespace cadmium;
+
+// Closes cash0 and self1 at t=0 and cash1 at t=2, reopens cash0 at t=5:
+// customers must only be routed to open lanes, and the distributor state
+// lists the closed ones.
+struct top_test_shift_schedule : public Coupled {
+    Port<CustomerData> out_cash0_test;
+    Port<CustomerData> out_cash1_test;
+    Port<CustomerData> out_cash2_test;
+    Port<CustomerData> out_self0_test;
+    Port<CustomerData> out_self1_test;
+    Port<int>          out_lane_test;
+
+    top_test_shift_schedule(const std::string& id) : Coupled(id) {
+        out_cash0_test = addOutPort<CustomerData>("out_cash0_test");
+        out_cash1_test = addOutPort<CustomerData>("out_cash1_test");
+        out_cash2_test = addOutPort<CustomerData>("out_cash2_test");
+        out_self0_test = addOutPort<CustomerData>("out_self0_test");
+        out_self1_test = addOutPort<CustomerData>("out_self1_test");
+        out_lane_test  = addOutPort<int>("out_lane_test");
+
+        const LaneLayout layout;
+        auto cust_reader = addComponent<cadmium::lib::IEStream<CustomerData>>(
+            "cust_reader", "input_data/shift_customers.txt"
+        );
+        auto shifts = addComponent<ShiftSchedule>(
+            "shifts", loadShiftSchedule("input_data/shift_schedule.txt", layout.cashLanes, layout.selfLanes)
+        );
+        auto dist = addComponent<Distributor>("distributor", layout);
+
+        addCoupling(cust_reader->out, dist->in_customer);
+        addCoupling(shifts->out_lane, dist->in_shift);
+
+        addCoupling(dist->out_lanes[0], out_cash0_test);
+        addCoupling(dist->out_lanes[1], out_cash1_test);
+        addCoupling(dist->out_lanes[2], out_cash2_test);
+        addCoupling(dist->out_lanes[3], out_self0_test);
+        addCoupling(dist->out_lanes[4], out_self1_test);
+        addCoupling(dist->out_whichLane, out_lane_test);
+    }
+};
+
+int main() {
+    std::cout << "=== Shift Schedule Test: Lanes Closing and Reopening ===\n";
+    auto sys = std::make_shared<top_test_shift_schedule>("test_shift_schedule");
+    auto rc  = cadmium::RootCoordinator(sys);
+
+    rc.setLogger<cadmium::STDOUTLogger>();
+    rc.start();
+    rc.simulate(10.0);
+    rc.stop();
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "grocery_store.hpp"
+#include "store_snapshot.hpp"
+
+using namespace cadmium;
+
+// Forks a store running the weekday roster (input_data/shift_roster.txt) at
+// t=5400, halfway between its 3600 and 10800 changes, and runs the fork and
+// the original on to t=14400. The fork must resume the roster where the
+// original is (cash2 open, two terminals, next change at 10800), and both
+// must finish the same customers. Restoring into a store without a schedule
+// must throw.
+
+static void printStore(const char* name, const grocery_store& store) {
+    const ShiftScheduleState& shifts = store.shifts->getState();
+    std::cout << name << ": roster next=" << shifts.next << " sigma=" << shifts.sigma
+              << " terminals=" << store.pay->getState().terminals
+              << " cash2=" << (store.dist->getState().open.test(2) ? "open" : "closed")
+              << " walkin=" << store.sink_walkin->getState().count
+              << " online=" << store.sink_online->getState().count << "\n";
+}
+
+int main() {
+    std::cout << "=== Snapshot Fork Test: Resuming a Shift Schedule ===\n";
+    const double forkAt = 5400.0;
+    const double until  = 14400.0;
+
+    StoreConfig cfg;
+    cfg.seed     = 11u;
+    cfg.schedule = "input_data/shift_roster.txt";
+
+    auto clock    = std::make_shared<TransitionClockLogger::Clock>();
+    auto original = std::make_shared<grocery_store>("grocery_store_original", cfg);
+    RootCoordinator root(original);
+    root.setLogger<TransitionClockLogger>(clock);
+    root.start();
+    root.simulate(forkAt);
+    const StoreSnapshot snap = takeSnapshot(*original, *clock, forkAt);
+    printStore("original at fork", *original);
+
+    auto fork = std::make_shared<grocery_store>("grocery_store_fork", cfg);
+    restoreSnapshot(*fork, snap);
+    printStore("fork at fork    ", *fork);
+
+    root.simulate(until - forkAt);
+    root.stop();
+
+    RootCoordinator forkRoot(fork, snap.time);
+    forkRoot.start();
+    forkRoot.simulate(until - forkAt);
+    forkRoot.stop();
+
+    printStore("original at end ", *original);
+    printStore("fork at end     ", *fork);
+
+    bool ok = fork->shifts->getState().next == original->shifts->getState().next
+           && fork->pay->getState().terminals == original->pay->getState().terminals
+           && fork->dist->getState().open.test(2) == original->dist->getState().open.test(2)
+           && fork->sink_walkin->getState().count == original->sink_walkin->getState().count
+           && fork->sink_online->getState().count == original->sink_online->getState().count;
+
+    StoreConfig unscheduled = cfg;
+    unscheduled.schedule.clear();
+    auto plain = std::make_shared<grocery_store>("grocery_store_plain", unscheduled);
+    try {
+        restoreSnapshot(*plain, snap);
+        std::cout << "restore into a store without a schedule: accepted\n";
+        ok = false;
+    } catch (const std::invalid_argument& ex) {
+        std::cout << "restore into a store without a schedule: " << ex.what() << "\n";
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": fork resumes the roster\n";
+    return ok ? 0 : 1;
+}
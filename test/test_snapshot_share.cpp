@@ -0,0 +1,148 @@
+#include <iostream>
+#include <memory>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "grocery_store.hpp"
+#include "store_snapshot.hpp"
+
+using namespace cadmium;
+
+// Snapshots an overloaded store at t=3600, when about 190 customers wait
+// in its queues and some renege from them, and restores it into three forks.
+// The snapshot's queues must be frozen, and a freshly restored fork must
+// read all of its waiting customers from the shared blocks. A fork run for
+// 60 s may only own the customers who joined since. Two forks run to
+// t=7200 must finish exactly like the original store, reneging included,
+// and the snapshot must be unchanged afterwards.
+
+struct QueueCount {
+    size_t waiting = 0;
+    size_t shared  = 0;
+};
+
+template <typename Q>
+static void add(QueueCount& c, const Q& q) {
+    c.waiting += q.size();
+    c.shared  += q.sharedCount();
+}
+
+static QueueCount count(const DistributorState& dist, const std::vector<CashState>& lanes,
+                        const PaymentProcessorState& pay, const PackerState& packer,
+                        const CurbsideDispatcherState& curbside) {
+    QueueCount c;
+    add(c, dist.entry);
+    for (const CashState& lane : lanes) add(c, lane.q);
+    add(c, pay.q);
+    add(c, packer.q);
+    add(c, curbside.q);
+    return c;
+}
+
+static QueueCount count(const StoreSnapshot& snap) {
+    return count(snap.dist, snap.lanes, snap.pay, snap.packer, snap.curbside);
+}
+
+static QueueCount count(const grocery_store& store) {
+    std::vector<CashState> lanes;
+    for (const auto& lane : store.lanes) lanes.push_back(lane->getState());
+    return count(store.dist->getState(), lanes, store.pay->getState(),
+                 store.pickup->packer->getState(), store.pickup->curbside->getState());
+}
+
+struct Outcome {
+    int    walkin = 0, online = 0;
+    double walkinSojourn = 0.0;
+    long   renegedEntry = 0, renegedPayment = 0, renegedCurbside = 0;
+
+    bool operator==(const Outcome& o) const {
+        return walkin == o.walkin && online == o.online && walkinSojourn == o.walkinSojourn
+            && renegedEntry == o.renegedEntry && renegedPayment == o.renegedPayment
+            && renegedCurbside == o.renegedCurbside;
+    }
+};
+
+static Outcome outcome(const char* name, const grocery_store& store) {
+    Outcome o;
+    o.walkin          = store.sink_walkin->getState().count;
+    o.online          = store.sink_online->getState().count;
+    o.walkinSojourn   = store.sink_walkin->getState().totalSojourn;
+    o.renegedEntry    = store.dist->getState().reneged;
+    o.renegedPayment  = store.pay->getState().reneged;
+    o.renegedCurbside = store.pickup->curbside->getState().reneged;
+    std::cout << name << ": walkin=" << o.walkin << " online=" << o.online
+              << " sojourn sum=" << o.walkinSojourn << " reneged entry=" << o.renegedEntry
+              << " payment=" << o.renegedPayment << " curbside=" << o.renegedCurbside << "\n";
+    return o;
+}
+
+static std::shared_ptr<grocery_store> fork(const char* id, const StoreConfig& cfg, const StoreSnapshot& snap) {
+    auto store = std::make_shared<grocery_store>(id, cfg);
+    restoreSnapshot(*store, snap);
+    return store;
+}
+
+static void run(const std::shared_ptr<grocery_store>& store, double from, double seconds) {
+    RootCoordinator root(store, from);
+    root.start();
+    root.simulate(seconds);
+    root.stop();
+}
+
+int main() {
+    std::cout << "=== Snapshot Share Test: Forks Share the Waiting Customers ===\n";
+    const double forkAt = 3600.0;
+    const double until  = 7200.0;
+
+    StoreConfig cfg;
+    cfg.seed            = 5u;
+    cfg.arrivalMean     = 8.0;
+    cfg.cashTimePerItem = 6.0;
+    cfg.selfTimePerItem = 6.0;
+    cfg.payTerminals    = 3;
+    cfg.entryCapacity   = 5000;
+    cfg.entryHighWater  = 4000;
+    cfg.entryLowWater   = 100;
+    cfg.patienceMean    = 1800.0;
+
+    auto clock    = std::make_shared<TransitionClockLogger::Clock>();
+    auto original = std::make_shared<grocery_store>("grocery_store_original", cfg);
+    RootCoordinator root(original);
+    root.setLogger<TransitionClockLogger>(clock);
+    root.start();
+    root.simulate(forkAt);
+    const StoreSnapshot snap = takeSnapshot(*original, *clock, forkAt);
+    root.simulate(until - forkAt);
+    root.stop();
+
+    bool ok = true;
+    const QueueCount atSnap = count(snap);
+    std::cout << "snapshot: " << atSnap.waiting << " waiting, " << atSnap.shared << " in shared blocks\n";
+    ok = ok && atSnap.waiting > 100 && atSnap.shared == atSnap.waiting;
+
+    auto a = fork("grocery_store_fork_a", cfg, snap);
+    auto b = fork("grocery_store_fork_b", cfg, snap);
+    auto c = fork("grocery_store_fork_c", cfg, snap);
+    const QueueCount restored = count(*a);
+    std::cout << "fork a restored: " << restored.waiting << " waiting, " << restored.shared << " shared\n";
+    ok = ok && restored.waiting == atSnap.waiting && restored.shared == restored.waiting;
+
+    run(c, snap.time, 60.0);
+    const QueueCount minute = count(*c);
+    std::cout << "fork c after 60 s: " << minute.waiting << " waiting, "
+              << minute.waiting - minute.shared << " owned\n";
+    ok = ok && minute.waiting - minute.shared < 100;
+
+    run(a, snap.time, until - forkAt);
+    run(b, snap.time, until - forkAt);
+    const Outcome o  = outcome("original", *original);
+    const Outcome oa = outcome("fork a  ", *a);
+    const Outcome ob = outcome("fork b  ", *b);
+    ok = ok && oa == o && ob == o && o.renegedEntry + o.renegedPayment + o.renegedCurbside > 0;
+
+    const QueueCount after = count(snap);
+    std::cout << "snapshot after the forks: " << after.waiting << " waiting, " << after.shared << " shared\n";
+    ok = ok && after.waiting == atSnap.waiting && after.shared == atSnap.shared;
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": forks share the snapshot's queues\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <string>
+
+#include "column_file.hpp"
+
+// Dumps a column file (grocery_sim --sample FILE) as CSV, one row per sample:
+//   columns_to_csv FILE [--columns]
+// --columns lists the column names and types only.
+int main(int argc, char** argv) {
+    std::string path;
+    bool listOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--columns")                 listOnly = true;
+        else if (!arg.empty() && arg[0] != '-') path = arg;
+        else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "usage: columns_to_csv FILE [--columns]\n";
+        return 1;
+    }
+
+    try {
+        const ColumnFile file = ColumnFile::read(path);
+        if (listOnly) {
+            for (const auto& c : file.columns) {
+                std::cout << c.name << " " << (c.type == ColumnType::INT32 ? "int32" : "float64") << "\n";
+            }
+            std::cerr << file.rows() << " rows\n";
+            return 0;
+        }
+
+        for (size_t i = 0; i < file.columns.size(); ++i) {
+            std::cout << file.columns[i].name << (i + 1 < file.columns.size() ? "," : "\n");
+        }
+        std::cout.precision(10);
+        for (size_t r = 0; r < file.rows(); ++r) {
+            for (size_t i = 0; i < file.columns.size(); ++i) {
+                std::cout << file.values[i][r] << (i + 1 < file.columns.size() ? "," : "\n");
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "columns_to_csv: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
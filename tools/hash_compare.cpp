@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "hashing_logger.hpp"
+
+// Compares two event-hash checkpoint files (grocery_sim --hash FILE):
+//   hash_compare A B
+// Checkpoints hash the whole prefix of the run, so once two runs diverge every
+// later checkpoint differs too; a binary search finds the first divergent
+// interval. Re-run both sides with --hash-window FROM UNTIL on that interval to
+// get the events there as text. Exit status: 0 identical, 1 diverged, 2 error.
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: hash_compare A B\n";
+        return 2;
+    }
+
+    try {
+        double everyA = 0.0, everyB = 0.0;
+        const std::vector<HashCheckpoint> a = readHashCheckpoints(argv[1], &everyA);
+        const std::vector<HashCheckpoint> b = readHashCheckpoints(argv[2], &everyB);
+        if (everyA != everyB) {
+            std::cerr << "hash_compare: checkpoint intervals differ (" << everyA << " vs " << everyB << ")\n";
+            return 2;
+        }
+
+        // Compare the periodic checkpoints both runs reached, then the finals
+        auto periodic = [](const std::vector<HashCheckpoint>& v) {
+            return static_cast<size_t>(std::count_if(v.begin(), v.end(),
+                                                     [](const HashCheckpoint& c) { return !c.final; }));
+        };
+        const size_t n = std::min(periodic(a), periodic(b));
+        auto same = [&](size_t i) { return a[i].hash == b[i].hash && a[i].events == b[i].events; };
+
+        // First i in [0, n) with !same(i); the prefix property makes this monotone
+        size_t lo = 0, hi = n;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (same(mid)) lo = mid + 1;
+            else           hi = mid;
+        }
+
+        if (lo < n) {
+            const double from = (lo == 0) ? 0.0 : a[lo - 1].time;
+            const long eventsA = a[lo].events - (lo == 0 ? 0 : a[lo - 1].events);
+            const long eventsB = b[lo].events - (lo == 0 ? 0 : b[lo - 1].events);
+            std::cout << "diverged in [" << from << ", " << a[lo].time << "): "
+                      << eventsA << " vs " << eventsB << " events in that interval\n"
+                      << "  (re-run both with --hash-window " << from << " " << a[lo].time
+                      << " and diff the .events files)\n";
+            return 1;
+        }
+
+        const HashCheckpoint* finalA = a.empty() || !a.back().final ? nullptr : &a.back();
+        const HashCheckpoint* finalB = b.empty() || !b.back().final ? nullptr : &b.back();
+        if (!finalA || !finalB) {
+            std::cerr << "hash_compare: missing final checkpoint (run did not stop cleanly)\n";
+            return 2;
+        }
+        if (finalA->hash != finalB->hash || finalA->events != finalB->events) {
+            const double from = (n == 0) ? 0.0 : a[n - 1].time;
+            std::cout << "diverged after t=" << from << ": runs end at " << finalA->time << " ("
+                      << finalA->events << " events) vs " << finalB->time << " ("
+                      << finalB->events << " events)\n";
+            return 1;
+        }
+
+        std::cout << "identical: " << finalA->events << " events, " << n << " checkpoints, hash "
+                  << finalA->hash << "\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "hash_compare: " << ex.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,473 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "worker_pool.hpp"
+
+// Summarises a Cadmium CSV state log (time,model_id,model_name,port_name,data):
+//   log_analyze LOG [--threads N] [--series FILE] [--bucket SECONDS]
+// The log is memory-mapped and split into line-aligned chunks that are parsed
+// in parallel straight out of the mapping; nothing is allocated per line.
+// Prints per-model line counts, sink throughput, payment queue statistics and
+// time-weighted lane queues (from the Distributor's q:[...]). --series writes
+// the lane queues as a CSV of per-bucket time averages.
+
+namespace {
+
+constexpr size_t MAX_LANES = 64;
+
+// ---- Payload parsing ----
+// State payloads look like {phase:busy,sigma:12,queued:3,q:[1,0,2]}.
+
+bool parseDouble(std::string_view s, double& out) {
+    if (s.empty()) return false;
+    if (s == "inf") {
+        out = std::numeric_limits<double>::infinity();
+        return true;
+    }
+    const auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+    return r.ec == std::errc();
+}
+
+// The value of `key` in a {k:v,...} payload, up to the next ',' or '}'.
+std::string_view field(std::string_view data, std::string_view key) {
+    size_t pos = 0;
+    while ((pos = data.find(key, pos)) != std::string_view::npos) {
+        const size_t colon = pos + key.size();
+        const bool atKey = (pos > 0 && (data[pos - 1] == '{' || data[pos - 1] == ','));
+        if (atKey && colon < data.size() && data[colon] == ':') {
+            const size_t end = data.find_first_of(",}", colon + 1);
+            return data.substr(colon + 1, (end == std::string_view::npos ? data.size() : end) - colon - 1);
+        }
+        pos = colon;
+    }
+    return {};
+}
+
+// The integers of q:[a,b,...]; returns how many were read.
+size_t parseLanes(std::string_view data, std::array<double, MAX_LANES>& out) {
+    const size_t open = data.find("q:[");
+    if (open == std::string_view::npos) return 0;
+    const char* p   = data.data() + open + 3;
+    const char* end = data.data() + data.size();
+    size_t n = 0;
+    while (p < end && *p != ']' && n < MAX_LANES) {
+        long v = 0;
+        const auto r = std::from_chars(p, end, v);
+        if (r.ec != std::errc()) break;
+        out[n++] = static_cast<double>(v);
+        p = r.ptr;
+        if (p < end && *p == ',') ++p;
+    }
+    return n;
+}
+
+// ---- Piecewise-constant levels ----
+// Each chunk integrates the levels it saw; merging two consecutive chunks adds
+// the gap from the first chunk's last value to the second chunk's first time.
+struct LevelSeries {
+    bool   any   = false;
+    double first = 0.0;        // time of the first value
+    double last  = 0.0;        // time of the last value
+    double value = 0.0;        // last value
+    double area  = 0.0;        // integral over [first, last]
+    double max   = 0.0;
+    long   samples = 0;
+
+    void add(double t, double v) {
+        if (!any) {
+            any = true;
+            first = t;
+        } else if (t >= last) {
+            area += value * (t - last);
+        }   // a restarted run (time went back) just continues from here
+        last  = t;
+        value = v;
+        max   = std::max(max, v);
+        ++samples;
+    }
+
+    void merge(const LevelSeries& next) {
+        if (!next.any) return;
+        if (!any) {
+            *this = next;
+            return;
+        }
+        if (next.first >= last) area += value * (next.first - last);
+        area   += next.area;
+        last    = next.last;
+        value   = next.value;
+        max     = std::max(max, next.max);
+        samples += next.samples;
+    }
+
+    double mean() const { return (last > first) ? area / (last - first) : value; }
+};
+
+// Lane queue areas per time bucket, for --series.
+struct LaneBuckets {
+    double width = 0.0;
+    size_t lanes = 0;
+    std::vector<double> area;    // bucket * MAX_LANES + lane
+
+    void add(double t0, double t1, const std::array<double, MAX_LANES>& q, size_t n) {
+        if (width <= 0.0 || !(t1 > t0) || t1 == std::numeric_limits<double>::infinity()) return;
+        lanes = std::max(lanes, n);
+        auto b = static_cast<size_t>(t0 / width);
+        while (t0 < t1) {
+            const double edge = std::min(t1, (b + 1) * width);
+            if (area.size() < (b + 1) * MAX_LANES) area.resize((b + 1) * MAX_LANES, 0.0);
+            for (size_t i = 0; i < n; ++i) area[b * MAX_LANES + i] += q[i] * (edge - t0);
+            t0 = edge;
+            ++b;
+        }
+    }
+
+    void merge(const LaneBuckets& other) {
+        lanes = std::max(lanes, other.lanes);
+        if (area.size() < other.area.size()) area.resize(other.area.size(), 0.0);
+        for (size_t i = 0; i < other.area.size(); ++i) area[i] += other.area[i];
+    }
+};
+
+struct ModelCount {
+    std::string_view name;     // points into the mapped log
+    long states  = 0;
+    long outputs = 0;
+};
+
+struct SinkStats {
+    std::string_view name;
+    long   count   = 0;
+    double sojourn = -1.0;     // mean time in store, if the log has it
+};
+
+struct ChunkResult {
+    long   lines   = 0;
+    long   skipped = 0;        // headers, test banners, malformed lines
+    double tFirst  = std::numeric_limits<double>::infinity();
+    double tLast   = -std::numeric_limits<double>::infinity();
+
+    std::vector<ModelCount> models;
+    std::vector<int>        byId;       // model_id -> index into models (cache)
+    std::vector<SinkStats>  sinks;
+
+    LevelSeries payQueued, payBusy;
+    long        payReneged = 0;
+
+    std::array<LevelSeries, MAX_LANES> lane;
+    size_t lanes = 0;
+    // Distributor state at the start and end of the chunk, to join buckets
+    double laneFirstT = 0.0, laneLastT = 0.0;
+    std::array<double, MAX_LANES> laneLast{};
+    size_t laneLastN = 0;
+    LaneBuckets buckets;
+
+    ModelCount& model(long id, std::string_view name) {
+        if (id >= 0 && id < static_cast<long>(byId.size()) && byId[id] >= 0
+            && models[byId[id]].name == name) {
+            return models[byId[id]];
+        }
+        int idx = -1;
+        for (size_t i = 0; i < models.size(); ++i) {
+            if (models[i].name == name) idx = static_cast<int>(i);
+        }
+        if (idx < 0) {
+            idx = static_cast<int>(models.size());
+            models.push_back({name});
+        }
+        if (id >= 0 && id < 4096) {
+            if (static_cast<long>(byId.size()) <= id) byId.resize(id + 1, -1);
+            byId[id] = idx;
+        }
+        return models[idx];
+    }
+
+    SinkStats& sink(std::string_view name) {
+        for (auto& s : sinks) {
+            if (s.name == name) return s;
+        }
+        sinks.push_back({name});
+        return sinks.back();
+    }
+};
+
+struct Options {
+    std::string_view distributor = "distributor";
+    std::string_view payment     = "payment";
+    std::string_view sinkPrefix  = "sink";
+    double bucket = 0.0;           // 0 = no series
+};
+
+// Splits off the next comma-separated field (the last one keeps its commas).
+std::string_view nextField(std::string_view& rest) {
+    const size_t comma = rest.find(',');
+    std::string_view f = rest.substr(0, comma);
+    rest = (comma == std::string_view::npos) ? std::string_view{} : rest.substr(comma + 1);
+    return f;
+}
+
+void parseLine(std::string_view line, const Options& opt, ChunkResult& r) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty() || !(std::isdigit(static_cast<unsigned char>(line[0])) || line[0] == '-')) {
+        ++r.skipped;
+        return;
+    }
+
+    std::string_view rest = line;
+    const std::string_view timeF = nextField(rest);
+    const std::string_view idF   = nextField(rest);
+    const std::string_view name  = nextField(rest);
+    const std::string_view port  = nextField(rest);
+    const std::string_view data  = rest;
+
+    double t = 0.0;
+    long id = -1;
+    if (!parseDouble(timeF, t) || data.empty()) {
+        ++r.skipped;
+        return;
+    }
+    std::from_chars(idF.data(), idF.data() + idF.size(), id);
+
+    ++r.lines;
+    r.tFirst = std::min(r.tFirst, t);
+    r.tLast  = std::max(r.tLast, t);
+
+    ModelCount& m = r.model(id, name);
+    if (!port.empty()) {
+        ++m.outputs;
+        return;
+    }
+    ++m.states;
+    if (data.front() != '{') return;
+
+    if (name == opt.distributor) {
+        std::array<double, MAX_LANES> q;
+        const size_t n = parseLanes(data, q);
+        if (n == 0) return;
+        if (r.laneLastN == 0) r.laneFirstT = t;
+        else                  r.buckets.add(r.laneLastT, t, r.laneLast, r.laneLastN);
+        for (size_t i = 0; i < n; ++i) r.lane[i].add(t, q[i]);
+        r.lanes     = std::max(r.lanes, n);
+        r.laneLast  = q;
+        r.laneLastN = n;
+        r.laneLastT = t;
+    } else if (name == opt.payment) {
+        double queued = 0.0, reneged = 0.0;
+        if (parseDouble(field(data, "queued"), queued)) r.payQueued.add(t, queued);
+        r.payBusy.add(t, field(data, "phase") == "busy" ? 1.0 : 0.0);
+        if (parseDouble(field(data, "reneged"), reneged)) {
+            r.payReneged = std::max(r.payReneged, static_cast<long>(reneged));
+        }
+    } else if (name.substr(0, opt.sinkPrefix.size()) == opt.sinkPrefix) {
+        double count = 0.0, sojourn = 0.0;
+        SinkStats& s = r.sink(name);
+        if (parseDouble(field(data, "count"), count)) s.count = std::max(s.count, static_cast<long>(count));
+        if (parseDouble(field(data, "sojourn"), sojourn)) s.sojourn = sojourn;
+    }
+}
+
+void parseChunk(std::string_view chunk, const Options& opt, ChunkResult& r) {
+    r.buckets.width = opt.bucket;
+    while (!chunk.empty()) {
+        const char* nl = static_cast<const char*>(std::memchr(chunk.data(), '\n', chunk.size()));
+        const size_t len = nl ? static_cast<size_t>(nl - chunk.data()) : chunk.size();
+        parseLine(chunk.substr(0, len), opt, r);
+        chunk.remove_prefix(nl ? len + 1 : len);
+    }
+}
+
+// Folds `next` (the chunk that follows `acc` in the file) into `acc`.
+void mergeChunk(ChunkResult& acc, const ChunkResult& next) {
+    acc.lines   += next.lines;
+    acc.skipped += next.skipped;
+    acc.tFirst = std::min(acc.tFirst, next.tFirst);
+    acc.tLast  = std::max(acc.tLast, next.tLast);
+
+    for (const auto& m : next.models) {
+        ModelCount& into = acc.model(-1, m.name);
+        into.states  += m.states;
+        into.outputs += m.outputs;
+    }
+    for (const auto& s : next.sinks) {
+        SinkStats& into = acc.sink(s.name);
+        into.count = std::max(into.count, s.count);
+        if (s.sojourn >= 0.0) into.sojourn = s.sojourn;
+    }
+
+    acc.payQueued.merge(next.payQueued);
+    acc.payBusy.merge(next.payBusy);
+    acc.payReneged = std::max(acc.payReneged, next.payReneged);
+
+    if (next.laneLastN > 0) {
+        if (acc.laneLastN > 0) acc.buckets.add(acc.laneLastT, next.laneFirstT, acc.laneLast, acc.laneLastN);
+        else                   acc.laneFirstT = next.laneFirstT;
+        acc.laneLast  = next.laneLast;
+        acc.laneLastN = next.laneLastN;
+        acc.laneLastT = next.laneLastT;
+    }
+    for (size_t i = 0; i < next.lanes; ++i) acc.lane[i].merge(next.lane[i]);
+    acc.lanes = std::max(acc.lanes, next.lanes);
+    acc.buckets.merge(next.buckets);
+}
+
+void writeSeries(const std::string& path, const ChunkResult& r, double width) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    out << "time";
+    for (size_t i = 0; i < r.buckets.lanes; ++i) out << ",lane" << i;
+    out << "\n";
+    const size_t nb = r.buckets.area.size() / MAX_LANES;
+    for (size_t b = 0; b < nb; ++b) {
+        out << b * width;
+        for (size_t i = 0; i < r.buckets.lanes; ++i) out << "," << r.buckets.area[b * MAX_LANES + i] / width;
+        out << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path, seriesPath;
+    size_t threads = defaultWorkers();
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)     threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--series" && i + 1 < argc) seriesPath = argv[++i];
+        else if (arg == "--bucket" && i + 1 < argc) opt.bucket = std::stod(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-')     path = arg;
+        else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "usage: log_analyze LOG [--threads N] [--series FILE] [--bucket SECONDS]\n";
+        return 1;
+    }
+    if (!seriesPath.empty() && opt.bucket <= 0.0) opt.bucket = 60.0;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st {};
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::cerr << "log_analyze: cannot open " << path << "\n";
+        return 1;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    const char* base = nullptr;
+    if (size > 0) {
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "log_analyze: cannot map " << path << "\n";
+            ::close(fd);
+            return 1;
+        }
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        base = static_cast<const char*>(p);
+    }
+    const auto started = std::chrono::steady_clock::now();
+
+    // A few chunks per thread so a slow chunk does not hold up the rest;
+    // each boundary is moved forward past the next newline.
+    const std::string_view log(base, size);
+    const size_t wanted = std::max<size_t>(1, std::min(threads * 4, size / (1 << 16) + 1));
+    std::vector<size_t> cuts{0};
+    for (size_t c = 1; c < wanted; ++c) {
+        size_t at = std::max(cuts.back(), size / wanted * c);
+        const size_t nl = log.find('\n', at);
+        at = (nl == std::string_view::npos) ? size : nl + 1;
+        if (at > cuts.back() && at < size) cuts.push_back(at);
+    }
+    cuts.push_back(size);
+
+    std::vector<ChunkResult> chunks(cuts.size() - 1);
+    parallelFor(chunks.size(), threads, [&](size_t c) {
+        parseChunk(log.substr(cuts[c], cuts[c + 1] - cuts[c]), opt, chunks[c]);
+    });
+
+    ChunkResult all;
+    all.buckets.width = opt.bucket;
+    for (const auto& c : chunks) mergeChunk(all, c);
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << path << ": " << size << " bytes, " << all.lines << " lines";
+    if (all.skipped > 0) std::cout << " (" << all.skipped << " skipped)";
+    std::cout << " in " << std::fixed << std::setprecision(3) << secs << " s ("
+              << std::setprecision(0) << (secs > 0.0 ? size / secs / 1e6 : 0.0) << " MB/s, "
+              << threads << " threads, " << chunks.size() << " chunks)\n";
+    if (all.lines == 0) return 0;
+
+    const double span = all.tLast - all.tFirst;
+    std::cout << std::setprecision(3) << "simulated time " << all.tFirst << " .. " << all.tLast << "\n\n";
+
+    std::map<std::string_view, ModelCount> models;    // sorted by name
+    for (const auto& m : all.models) models[m.name] = m;
+    std::cout << std::left << std::setw(20) << "model" << std::right
+              << std::setw(12) << "states" << std::setw(12) << "outputs" << "\n";
+    for (const auto& [name, m] : models) {
+        std::cout << std::left << std::setw(20) << name << std::right
+                  << std::setw(12) << m.states << std::setw(12) << m.outputs << "\n";
+    }
+
+    if (!all.sinks.empty()) {
+        std::cout << "\nsinks (throughput over the logged span)\n";
+        for (const auto& s : all.sinks) {
+            std::cout << "  " << std::left << std::setw(16) << s.name << std::right
+                      << " count " << s.count
+                      << "  " << std::setprecision(2) << (span > 0.0 ? 3600.0 * s.count / span : 0.0) << "/h";
+            if (s.sojourn >= 0.0) std::cout << "  mean sojourn " << std::setprecision(1) << s.sojourn << " s";
+            std::cout << "\n";
+        }
+    }
+
+    if (all.payQueued.any) {
+        std::cout << std::setprecision(3)
+                  << "\npayment queue: mean " << all.payQueued.mean()
+                  << ", max " << all.payQueued.max
+                  << ", busy " << all.payBusy.mean()
+                  << ", reneged " << all.payReneged
+                  << " (" << all.payQueued.samples << " states)\n";
+    }
+
+    if (all.lanes > 0) {
+        std::cout << "\nlane queues (time-weighted mean / max)\n";
+        for (size_t i = 0; i < all.lanes; ++i) {
+            std::cout << "  lane " << std::setw(2) << i << "  " << std::setprecision(3)
+                      << all.lane[i].mean() << " / " << std::setprecision(0) << all.lane[i].max << "\n";
+        }
+    }
+
+    if (!seriesPath.empty()) {
+        try {
+            writeSeries(seriesPath, all, opt.bucket);
+            std::cout << "\nlane queue series (" << std::setprecision(0) << opt.bucket
+                      << " s buckets) written to " << seriesPath << "\n";
+        } catch (const std::exception& ex) {
+            std::cerr << "log_analyze: " << ex.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (base) ::munmap(const_cast<char*>(base), size);
+    ::close(fd);
+    return 0;
+}
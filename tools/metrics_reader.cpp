@@ -0,0 +1,60 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "live_metrics.hpp"
+
+// Samples a running simulation's live metrics (grocery_sim --metrics NAME):
+//   metrics_reader [NAME] [--hz RATE] [--count N]
+// Prints one line per sample with the sim clock, per-lane queue lengths,
+// payment backlog, completions, and walk-in throughput since the last sample.
+int main(int argc, char** argv) {
+    std::string name = "grocery_metrics";
+    double hz = 10.0;
+    long count = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--hz" && i + 1 < argc)         hz = std::stod(argv[++i]);
+        else if (arg == "--count" && i + 1 < argc) count = std::stol(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-')     name = arg;
+        else {
+            std::cerr << "usage: metrics_reader [NAME] [--hz RATE] [--count N]\n";
+            return 1;
+        }
+    }
+
+    try {
+        LiveMetricsReader reader(name);
+        const auto period = std::chrono::duration<double>(1.0 / std::max(0.1, hz));
+        auto next = std::chrono::steady_clock::now();
+
+        LiveMetricsSample prev = reader.sample();
+        for (long n = 0; count < 0 || n < count; ++n) {
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            std::this_thread::sleep_until(next);
+
+            const LiveMetricsSample s = reader.sample();
+            const double dt = s.simTime - prev.simTime;
+            const double rate = (dt > 0.0) ? 60.0 * (s.walkinDone - prev.walkinDone) / dt : 0.0;
+
+            std::cout << "t=" << std::fixed << std::setprecision(1) << s.simTime << " q=[";
+            for (int i = 0; i < s.laneCount; ++i) {
+                std::cout << s.laneQueue[i] << (i + 1 < s.laneCount ? "," : "");
+            }
+            std::cout << "] entry=" << s.entryWaiting
+                      << " lost=" << s.entryLost
+                      << " pay=" << s.paymentQueue
+                      << " walkin=" << s.walkinDone
+                      << " online=" << s.onlineDone
+                      << " walkin/min=" << std::setprecision(2) << rate << std::endl;
+            prev = s;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "metrics_reader: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
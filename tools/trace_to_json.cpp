@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lifecycle_trace.hpp"
+
+// Converts a lifecycle trace (grocery_sim --trace FILE) to Chrome trace JSON,
+// viewable in ui.perfetto.dev or chrome://tracing:
+//   trace_to_json TRACE [OUT.json] [--slowest K]
+// Each simulating thread becomes a process and each traced customer a track,
+// with one slice per stage (queues, checkout lane, payment, travel, packing,
+// pickup) and markers for arrival, reneging, loss and exit. Timestamps are
+// simulated seconds. --slowest K keeps only the K longest journeys.
+
+using CustomerKey = std::pair<uint16_t, int32_t>;   // (thread, customerId)
+
+static std::string sliceName(const TraceRecord& r) {
+    std::string name = traceStageName(static_cast<TraceStage>(r.stage));
+    const auto stage = static_cast<TraceStage>(r.stage);
+    if ((stage == TraceStage::LANE_QUEUE || stage == TraceStage::CHECKOUT) && r.detail >= 0) {
+        name += " lane " + std::to_string(r.detail);
+    } else if (stage == TraceStage::RENEGED && r.detail >= 0) {
+        name += std::string(" from ") + traceStageName(static_cast<TraceStage>(r.detail));
+    }
+    return name;
+}
+
+int main(int argc, char** argv) {
+    std::string in, out;
+    long slowest = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--slowest" && i + 1 < argc)  slowest = std::stol(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-' && in.empty())  in = arg;
+        else if (!arg.empty() && arg[0] != '-' && out.empty()) out = arg;
+        else {
+            in.clear();
+            break;
+        }
+    }
+    if (in.empty()) {
+        std::cerr << "usage: trace_to_json TRACE [OUT.json] [--slowest K]\n";
+        return 1;
+    }
+
+    std::FILE* f = std::fopen(in.c_str(), "rb");
+    if (!f) {
+        std::cerr << "trace_to_json: cannot open " << in << "\n";
+        return 1;
+    }
+    TraceFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, f) != 1 || std::memcmp(header.magic, "GROCTRC1", 8) != 0
+        || header.recordSize != sizeof(TraceRecord)) {
+        std::cerr << "trace_to_json: " << in << " is not a lifecycle trace\n";
+        std::fclose(f);
+        return 1;
+    }
+    std::vector<TraceRecord> records;
+    TraceRecord r;
+    while (std::fread(&r, sizeof(r), 1, f) == 1) records.push_back(r);
+    std::fclose(f);
+
+    // Journey length per customer, for --slowest
+    std::map<CustomerKey, std::pair<double, double>> span;
+    for (const auto& rec : records) {
+        auto [it, fresh] = span.try_emplace({rec.thread, rec.customerId}, rec.time, rec.time);
+        if (!fresh) {
+            it->second.first  = std::min(it->second.first, rec.time);
+            it->second.second = std::max(it->second.second, rec.time);
+        }
+    }
+    std::set<CustomerKey> keep;
+    if (slowest > 0) {
+        std::vector<std::pair<double, CustomerKey>> bySpan;
+        for (const auto& [key, t] : span) bySpan.push_back({t.second - t.first, key});
+        const size_t k = std::min(static_cast<size_t>(slowest), bySpan.size());
+        std::partial_sort(bySpan.begin(), bySpan.begin() + k, bySpan.end(),
+                          [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (size_t i = 0; i < k; ++i) keep.insert(bySpan[i].second);
+    }
+
+    // Each thread's blocks are in event order; a stable sort keeps zero-length
+    // slices (end and begin at the same time) correctly nested.
+    std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        if (a.thread != b.thread) return a.thread < b.thread;
+        if (a.customerId != b.customerId) return a.customerId < b.customerId;
+        return a.time < b.time;
+    });
+
+    std::ofstream file;
+    if (!out.empty()) {
+        file.open(out);
+        if (!file) {
+            std::cerr << "trace_to_json: cannot write " << out << "\n";
+            return 1;
+        }
+    }
+    std::ostream& os = out.empty() ? std::cout : file;
+    os.setf(std::ios::fixed);
+    os.precision(3);
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto emit = [&](const std::string& event) {
+        os << (first ? "" : ",\n") << event;
+        first = false;
+    };
+
+    std::set<uint16_t> threads;
+    CustomerKey named{0, -1};
+    bool anyNamed = false;
+    for (const auto& rec : records) {
+        const CustomerKey key{rec.thread, rec.customerId};
+        if (slowest > 0 && !keep.count(key)) continue;
+
+        const std::string ids = "\"pid\":" + std::to_string(rec.thread) + ",\"tid\":" + std::to_string(rec.customerId);
+        if (threads.insert(rec.thread).second) {
+            emit("{\"name\":\"process_name\",\"ph\":\"M\"," + ids
+                 + ",\"args\":{\"name\":\"run " + std::to_string(rec.thread) + "\"}}");
+        }
+        if (!anyNamed || key != named) {
+            emit("{\"name\":\"thread_name\",\"ph\":\"M\"," + ids
+                 + ",\"args\":{\"name\":\"customer " + std::to_string(rec.customerId) + "\"}}");
+            named = key;
+            anyNamed = true;
+        }
+
+        const auto phase = static_cast<TracePhase>(rec.phase);
+        const char* ph = phase == TracePhase::BEGIN ? "B" : phase == TracePhase::END ? "E" : "i";
+        char ts[64];
+        std::snprintf(ts, sizeof(ts), "%.3f", rec.time * 1e6);   // simulated seconds -> trace microseconds
+        std::string event = "{\"name\":\"" + sliceName(rec) + "\",\"ph\":\"" + ph + "\",\"ts\":" + ts + "," + ids;
+        if (phase == TracePhase::INSTANT) event += ",\"s\":\"t\"";
+        event += "}";
+        emit(event);
+    }
+    os << "\n]}\n";
+
+    std::cerr << "trace_to_json: " << records.size() << " events, " << span.size() << " customers";
+    if (slowest > 0) std::cerr << " (kept " << keep.size() << ")";
+    std::cerr << "\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "store_config.hpp"
+#include "store_run.hpp"
+#include "worker_pool.hpp"
+#include "variance_reduction.hpp"
+
+// Two-configuration comparison with common random numbers:
+//   grocery_compare [--reps R] [--seed S] [--horizon H] [--jobs J]
+//                   [--kpi sojourn|walkin|online] [--base k=v,...] A B
+// e.g.
+//   grocery_compare --reps 20 routing=shortest routing=lwl
+//   grocery_compare --reps 20 base selfTimePerItem=0.6
+// A and B are override lists ("base" for none). The difference B - A of the
+// KPI is estimated three ways from R runs per configuration (independent
+// seeds, common random numbers, CRN with antithetic pairs), and the report
+// shows the variance reduction of each and the runs it needs to match the
+// CI width of R independent runs.
+
+namespace {
+
+struct CompareRun {
+    StoreConfig cfg;
+    RunResult   result;
+    std::string error;
+};
+
+double kpiOf(const RunResult& r, const std::string& kpi) {
+    if (kpi == "walkin") return r.walkinDone;
+    if (kpi == "online") return r.onlineDone;
+    return r.walkinSojourn;
+}
+
+// Runs per configuration for the CI width of `reps` independent runs
+// (at least two, for a variance estimate)
+int runsNeeded(int reps, double factor) {
+    if (factor <= 0.0) return reps;
+    return std::max(2, static_cast<int>(std::ceil(reps / factor)));
+}
+
+StoreConfig variant(const StoreConfig& base, const std::string& overrides, unsigned int seed, bool antithetic) {
+    StoreConfig cfg = base;
+    if (overrides != "base") applyOverrides(cfg, overrides);
+    cfg.seed = seed;
+    cfg.antithetic = antithetic;
+    return cfg;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int reps            = 20;
+    unsigned int seed   = 1;
+    double horizon      = 8 * 3600.0;
+    size_t jobs         = defaultWorkers();
+    std::string kpi     = "sojourn";
+    StoreConfig base;
+    std::vector<std::string> variants;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--reps")         reps    = std::max(2, std::stoi(value()));
+            else if (arg == "--seed")    seed    = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--horizon") horizon = std::stod(value());
+            else if (arg == "--jobs")    jobs    = std::stoul(value());
+            else if (arg == "--kpi")     kpi     = value();
+            else if (arg == "--base")    applyOverrides(base, value());
+            else if (!arg.empty() && arg[0] != '-') variants.push_back(arg);
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        if (kpi != "sojourn" && kpi != "walkin" && kpi != "online") {
+            throw std::invalid_argument("unknown kpi " + kpi);
+        }
+        // Validate both override lists before spending any simulation time
+        for (const auto& v : variants) variant(base, v, 0, false);
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_compare: " << ex.what() << "\n";
+        return 1;
+    }
+    if (variants.size() != 2) {
+        std::cerr << "usage: grocery_compare [--reps R] [--seed S] [--horizon H] [--jobs J]\n"
+                  << "                       [--kpi sojourn|walkin|online] [--base k=v,...] A B\n";
+        return 1;
+    }
+    reps -= reps % 2;   // antithetic pairs
+    const std::string& a = variants[0];
+    const std::string& b = variants[1];
+    const int pairs = reps / 2;
+
+    // Runs, laid out so each method reuses what it can:
+    //   [0, R)        A on seed S+r           (independent and CRN)
+    //   [R, 2R)       B on seed S+r           (CRN)
+    //   [2R, 3R)      B on seed S+R+r         (independent)
+    //   [3R, 3R+R/2)  A on seed S+k, antithetic
+    //   [.., 4R)      B on seed S+k, antithetic
+    std::vector<CompareRun> runs;
+    for (int r = 0; r < reps; ++r) runs.push_back({variant(base, a, seed + r, false), RunResult(), ""});
+    for (int r = 0; r < reps; ++r) runs.push_back({variant(base, b, seed + r, false), RunResult(), ""});
+    for (int r = 0; r < reps; ++r) runs.push_back({variant(base, b, seed + reps + r, false), RunResult(), ""});
+    for (int k = 0; k < pairs; ++k) runs.push_back({variant(base, a, seed + k, true), RunResult(), ""});
+    for (int k = 0; k < pairs; ++k) runs.push_back({variant(base, b, seed + k, true), RunResult(), ""});
+
+    parallelFor(runs.size(), jobs, [&](size_t i) {
+        try {
+            runs[i].result = runStore(runs[i].cfg, horizon);
+        } catch (const std::exception& ex) {
+            runs[i].error = ex.what();
+        }
+    });
+    for (const auto& run : runs) {
+        if (!run.error.empty()) {
+            std::cerr << "grocery_compare: " << run.error << "\n";
+            return 1;
+        }
+    }
+    auto x = [&](size_t i) { return kpiOf(runs[i].result, kpi); };
+
+    std::vector<double> independent, crn, antithetic;
+    for (int r = 0; r < reps; ++r) {
+        independent.push_back(x(2 * reps + r) - x(r));
+        crn.push_back(x(reps + r) - x(r));
+    }
+    for (int k = 0; k < pairs; ++k) {
+        const double plain = x(reps + k) - x(k);
+        const double anti  = x(3 * reps + pairs + k) - x(3 * reps + k);
+        antithetic.push_back(0.5 * (plain + anti));
+    }
+
+    const std::vector<DifferenceEstimate> estimates = {
+        estimateDifference("independent", independent),
+        estimateDifference("crn", crn),
+        estimateDifference("crn+antithetic", antithetic),
+    };
+
+    std::cout << "B - A of " << kpi << ", " << reps << " runs per configuration, horizon "
+              << horizon << " s\n  A: " << a << "\n  B: " << b << "\n\n"
+              << std::left << std::setw(16) << "method" << std::right
+              << std::setw(6) << "obs" << std::setw(12) << "mean" << std::setw(12) << "+/- 95%"
+              << std::setw(12) << "var.red." << std::setw(14) << "runs needed" << "\n";
+    for (const auto& e : estimates) {
+        const double factor = varianceReduction(estimates[0], e);
+        std::cout << std::left << std::setw(16) << e.method << std::right << std::fixed
+                  << std::setw(6) << e.n
+                  << std::setprecision(3) << std::setw(12) << e.mean << std::setw(12) << e.halfWidth
+                  << std::setprecision(2) << std::setw(12) << factor
+                  << std::setw(14) << runsNeeded(reps, factor) << "\n";
+    }
+    std::cout << "(runs needed: per configuration, for the CI width of " << reps << " independent runs)\n";
+    return 0;
+}
@@ -1,19 +1,219 @@
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <cadmium/simulation/root_coordinator.hpp>
 #include <cadmium/simulation/logger/stdout.hpp>
 
 #include "grocery_store.hpp"
+#include "output_analysis.hpp"
+#include "live_metrics.hpp"
+#include "lifecycle_trace.hpp"
+#include "store_sampler.hpp"
+#include "hashing_logger.hpp"
+#include "memory_report.hpp"
+#include "alloc_hooks.hpp"
 
-int main() {
-    auto model = std::make_shared<grocery_store>("grocery_store_simulation");
+// grocery_sim [--fixed SECONDS] [--target REL] [--check EVENTS] [--max SECONDS] [--quiet]
+//             [--metrics NAME] [--base OVERRIDES] [--trace FILE] [--trace-every N]
+//             [--sample FILE] [--sample-every SECONDS] [--sample-fields LIST]
+//             [--hash FILE] [--hash-every SECONDS] [--hash-window FROM UNTIL]
+//             [--record-pickup FILE] [--alloc-report] [--sensitivities]
+//
+// By default the run stops itself: walk-in sojourn times stream from the sink
+// into an OutputAnalyzer, warm-up is truncated with MSER-5, and the run ends
+// once the batch-means 95% CI half-width is within --target of the mean
+// (checked every --check simulation steps, capped at --max seconds).
+// --fixed T restores the old fixed-length run. --metrics NAME publishes live
+// queue lengths and counts to shared memory for tools/metrics_reader.
+// --base takes StoreConfig overrides, e.g. "patienceMean=300,arrivalMean=20".
+// --trace FILE records the journeys of 1 in --trace-every customers (default
+// 100) for tools/trace_to_json.
+// --sample FILE writes the --sample-fields of every model (see
+// store_sampler.hpp) every --sample-every simulated seconds (default 60) to a
+// column file for tools/columns_to_csv.
+// --hash FILE replaces the state log with event-stream hash checkpoints every
+// --hash-every simulated seconds (default 60) for tools/hash_compare;
+// --hash-window also writes the events in [FROM, UNTIL) to FILE.events.
+// --record-pickup FILE records the online orders reaching pickup_system for
+// grocery_replay.
+// --alloc-report charges every heap allocation to the model running at the
+// time (alloc_accounting.hpp) and prints allocations, bytes, peak live bytes
+// and queue high-water marks per model at the end.
+// --sensitivities prints d(mean sojourn)/d(parameter) for every service time
+// parameter, estimated within this run by IPA (ipa_gradient.hpp).
+int main(int argc, char** argv) {
+    double fixed  = 0.0;
+    double target = 0.05;
+    long   check  = 2000;
+    double maxT   = 7.0 * 24.0 * 3600.0;
+    bool   quiet  = false;
+    std::string metricsName;
+    StoreConfig cfg;
+    std::string traceFile;
+    int traceEvery = 100;
+    std::string sampleFile;
+    double sampleEvery = 60.0;
+    std::string sampleFields = DEFAULT_SAMPLE_FIELDS;
+    std::string hashFile;
+    double hashEvery = 60.0;
+    double hashFrom  = std::numeric_limits<double>::infinity();
+    double hashUntil = std::numeric_limits<double>::infinity();
+    std::string recordFile;
+    bool allocReport = false;
+    bool sensitivities = false;
 
-    cadmium::RootCoordinator root(model);
-    root.setLogger<cadmium::STDOUTLogger>();
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--fixed" && i + 1 < argc)       fixed  = std::stod(argv[++i]);
+        else if (arg == "--target" && i + 1 < argc) target = std::stod(argv[++i]);
+        else if (arg == "--check" && i + 1 < argc)  check  = std::stol(argv[++i]);
+        else if (arg == "--max" && i + 1 < argc)    maxT   = std::stod(argv[++i]);
+        else if (arg == "--quiet")                  quiet  = true;
+        else if (arg == "--metrics" && i + 1 < argc) metricsName = argv[++i];
+        else if (arg == "--base" && i + 1 < argc)    applyOverrides(cfg, argv[++i]);
+        else if (arg == "--trace" && i + 1 < argc)   traceFile = argv[++i];
+        else if (arg == "--trace-every" && i + 1 < argc) traceEvery = std::stoi(argv[++i]);
+        else if (arg == "--sample" && i + 1 < argc)  sampleFile = argv[++i];
+        else if (arg == "--sample-every" && i + 1 < argc)  sampleEvery = std::stod(argv[++i]);
+        else if (arg == "--sample-fields" && i + 1 < argc) sampleFields = argv[++i];
+        else if (arg == "--hash" && i + 1 < argc)          hashFile = argv[++i];
+        else if (arg == "--hash-every" && i + 1 < argc)    hashEvery = std::stod(argv[++i]);
+        else if (arg == "--record-pickup" && i + 1 < argc) recordFile = argv[++i];
+        else if (arg == "--alloc-report")                  allocReport = true;
+        else if (arg == "--sensitivities")                 sensitivities = true;
+        else if (arg == "--hash-window" && i + 2 < argc) {
+            hashFrom  = std::stod(argv[++i]);
+            hashUntil = std::stod(argv[++i]);
+        }
+        else {
+            std::cerr << "usage: grocery_sim [--fixed SECONDS] [--target REL] [--check EVENTS] [--max SECONDS] [--quiet]\n"
+                      << "                   [--metrics NAME] [--base OVERRIDES] [--trace FILE] [--trace-every N]\n"
+                      << "                   [--sample FILE] [--sample-every SECONDS] [--sample-fields LIST]\n"
+                      << "                   [--hash FILE] [--hash-every SECONDS] [--hash-window FROM UNTIL]\n"
+                      << "                   [--record-pickup FILE] [--alloc-report] [--sensitivities]\n";
+            return 1;
+        }
+    }
+
+    // Before the models are built, so they are built accounted
+    if (allocReport) AllocAccounting::enable();
+
+    // With --sample the store runs inside sampled_store, next to the sampler
+    std::shared_ptr<Coupled> top;
+    std::shared_ptr<grocery_store> model;
+    std::shared_ptr<StateSampler> sampler;
+    if (!sampleFile.empty()) {
+        auto sampled = std::make_shared<sampled_store>("grocery_store_simulation", cfg,
+                                                       sampleFile, sampleEvery, sampleFields);
+        model   = sampled->store;
+        sampler = sampled->sampler;
+        top     = sampled;
+    } else {
+        model = std::make_shared<grocery_store>("grocery_store_simulation", cfg);
+        top   = model;
+    }
+
+    std::shared_ptr<InputRecorder> recorder;
+    if (!recordFile.empty()) recorder = model->recordPickupInput(recordFile);
+
+    OutputAnalyzer sojourn;
+    model->sink_walkin->setObserver([&sojourn](double t, double x) { sojourn.observe(t, x); });
+
+    std::unique_ptr<LiveMetricsWriter> metrics;
+    if (!metricsName.empty()) {
+        try {
+            metrics = std::make_unique<LiveMetricsWriter>(metricsName);
+        } catch (const std::runtime_error& ex) {
+            std::cerr << "grocery_sim: " << ex.what() << "\n";
+            return 1;
+        }
+        model->publishMetrics(metrics.get());
+    }
+
+    if (!traceFile.empty()) LifecycleTrace::open(traceFile, traceEvery);
+
+    cadmium::RootCoordinator root(top);
+    if (!hashFile.empty())  root.setLogger<HashingLogger>(hashFile, hashEvery, hashFrom, hashUntil);
+    else if (!quiet)        root.setLogger<cadmium::STDOUTLogger>();
 
     root.start();
-    root.simulate(300.0); // seconds of simulated time
+    double elapsed = 0.0;
+    bool   stalled = false;   // auto-stop ran out of events before converging
+    if (fixed > 0.0) {
+        root.simulate(fixed); // seconds of simulated time
+        elapsed = fixed;
+    } else {
+        // Step by event count: simulate(double) measures from the last event,
+        // so a quiet spell longer than the chunk would make no progress. With
+        // no event left (e.g. every lane closed and the Generator held) the
+        // clock cannot move any more.
+        while (model->clock() < maxT && !sojourn.converged(target)) {
+            if (root.getTopCoordinator()->getTimeNext() == std::numeric_limits<double>::infinity()) {
+                stalled = true;
+                break;
+            }
+            root.simulate(check);
+        }
+        elapsed = model->clock();
+    }
     root.stop();
+    if (!traceFile.empty()) LifecycleTrace::close();
+    if (sampler) sampler->flush();
 
+    const BatchMeansEstimate est = sojourn.estimate();
+    const DistributorState& entry = model->dist->getState();
     std::cout << "Grocery store simulation completed." << std::endl;
+    std::cout << "Simulated " << elapsed << " s, " << sojourn.count() << " walk-in customers\n";
+    if (stalled) std::cout << "No events left at t=" << elapsed << ": the run stopped without converging\n";
+    std::cout << "Entry queue: " << entry.entry.size() << " waiting, " << entry.lost << " lost\n";
+    std::cout << "Reneged: entry " << entry.reneged
+              << ", payment " << model->pay->getState().reneged
+              << ", curbside " << model->pickup->curbside->getState().reneged << "\n";
+    if (cfg.fluidEnter > 0.0) {
+        const Distributor::HybridStats h = model->dist->hybrid(elapsed);
+        std::cout << "Hybrid: " << h.episodes << " fluid episodes, " << 100.0 * h.fluidFraction
+                  << "% of the time; " << h.admitted << " walk-ins admitted to the fluid, " << h.handedBack
+                  << " handed back to the lanes, " << h.handedToPayment << " to payment; reneged in fluid: entry " << h.renegedEntry
+                  << ", payment " << h.renegedPayment << "; missed by the traveler " << h.missedTraveler << "\n";
+    }
+    if (est.used > 0) {
+        std::cout << "Warm-up: " << est.truncated << " customers dropped (until t=" << est.warmupEnd << ")"
+                  << (est.warmedUp ? "" : ", steady state not confirmed") << "\n"
+                  << "Mean walk-in sojourn: " << est.mean << " +/- " << est.halfWidth
+                  << " s (95% CI, " << est.used << " customers)\n";
+    } else {
+        std::cout << "Too few customers for a confidence interval\n";
+    }
+
+    const grocery_store::Kpis kpis = model->kpis(elapsed);
+    std::cout << std::fixed << std::setprecision(3) << "Utilisation (mean queue):";
+    for (size_t i = 0; i < kpis.lanes.size(); ++i) {
+        std::cout << (i == 0 ? " lanes " : ", ") << kpis.lanes[i].utilisation
+                  << " (" << kpis.lanes[i].meanQueue << ")";
+    }
+    std::cout << "\n  payment " << kpis.payment.utilisation << " (" << kpis.payment.meanQueue << ")"
+              << ", packing " << kpis.packing.utilisation << " (" << kpis.packing.meanQueue << ")"
+              << ", curbside " << kpis.curbside.utilisation << " (" << kpis.curbside.meanQueue << ")"
+              << ", entry queue " << kpis.distributor.meanEntryQueue << "\n";
+    if (recorder) {
+        const CustomerSinkState& online = model->sink_online->getState();
+        std::cout << std::setprecision(6) << "Recorded " << recorder->recorded() << " pickup orders to "
+                  << recordFile << " (online done " << online.count << ", mean sojourn "
+                  << online.meanSojourn() << " s)\n";
+    }
+    if (sensitivities) {
+        std::cout << "Sensitivity of mean sojourn (IPA, s per unit of the parameter):\n"
+                  << std::left << std::setw(18) << "  parameter" << std::right << std::setw(10) << "nominal"
+                  << std::setw(12) << "walk-in" << std::setw(12) << "online" << "\n";
+        for (const auto& g : model->sensitivities()) {
+            std::cout << "  " << std::left << std::setw(16) << ipaParamName(g.param) << std::right
+                      << std::setprecision(3) << std::setw(10) << g.nominal
+                      << std::setprecision(4) << std::setw(12) << g.walkin() << std::setw(12) << g.online() << "\n";
+        }
+    }
+    if (allocReport) printMemoryReport(std::cout, model->queuePeaks());
     return 0;
 }
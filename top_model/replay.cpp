@@ -0,0 +1,166 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cadmium/modeling/devs/coupled.hpp>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "customer_sink.hpp"
+#include "input_replay.hpp"
+#include "pickup_system.hpp"
+#include "store_config.hpp"
+#include "worker_pool.hpp"
+
+// Pickup-only re-simulation from a recorded input stream:
+//   grocery_replay --input FILE [--horizon S] [--jobs J] [--base k=v,...] [<variant> ...]
+// e.g.
+//   grocery_sim --fixed 14400 --record-pickup pickup.inp
+//   grocery_replay --input pickup.inp --horizon 14400 packers=2 packers=3
+// The online orders grocery_sim recorded at the Distributor are replayed into
+// pickup_system alone, once per variant (on its own thread), so packing
+// parameters can be compared without simulating the lanes that produced the
+// orders. Only pickup settings (packers, packTimePerItem) affect the result,
+// so overrides of any other parameter are rejected.
+
+// Replayed orders -> pickup_system -> sink
+struct replay_pickup : public Coupled {
+    std::shared_ptr<pickup_system> pickup;
+    std::shared_ptr<CustomerSink>  sink;
+
+    replay_pickup(const std::string& id, std::vector<InputRecord> records, const StoreConfig& cfg) : Coupled(id) {
+        auto replayer = addComponent<InputReplayer>("replayer", std::move(records));
+        pickup = addComponent<pickup_system>("pickup", cfg.packTimePerItem, cfg.packers);
+        sink   = addComponent<CustomerSink>("sink_online");
+
+        addCoupling(replayer->out, pickup->in_order);
+        addCoupling(pickup->finished, sink->in);
+    }
+};
+
+// applyOverrides() limited to the parameters pickup_system uses; throws
+// std::invalid_argument for anything else.
+static void applyPickupOverrides(StoreConfig& cfg, const std::string& list) {
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        const std::string key = list.substr(start, list.find('=', start) - start);
+        if (key != "packers" && key != "packTimePerItem") {
+            throw std::invalid_argument("override " + list.substr(start, end - start)
+                                        + " does not affect pickup_system (packers, packTimePerItem)");
+        }
+        start = end + 1;
+    }
+    applyOverrides(cfg, list);
+}
+
+struct ReplayResult {
+    std::string variant;
+    int         onlineDone  = 0;
+    double      meanSojourn = 0.0;
+    StationKpis packing, curbside;
+    std::string error;
+};
+
+static ReplayResult runReplay(const StoreConfig& base, const std::string& variant,
+                              const std::vector<InputRecord>& records, double horizon) {
+    ReplayResult r;
+    r.variant = variant.empty() ? "(base)" : variant;
+    try {
+        StoreConfig cfg = base;
+        applyPickupOverrides(cfg, variant);
+
+        auto model = std::make_shared<replay_pickup>("replay_pickup", records, cfg);
+        cadmium::RootCoordinator root(model);
+        root.start();
+        root.simulate(horizon);
+        root.stop();
+
+        r.onlineDone  = model->sink->getState().count;
+        r.meanSojourn = model->sink->getState().meanSojourn();
+        r.packing     = model->pickup->packer->kpis(horizon);
+        r.curbside    = model->pickup->curbside->kpis(horizon);
+    } catch (const std::exception& ex) {
+        r.error = ex.what();
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::string inputFile;
+    double horizon = -1.0;   // default: the last recorded order
+    size_t jobs    = defaultWorkers();
+    StoreConfig base;
+    std::vector<std::string> variants;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--input")        inputFile = value();
+            else if (arg == "--horizon") horizon   = std::stod(value());
+            else if (arg == "--jobs")    jobs      = std::max(1, std::stoi(value()));
+            else if (arg == "--base")    applyPickupOverrides(base, value());
+            else if (!arg.empty() && arg[0] != '-') {
+                StoreConfig check = base;
+                applyPickupOverrides(check, arg);
+                variants.push_back(arg);
+            }
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_replay: " << ex.what() << "\n";
+        return 1;
+    }
+    if (inputFile.empty()) {
+        std::cerr << "usage: grocery_replay --input FILE [--horizon S] [--jobs J] [--base k=v,...] [<variant> ...]\n"
+                  << "  variant: comma separated pickup overrides, e.g. packers=2\n";
+        return 1;
+    }
+    if (variants.empty()) variants.push_back("");
+
+    std::vector<InputRecord> records;
+    std::string subsystem;
+    try {
+        records = loadInputFile(inputFile, &subsystem);
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_replay: " << ex.what() << "\n";
+        return 1;
+    }
+    if (subsystem != "pickup") {
+        std::cerr << "grocery_replay: " << inputFile << " records '" << subsystem << "', not pickup\n";
+        return 1;
+    }
+    if (horizon < 0.0) horizon = records.empty() ? 0.0 : records.back().time;
+
+    std::cout << "Replaying " << records.size() << " online orders from " << inputFile
+              << " to t=" << horizon << "\n";
+
+    std::vector<ReplayResult> results(variants.size());
+    parallelFor(variants.size(), jobs, [&](size_t i) {
+        results[i] = runReplay(base, variants[i], records, horizon);
+    });
+
+    std::cout << std::left << std::setw(40) << "variant"
+              << std::right << std::setw(10) << "online" << std::setw(14) << "sojourn"
+              << std::setw(10) << "packUtil" << std::setw(10) << "packQ"
+              << std::setw(10) << "curbUtil" << std::setw(10) << "curbQ" << "\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(40) << r.variant;
+        if (!r.error.empty()) {
+            std::cout << "error: " << r.error << "\n";
+            continue;
+        }
+        std::cout << std::right << std::setprecision(6)
+                  << std::setw(10) << r.onlineDone << std::setw(14) << r.meanSojourn
+                  << std::setprecision(3)
+                  << std::setw(10) << r.packing.utilisation << std::setw(10) << r.packing.meanQueue
+                  << std::setw(10) << r.curbside.utilisation << std::setw(10) << r.curbside.meanQueue << "\n";
+    }
+    return 0;
+}
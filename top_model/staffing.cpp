@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "store_config.hpp"
+#include "store_run.hpp"
+#include "sweep_design.hpp"
+#include "result_cache.hpp"
+#include "worker_pool.hpp"
+#include "ranking_selection.hpp"
+
+// Cheapest staffing that meets a checkout time target:
+//   grocery_staff --target S [--tolerance S] [--confidence C] [--cost k=c,...]
+//                 [--initial N] [--max-reps N] [--batch B] [--seed S] [--horizon H]
+//                 [--jobs J] [--cache DIR] [--base k=v,...] --factor name=v1,v2,... ...
+// e.g.
+//   grocery_staff --target 80 --tolerance 2 --base arrivalMean=16
+//                 --factor payTerminals=1,2,3 --factor cashLanes=1,2,3 --factor selfLanes=0,2
+//                 --factor cashTimePerItem=0.8,1.0 --cost cashLanes=25,selfLanes=10,payTerminals=20,cashTimePerItem=-20
+// The candidates are the full grid of the factors; the KPI is the mean walk-in
+// sojourn from store entry to exit. Replications are allocated adaptively
+// (ranking_selection.hpp), replication r of every candidate runs on seed S+r,
+// and runs are shared with grocery_sweep through the result cache.
+
+int main(int argc, char** argv) {
+    SelectionOptions opt;
+    opt.target           = -1.0;
+    unsigned int seed    = 1;
+    double horizon       = 4 * 3600.0;
+    size_t jobs          = defaultWorkers();
+    std::string cacheDir = "sweep_cache";
+    CostModel costModel  = parseCostModel("cashLanes=25,selfLanes=10,packers=18,payTerminals=20");
+    StoreConfig base;
+    std::vector<Factor> factors;
+    opt.batch = std::max<size_t>(8, 2 * jobs);
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--target")          opt.target      = std::stod(value());
+            else if (arg == "--confidence") opt.confidence  = std::stod(value());
+            else if (arg == "--tolerance")  opt.tolerance   = std::max(0.0, std::stod(value()));
+            else if (arg == "--cost")       costModel       = parseCostModel(value());
+            else if (arg == "--initial")    opt.initialReps = std::max(2L, std::stol(value()));
+            else if (arg == "--max-reps")   opt.maxReps     = std::stol(value());
+            else if (arg == "--batch")      opt.batch       = std::max<size_t>(1, std::stoul(value()));
+            else if (arg == "--seed")       seed            = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--horizon")    horizon         = std::stod(value());
+            else if (arg == "--jobs")       jobs            = std::stoul(value());
+            else if (arg == "--cache")      cacheDir        = value();
+            else if (arg == "--base")       applyOverrides(base, value());
+            else if (arg == "--factor")     factors.push_back(parseFactor(value()));
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        if (opt.confidence <= 0.0 || opt.confidence >= 1.0) {
+            throw std::invalid_argument("confidence must be in (0, 1)");
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_staff: " << ex.what() << "\n";
+        return 1;
+    }
+    if (factors.empty() || opt.target < 0.0) {
+        std::cerr << "usage: grocery_staff --target S [--tolerance S] [--confidence C] [--cost k=c,...]\n"
+                  << "                     [--initial N] [--max-reps N] [--batch B] [--seed S] [--horizon H]\n"
+                  << "                     [--jobs J] [--cache DIR] [--base k=v,...] --factor name=v1,v2,... ...\n";
+        return 1;
+    }
+    opt.maxReps = std::max(opt.maxReps, opt.initialReps);
+
+    std::vector<SelectionCandidate> cands;
+    try {
+        for (const auto& point : gridDesign(factors)) {
+            SelectionCandidate c;
+            c.label = toOverrides(point);
+            c.cfg   = base;
+            applyOverrides(c.cfg, c.label);
+            c.cost  = staffingCost(c.cfg, costModel);
+            cands.push_back(std::move(c));
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_staff: " << ex.what() << "\n";
+        return 1;
+    }
+
+    ResultCache cache(cacheDir);
+    SelectionResult result;
+    try {
+        result = selectCheapestFeasible(cands, opt, jobs, [&](size_t i, long rep) {
+            StoreConfig cfg = cands[i].cfg;
+            cfg.seed = seed + static_cast<unsigned int>(rep);
+            const std::string key = ResultCache::key(cands[i].cfg, *cfg.seed, horizon);
+            if (auto hit = cache.find(key)) return hit->walkinSojourn;
+            const RunResult r = runStore(cfg, horizon);
+            cache.store(key, r);
+            return r.walkinSojourn;
+        });
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_staff: " << ex.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "walk-in sojourn <= " << opt.target << " s (tolerance " << opt.tolerance << " s) at "
+              << opt.confidence * 100.0 << "% confidence, horizon " << horizon << " s\n\n"
+              << std::right << std::setw(10) << "cost" << std::setw(7) << "reps"
+              << std::setw(11) << "mean" << std::setw(10) << "+/-" << "  "
+              << std::left << std::setw(12) << "status" << "candidate\n";
+    bool undecidedCheaper = false;
+    for (size_t i = 0; i < cands.size(); ++i) {
+        const SelectionCandidate& c = cands[i];
+        std::cout << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << c.cost << std::setw(7) << c.kpi.n;
+        if (c.kpi.n > 0) std::cout << std::setw(11) << c.kpi.mean;
+        else             std::cout << std::setw(11) << "-";
+        if (c.kpi.n >= opt.initialReps) std::cout << std::setw(10) << c.halfWidth;
+        else                            std::cout << std::setw(10) << "-";
+        std::cout << "  " << std::left << std::setw(12)
+                  << (c.kpi.n == 0 ? "skipped" : feasibilityName(c.status))
+                  << c.label << (i == result.selected ? "  <==" : "") << "\n";
+        if (c.status == Feasibility::UNDECIDED
+            && (result.selected == static_cast<size_t>(-1) || c.cost < cands[result.selected].cost)) {
+            undecidedCheaper = true;
+        }
+    }
+
+    std::cout << "\n" << result.replications << " replications in " << result.rounds << " rounds ("
+              << cands.size() << " candidates x " << opt.maxReps << " = "
+              << cands.size() * static_cast<size_t>(opt.maxReps) << " at the fixed budget)\n";
+    if (result.selected == static_cast<size_t>(-1)) {
+        std::cout << "no candidate meets the target\n";
+        return 2;
+    }
+    const SelectionCandidate& best = cands[result.selected];
+    std::cout << "cheapest meeting the target: " << best.label << " (cost " << best.cost
+              << ", sojourn " << best.kpi.mean << " +/- " << best.halfWidth << " s)\n";
+    if (undecidedCheaper) {
+        std::cout << "note: some cheaper candidates are undecided after " << opt.maxReps
+                  << " replications (raise --max-reps)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "store_config.hpp"
+#include "store_run.hpp"
+#include "sweep_design.hpp"
+#include "result_cache.hpp"
+#include "worker_pool.hpp"
+#include "process_farm.hpp"
+#include "queueing_estimator.hpp"
+
+// Parameter sweep over grocery_store:
+//   grocery_sweep [--design grid|lhs] [--points N] [--reps R] [--seed S]
+//                 [--horizon H] [--jobs J] [--cache DIR] [--out FILE]
+//                 [--screen K] [--procs P] [--task-timeout S]
+//                 [--base k=v,...] --factor name=v1,v2,... | name=lo:hi ...
+// e.g.
+//   grocery_sweep --factor cashLanes=2,3,4 --factor maxQueue=1,2,3 --reps 5
+//   grocery_sweep --design lhs --points 40 --factor selfTimePerItem=0.4:1.2 --factor arrivalMean=20:60
+// Replication r of every point uses seed S+r, so points are compared on the
+// same seeds. Finished runs are cached under DIR, so extending a sweep only
+// simulates the new (point, seed) pairs.
+//
+// --screen K ranks every point with the analytical queueing estimate
+// (queueing_estimator.hpp) by walk-in sojourn and simulates only the best K;
+// the summary then shows how far each estimate was from the simulated mean.
+//
+// --procs P runs the replications in P worker processes instead of threads
+// (process_farm.hpp): a run that crashes or exceeds --task-timeout is retried
+// in a fresh worker, and reported as failed after three attempts.
+//
+// Failed runs are listed on stderr and left out of the table; the exit status
+// is then 1.
+
+struct SweepTask {
+    size_t point;
+    int    rep;
+    StoreConfig cfg;
+    unsigned int seed;
+    RunResult result;
+    bool cached = false;
+    std::string error;
+};
+
+int main(int argc, char** argv) {
+    std::string design  = "grid";
+    size_t points       = 20;
+    int reps            = 3;
+    unsigned int seed   = 1;
+    double horizon      = 3600.0;
+    size_t jobs         = defaultWorkers();
+    std::string cacheDir = "sweep_cache";
+    std::string outPath  = "sweep_results.csv";
+    size_t screen        = 0;
+    size_t procs         = 0;
+    double taskTimeout   = 0.0;
+    StoreConfig base;
+    std::vector<Factor> factors;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--design")       design   = value();
+            else if (arg == "--points")  points   = std::stoul(value());
+            else if (arg == "--reps")    reps     = std::stoi(value());
+            else if (arg == "--seed")    seed     = static_cast<unsigned int>(std::stoul(value()));
+            else if (arg == "--horizon") horizon  = std::stod(value());
+            else if (arg == "--jobs")    jobs     = std::stoul(value());
+            else if (arg == "--cache")   cacheDir = value();
+            else if (arg == "--out")     outPath  = value();
+            else if (arg == "--screen")  screen   = std::stoul(value());
+            else if (arg == "--procs")   procs    = std::stoul(value());
+            else if (arg == "--task-timeout") taskTimeout = std::stod(value());
+            else if (arg == "--base")    applyOverrides(base, value());
+            else if (arg == "--factor")  factors.push_back(parseFactor(value()));
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_sweep: " << ex.what() << "\n";
+        return 1;
+    }
+    if (factors.empty()) {
+        std::cerr << "usage: grocery_sweep [--design grid|lhs] [--points N] [--reps R] [--seed S]\n"
+                  << "                     [--horizon H] [--jobs J] [--cache DIR] [--out FILE]\n"
+                  << "                     [--screen K] [--procs P] [--task-timeout S]\n"
+                  << "                     [--base k=v,...] --factor name=v1,v2|lo:hi ...\n";
+        return 1;
+    }
+
+    std::vector<DesignPoint> design_points;
+    try {
+        design_points = (design == "lhs") ? latinHypercube(factors, points, seed)
+                                          : gridDesign(factors);
+    } catch (const std::exception& ex) {
+        std::cerr << "grocery_sweep: " << ex.what() << "\n";
+        return 1;
+    }
+
+    // Analytical estimate for every point (microseconds each)
+    std::vector<StoreConfig> configs;
+    std::vector<QueueingEstimate> estimates;
+    for (const auto& point : design_points) {
+        StoreConfig cfg = base;
+        applyOverrides(cfg, toOverrides(point));
+        configs.push_back(cfg);
+        estimates.push_back(estimateStore(cfg));
+    }
+
+    // Points to simulate: all of them, or the best `screen` by estimated sojourn
+    std::vector<size_t> selected(design_points.size());
+    for (size_t p = 0; p < selected.size(); ++p) selected[p] = p;
+    if (screen > 0 && screen < selected.size()) {
+        std::stable_sort(selected.begin(), selected.end(), [&](size_t a, size_t b) {
+            return estimates[a].walkinSojourn < estimates[b].walkinSojourn;
+        });
+        selected.resize(screen);
+        std::sort(selected.begin(), selected.end());
+    }
+
+    // One task per (point, replication)
+    std::vector<SweepTask> tasks;
+    for (size_t p : selected) {
+        const StoreConfig& cfg = configs[p];
+        for (int r = 0; r < reps; ++r) {
+            tasks.push_back({p, r, cfg, seed + static_cast<unsigned int>(r), RunResult(), false, ""});
+        }
+    }
+
+    ResultCache cache(cacheDir);
+    FarmReport farm;
+    if (procs > 0) {
+        // Cache hits first; the workers only get the runs still to do
+        std::vector<size_t> todo;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (auto hit = cache.find(ResultCache::key(tasks[i].cfg, tasks[i].seed, horizon))) {
+                tasks[i].result = *hit;
+                tasks[i].cached = true;
+            } else {
+                todo.push_back(i);
+            }
+        }
+        FarmOptions options;
+        options.workers     = procs;
+        options.taskTimeout = taskTimeout;
+        std::vector<RunResult> results;
+        try {
+            farm = processFor(todo.size(), options, [&](size_t k) {
+                StoreConfig cfg = tasks[todo[k]].cfg;
+                cfg.seed = tasks[todo[k]].seed;
+                return runStore(cfg, horizon);
+            }, results);
+        } catch (const std::exception& ex) {
+            std::cerr << "grocery_sweep: " << ex.what() << "\n";
+            return 1;
+        }
+        for (size_t k = 0; k < todo.size(); ++k) {
+            SweepTask& t = tasks[todo[k]];
+            t.error = farm.errors[k];
+            if (!t.error.empty()) continue;
+            t.result = results[k];
+            cache.store(ResultCache::key(t.cfg, t.seed, horizon), t.result);
+        }
+    } else {
+        parallelFor(tasks.size(), jobs, [&](size_t i) {
+            SweepTask& t = tasks[i];
+            const std::string key = ResultCache::key(t.cfg, t.seed, horizon);
+            if (auto hit = cache.find(key)) {
+                t.result = *hit;
+                t.cached = true;
+                return;
+            }
+            try {
+                StoreConfig cfg = t.cfg;
+                cfg.seed = t.seed;
+                t.result = runStore(cfg, horizon);
+                cache.store(key, t.result);
+            } catch (const std::exception& ex) {
+                t.error = ex.what();
+            }
+        });
+    }
+
+    // Results table: one row per replication
+    std::ofstream out(outPath);
+    out << "point";
+    for (const auto& f : factors) out << ',' << f.name;
+    out << ",rep,seed,walkin_done,online_done,walkin_sojourn,online_sojourn,est_walkin_sojourn,cached\n";
+
+    size_t simulated = 0;
+    size_t cached    = 0;
+    size_t failed    = 0;
+    for (const auto& t : tasks) {
+        if (!t.error.empty()) {
+            std::cerr << "point " << t.point << " rep " << t.rep << ": " << t.error << "\n";
+            ++failed;
+            continue;
+        }
+        if (t.cached) ++cached;
+        else          ++simulated;
+        out << t.point;
+        for (const auto& kv : design_points[t.point]) out << ',' << kv.second;
+        out << ',' << t.rep << ',' << t.seed
+            << ',' << t.result.walkinDone << ',' << t.result.onlineDone
+            << ',' << t.result.walkinSojourn << ',' << t.result.onlineSojourn
+            << ',' << estimates[t.point].walkinSojourn
+            << ',' << (t.cached ? 1 : 0) << '\n';
+    }
+
+    // Per-point means on stdout
+    std::cout << std::left << std::setw(48) << "point"
+              << std::right << std::setw(10) << "walkin" << std::setw(10) << "online"
+              << std::setw(12) << "sojourn" << std::setw(12) << "estimate" << std::setw(10) << "error%" << "\n";
+    for (size_t p : selected) {
+        double walkin = 0, online = 0, sojourn = 0;
+        int n = 0;
+        for (const auto& t : tasks) {
+            if (t.point != p || !t.error.empty()) continue;
+            walkin  += t.result.walkinDone;
+            online  += t.result.onlineDone;
+            sojourn += t.result.walkinSojourn;
+            ++n;
+        }
+        if (n == 0) continue;
+        const double estimate = estimates[p].walkinSojourn;
+        const double mean     = sojourn / n;
+        std::cout << std::left << std::setw(48) << toOverrides(design_points[p])
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << walkin / n << std::setw(10) << online / n
+                  << std::setw(12) << mean << std::setw(12) << estimate << std::setw(10);
+        // No walk-in finished: there is nothing to compare the estimate with
+        if (mean > 0.0) std::cout << 100.0 * (estimate - mean) / mean << "\n";
+        else            std::cout << "-" << "\n";
+    }
+    if (selected.size() < design_points.size()) {
+        std::cout << (design_points.size() - selected.size()) << " of " << design_points.size()
+                  << " points screened out by the analytical estimate\n";
+    }
+    std::cout << tasks.size() << " runs, " << simulated << " simulated, "
+              << cached << " from cache, " << failed << " failed -> " << outPath << "\n";
+    if (procs > 0) {
+        std::cout << procs << " worker processes: " << farm.steals << " steals, " << farm.restarts
+                  << " restarted after a crash or timeout, " << farm.failed() << " runs failed\n";
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cadmium/simulation/root_coordinator.hpp>
+
+#include "grocery_store.hpp"
+#include "store_snapshot.hpp"
+#include "worker_pool.hpp"
+
+// What-if comparison from a shared warm-up:
+//   grocery_whatif [--warmup S] [--horizon S] [--jobs J] [--base k=v,...] <variant> [<variant> ...]
+// e.g.
+//   grocery_whatif --warmup 3600 --horizon 1800 maxQueue=2 maxQueue=3 selfTimePerItem=0.6,packers=2
+// The base store (seed 42 unless overridden) is simulated to the warm-up time
+// once; every variant then continues from that snapshot on a worker pool.
+
+struct ForkResult {
+    std::string variant;
+    int walkinDone = 0;
+    int onlineDone = 0;
+    size_t paymentQueued = 0;
+    size_t packingQueued = 0;
+    std::string error;
+};
+
+static ForkResult runFork(const StoreConfig& base,
+                          const std::string& variant,
+                          const std::shared_ptr<const StoreSnapshot>& snap,
+                          double horizon) {
+    ForkResult r;
+    r.variant = variant;
+    try {
+        StoreConfig cfg = base;
+        applyOverrides(cfg, variant);
+
+        auto model = std::make_shared<grocery_store>("grocery_store_fork", cfg);
+        restoreSnapshot(*model, *snap);
+
+        cadmium::RootCoordinator root(model, snap->time);
+        root.start();
+        root.simulate(horizon);
+        root.stop();
+
+        // Report only what happened after the fork
+        r.walkinDone    = model->sink_walkin->getState().count - snap->sinkWalkin.count;
+        r.onlineDone    = model->sink_online->getState().count - snap->sinkOnline.count;
+        r.paymentQueued = model->pay->getState().q.size();
+        r.packingQueued = model->pickup->packer->getState().q.size();
+    } catch (const std::exception& ex) {
+        r.error = ex.what();
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    double warmup  = 3600.0;
+    double horizon = 1800.0;
+    size_t jobs    = defaultWorkers();
+    StoreConfig base;
+    base.seed = 42u;
+    std::vector<std::string> variants;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--warmup" && i + 1 < argc)       warmup = std::stod(argv[++i]);
+        else if (arg == "--horizon" && i + 1 < argc) horizon = std::stod(argv[++i]);
+        else if (arg == "--jobs" && i + 1 < argc)    jobs = std::stoul(argv[++i]);
+        else if (arg == "--base" && i + 1 < argc)    applyOverrides(base, argv[++i]);
+        else variants.push_back(arg);
+    }
+    if (variants.empty()) {
+        std::cerr << "usage: grocery_whatif [--warmup S] [--horizon S] [--jobs J] [--base k=v,...] <variant> ...\n"
+                  << "  variant: comma separated overrides, e.g. maxQueue=3,packers=2\n";
+        return 1;
+    }
+
+    // 1) Warm up once
+    auto clock = std::make_shared<TransitionClockLogger::Clock>();
+    auto warm  = std::make_shared<grocery_store>("grocery_store_warmup", base);
+    cadmium::RootCoordinator root(warm);
+    root.setLogger<TransitionClockLogger>(clock);
+    root.start();
+    root.simulate(warmup);
+    auto snap = std::make_shared<const StoreSnapshot>(takeSnapshot(*warm, *clock, warmup));
+    root.stop();
+
+    std::cout << "Warm-up to t=" << warmup << ": "
+              << snap->sinkWalkin.count << " walk-in, "
+              << snap->sinkOnline.count << " online done\n";
+
+    // 2) Fork every variant from the snapshot
+    std::vector<ForkResult> results(variants.size());
+    parallelFor(variants.size(), jobs, [&](size_t i) {
+        results[i] = runFork(base, variants[i], snap, horizon);
+    });
+
+    // 3) Compare
+    std::cout << std::left << std::setw(40) << "variant"
+              << std::right << std::setw(10) << "walkin" << std::setw(10) << "online"
+              << std::setw(12) << "payQueue" << std::setw(12) << "packQueue" << "\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(40) << r.variant;
+        if (!r.error.empty()) {
+            std::cout << "error: " << r.error << "\n";
+            continue;
+        }
+        std::cout << std::right << std::setw(10) << r.walkinDone << std::setw(10) << r.onlineDone
+                  << std::setw(12) << r.paymentQueued << std::setw(12) << r.packingQueued << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef ALLOC_ACCOUNTING_HPP
+#define ALLOC_ACCOUNTING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cadmium/modeling/devs/atomic.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ---- Heap allocation accounting per model ----
+// An opt-in instrumentation mode: the replacement operator new / delete in
+// alloc_hooks.hpp report every allocation here, and it is charged to the
+// model whose output, transition or time advance is running on that thread.
+// Anything else (the coordinator routing port bags, loggers, setup) is
+// charged to slot 0, "(simulator)".
+//
+// A model is accounted when it is built as Accounted<T> (see
+// addAccountedComponent), which wraps the AtomicInterface calls in a Scope.
+// The wrapper is only used once enable() has been called, so a normal run
+// has neither the wrapper nor any counting. Frees are charged to the slot
+// that made the allocation (kept in a small header in front of the block),
+// so live and peak bytes stay right when one model frees what another made.
+
+struct AllocCounters {
+    std::atomic<long> events{0};   // outputs, transitions and time advances
+    std::atomic<long> allocs{0};
+    std::atomic<long> frees{0};
+    std::atomic<long> bytes{0};    // allocated in total
+    std::atomic<long> live{0};     // allocated and not yet freed
+    std::atomic<long> peak{0};     // largest `live` seen
+};
+
+class AllocAccounting {
+public:
+    static constexpr int MAX_SLOTS = 256;   // models past this share slot 0
+
+    struct Row {
+        std::string name;
+        long events, allocs, frees, bytes, live, peak;
+    };
+
+    // Turn accounting on; models built afterwards are wrapped. Call before
+    // building the model, from the main thread.
+    static void enable() {
+        if (names_.empty()) names_.push_back("(simulator)");
+        enabled_.store(true, std::memory_order_relaxed);
+    }
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Slot for a model id; the same id always gets the same slot.
+    static int registerModel(const std::string& name) {
+        auto it = std::find(names_.begin(), names_.end(), name);
+        if (it != names_.end()) return static_cast<int>(it - names_.begin());
+        if (static_cast<int>(names_.size()) >= MAX_SLOTS) return 0;
+        names_.push_back(name);
+        return static_cast<int>(names_.size()) - 1;
+    }
+
+    // Charges the current thread's allocations to `slot` while alive.
+    class Scope {
+    public:
+        explicit Scope(int slot) : previous_(current_) {
+            current_ = slot;
+            counters_[slot].events.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~Scope() { current_ = previous_; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        int previous_;
+    };
+
+    // Called by the hooks; returns the slot to remember with the block, or
+    // -1 when accounting is off.
+    static int onAlloc(size_t size) {
+        if (!enabled()) return -1;
+        AllocCounters& c = counters_[current_];
+        c.allocs.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+        const long live = c.live.fetch_add(static_cast<long>(size), std::memory_order_relaxed) + static_cast<long>(size);
+        long peak = c.peak.load(std::memory_order_relaxed);
+        while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        return current_;
+    }
+    static void onFree(int slot, size_t size) {
+        if (slot < 0) return;
+        AllocCounters& c = counters_[slot];
+        c.frees.fetch_add(1, std::memory_order_relaxed);
+        c.live.fetch_sub(static_cast<long>(size), std::memory_order_relaxed);
+    }
+
+    // Every registered slot, in registration order ("(simulator)" first).
+    static std::vector<Row> rows() {
+        std::vector<Row> out;
+        for (size_t i = 0; i < names_.size(); ++i) {
+            const AllocCounters& c = counters_[i];
+            out.push_back({names_[i],
+                           c.events.load(std::memory_order_relaxed), c.allocs.load(std::memory_order_relaxed),
+                           c.frees.load(std::memory_order_relaxed), c.bytes.load(std::memory_order_relaxed),
+                           c.live.load(std::memory_order_relaxed), c.peak.load(std::memory_order_relaxed)});
+        }
+        return out;
+    }
+
+private:
+    static inline std::atomic<bool>        enabled_{false};
+    static inline AllocCounters            counters_[MAX_SLOTS];
+    static inline std::vector<std::string> names_;
+    static inline thread_local int         current_ = 0;
+};
+
+// The cadmium::Atomic<S> a model derives from (declaration only, for decltype)
+template <typename S>
+cadmium::Atomic<S>* atomicBaseOf(cadmium::Atomic<S>*);
+
+// A model T whose calls from the simulator are charged to its own slot. T's
+// own overloads hide the simulator-facing ones, so they are called on Base.
+template <typename T>
+class Accounted : public T {
+    using Base = std::remove_pointer_t<decltype(atomicBaseOf(static_cast<T*>(nullptr)))>;
+
+public:
+    using T::T;
+
+    void output() override {
+        AllocAccounting::Scope scope(slot_);
+        Base::output();
+    }
+    void internalTransition() override {
+        AllocAccounting::Scope scope(slot_);
+        Base::internalTransition();
+    }
+    void externalTransition(double e) override {
+        AllocAccounting::Scope scope(slot_);
+        Base::externalTransition(e);
+    }
+    void confluentTransition(double e) override {
+        AllocAccounting::Scope scope(slot_);
+        Base::confluentTransition(e);
+    }
+    [[nodiscard]] double timeAdvance() const override {
+        AllocAccounting::Scope scope(slot_);
+        return Base::timeAdvance();
+    }
+
+private:
+    const int slot_ = AllocAccounting::registerModel(this->getId());
+};
+
+// parent.addComponent<T>(args...), wrapped in Accounted<T> when accounting
+// is on. The result is still a std::shared_ptr<T>.
+template <typename T, typename Parent, typename... Args>
+std::shared_ptr<T> addAccountedComponent(Parent& parent, Args&&... args) {
+    if (AllocAccounting::enabled()) {
+        return parent.template addComponent<Accounted<T>>(std::forward<Args>(args)...);
+    }
+    return parent.template addComponent<T>(std::forward<Args>(args)...);
+}
+
+#endif // ALLOC_ACCOUNTING_HPP
@@ -0,0 +1,58 @@
+#ifndef ALLOC_HOOKS_HPP
+#define ALLOC_HOOKS_HPP
+
+#include <cstdlib>
+#include <new>
+#include "alloc_accounting.hpp"
+
+// ---- Replacement global operator new / delete for AllocAccounting ----
+// Include from exactly one translation unit of an executable (grocery_sim's
+// main.cpp). Every block gets a header holding its size and the slot it was
+// charged to, so delete can credit the right model without a lookup. With
+// accounting off that is the only cost: one flag test per call and the
+// header's bytes. Over-aligned new / delete keep the library versions.
+
+namespace alloc_hooks {
+
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+    size_t size;
+    int    slot;
+};
+
+inline void* allocate(size_t size) {
+    void* raw = std::malloc(sizeof(BlockHeader) + size);
+    if (!raw) return nullptr;
+    auto* header = static_cast<BlockHeader*>(raw);
+    header->size = size;
+    header->slot = AllocAccounting::onAlloc(size);
+    return header + 1;
+}
+
+inline void release(void* p) noexcept {
+    if (!p) return;
+    auto* header = static_cast<BlockHeader*>(p) - 1;
+    AllocAccounting::onFree(header->slot, header->size);
+    std::free(header);
+}
+
+} // namespace alloc_hooks
+
+void* operator new(size_t size) {
+    if (void* p = alloc_hooks::allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void* p = alloc_hooks::allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return alloc_hooks::allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return alloc_hooks::allocate(size); }
+
+void operator delete(void* p) noexcept { alloc_hooks::release(p); }
+void operator delete[](void* p) noexcept { alloc_hooks::release(p); }
+void operator delete(void* p, size_t) noexcept { alloc_hooks::release(p); }
+void operator delete[](void* p, size_t) noexcept { alloc_hooks::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc_hooks::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc_hooks::release(p); }
+
+#endif // ALLOC_HOOKS_HPP
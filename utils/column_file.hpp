@@ -0,0 +1,143 @@
+#ifndef COLUMN_FILE_HPP
+#define COLUMN_FILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ---- Compact columnar file for periodic samples ----
+// Rows are buffered and written in blocks; inside a block each column is one
+// contiguous array (int32 or float64), so a reader can pull a single column
+// without touching the others and the file compresses well.
+//
+// Layout:
+//   "GROCCOL1", uint32 columnCount,
+//   per column: uint8 type, uint16 nameLength, name bytes
+//   blocks:     uint32 rows, then per column `rows` values of its type
+
+enum class ColumnType : uint8_t { INT32, FLOAT64 };
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType  type = ColumnType::FLOAT64;
+};
+
+class ColumnFileWriter {
+public:
+    static constexpr size_t BLOCK_ROWS = 1024;
+
+    ColumnFileWriter(const std::string& path, std::vector<ColumnSpec> columns)
+        : columns_(std::move(columns)), values_(columns_.size())
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("cannot open column file " + path);
+
+        std::fwrite("GROCCOL1", 1, 8, file_);
+        put<uint32_t>(static_cast<uint32_t>(columns_.size()));
+        for (const auto& c : columns_) {
+            put<uint8_t>(static_cast<uint8_t>(c.type));
+            put<uint16_t>(static_cast<uint16_t>(c.name.size()));
+            std::fwrite(c.name.data(), 1, c.name.size(), file_);
+        }
+    }
+
+    ~ColumnFileWriter() {
+        flush();
+        std::fclose(file_);
+    }
+
+    ColumnFileWriter(const ColumnFileWriter&) = delete;
+    ColumnFileWriter& operator=(const ColumnFileWriter&) = delete;
+
+    // One value per column, in column order.
+    void append(const std::vector<double>& row) {
+        for (size_t i = 0; i < values_.size(); ++i) values_[i].push_back(i < row.size() ? row[i] : 0.0);
+        if (++rows_ >= BLOCK_ROWS) flush();
+    }
+
+    void flush() {
+        if (rows_ == 0) return;
+        put<uint32_t>(static_cast<uint32_t>(rows_));
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (columns_[i].type == ColumnType::INT32) {
+                for (double v : values_[i]) put<int32_t>(static_cast<int32_t>(v));
+            } else {
+                std::fwrite(values_[i].data(), sizeof(double), values_[i].size(), file_);
+            }
+            values_[i].clear();
+        }
+        rows_ = 0;
+        std::fflush(file_);
+    }
+
+    const std::vector<ColumnSpec>& columns() const { return columns_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<ColumnSpec> columns_;
+    std::vector<std::vector<double>> values_;   // per column, current block
+    size_t rows_ = 0;
+
+    template <typename T>
+    void put(T v) { std::fwrite(&v, sizeof(T), 1, file_); }
+};
+
+// Reads a whole column file into memory (used by tools/columns_to_csv).
+struct ColumnFile {
+    std::vector<ColumnSpec> columns;
+    std::vector<std::vector<double>> values;   // per column, all rows
+
+    size_t rows() const { return values.empty() ? 0 : values[0].size(); }
+
+    static ColumnFile read(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) throw std::runtime_error("cannot open column file " + path);
+        ColumnFile out;
+        try {
+            char magic[8];
+            if (std::fread(magic, 1, 8, f) != 8 || std::memcmp(magic, "GROCCOL1", 8) != 0) {
+                throw std::runtime_error(path + " is not a column file");
+            }
+            const uint32_t n = get<uint32_t>(f);
+            for (uint32_t i = 0; i < n; ++i) {
+                ColumnSpec c;
+                c.type = static_cast<ColumnType>(get<uint8_t>(f));
+                c.name.resize(get<uint16_t>(f));
+                if (std::fread(c.name.data(), 1, c.name.size(), f) != c.name.size()) {
+                    throw std::runtime_error(path + ": truncated header");
+                }
+                out.columns.push_back(c);
+            }
+            out.values.resize(n);
+
+            uint32_t rows;
+            while (std::fread(&rows, sizeof(rows), 1, f) == 1) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        out.values[i].push_back(out.columns[i].type == ColumnType::INT32
+                                                ? static_cast<double>(get<int32_t>(f))
+                                                : get<double>(f));
+                    }
+                }
+            }
+        } catch (...) {
+            std::fclose(f);
+            throw;
+        }
+        std::fclose(f);
+        return out;
+    }
+
+private:
+    template <typename T>
+    static T get(std::FILE* f) {
+        T v;
+        if (std::fread(&v, sizeof(T), 1, f) != 1) throw std::runtime_error("truncated column file");
+        return v;
+    }
+};
+
+#endif // COLUMN_FILE_HPP
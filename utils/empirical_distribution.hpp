@@ -0,0 +1,119 @@
+#ifndef EMPIRICAL_DISTRIBUTION_HPP
+#define EMPIRICAL_DISTRIBUTION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// ---- Empirical histograms sampled with Walker's alias method ----
+// A histogram is a list of bins [lo, hi) with weights; a bin with lo == hi is
+// a point mass (e.g. a basket of exactly 7 items). Building the alias table
+// is O(n) (Vose); every draw afterwards is O(1) from a single uniform u:
+//
+//   x = u * n,  i = floor(x),  f = x - i
+//   bin = f < prob[i] ? i : alias[i]
+//
+// The leftover of f within the chosen side is uniform again and places the
+// value inside the bin, so one keyed uniform per customer is enough and a
+// draw is two table loads and selects, with no search and no loop.
+
+struct HistogramBin {
+    double lo     = 0.0;
+    double hi     = 0.0;   // == lo for a point mass
+    double weight = 0.0;   // normalised to sum to 1 once in a distribution
+};
+
+class EmpiricalDistribution {
+public:
+    // Throws std::invalid_argument for an empty histogram, a negative weight,
+    // hi < lo, or weights summing to zero.
+    explicit EmpiricalDistribution(std::vector<HistogramBin> bins) : bins_(std::move(bins)) {
+        if (bins_.empty()) throw std::invalid_argument("empty histogram");
+        double total = 0.0;
+        for (const auto& b : bins_) {
+            if (b.weight < 0.0 || b.hi < b.lo) throw std::invalid_argument("bad histogram bin");
+            total += b.weight;
+        }
+        if (!(total > 0.0)) throw std::invalid_argument("histogram weights sum to zero");
+
+        const size_t n = bins_.size();
+        lo_.resize(n);
+        width_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            bins_[i].weight /= total;
+            lo_[i]    = bins_[i].lo;
+            width_[i] = bins_[i].hi - bins_[i].lo;
+        }
+        buildAlias();
+    }
+
+    // Value for a uniform u in [0, 1).
+    double sample(double u) const {
+        const double x = u * static_cast<double>(prob_.size());
+        const size_t i = std::min(static_cast<size_t>(x), prob_.size() - 1);
+        const double f = x - static_cast<double>(i);
+        const double p = prob_[i];
+        const bool   keep = f < p;
+        const uint32_t bin = keep ? static_cast<uint32_t>(i) : alias_[i];
+        const double w = keep ? f * invProb_[i] : (f - p) * invRest_[i];
+        return lo_[bin] + w * width_[bin];
+    }
+
+    const std::vector<HistogramBin>& bins() const { return bins_; }
+
+    // E[X] and E[X^2], values uniform within each bin
+    double mean() const {
+        double m = 0.0;
+        for (const auto& b : bins_) m += b.weight * 0.5 * (b.lo + b.hi);
+        return m;
+    }
+    double secondMoment() const {
+        double m = 0.0;
+        for (const auto& b : bins_) m += b.weight * (b.lo * b.lo + b.lo * b.hi + b.hi * b.hi) / 3.0;
+        return m;
+    }
+
+private:
+    std::vector<HistogramBin> bins_;
+    std::vector<double>   lo_, width_;
+    std::vector<double>   prob_;       // keep bin i when f < prob_[i]
+    std::vector<double>   invProb_;    // 1 / prob_[i] (0 when unused)
+    std::vector<double>   invRest_;    // 1 / (1 - prob_[i]) (0 when unused)
+    std::vector<uint32_t> alias_;
+
+    // Vose's alias method: pair every under-full column with an over-full one.
+    void buildAlias() {
+        const size_t n = bins_.size();
+        prob_.assign(n, 1.0);
+        alias_.resize(n);
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            alias_[i]  = static_cast<uint32_t>(i);
+            scaled[i]  = bins_[i].weight * static_cast<double>(n);
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            const uint32_t s = small.back(); small.pop_back();
+            const uint32_t l = large.back(); large.pop_back();
+            prob_[s]  = scaled[s];
+            alias_[s] = l;
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            (scaled[l] < 1.0 ? small : large).push_back(l);
+        }
+        // Whatever is left is full up to rounding
+        for (uint32_t i : small) prob_[i] = 1.0;
+        for (uint32_t i : large) prob_[i] = 1.0;
+
+        invProb_.resize(n);
+        invRest_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            invProb_[i] = (prob_[i] > 0.0) ? 1.0 / prob_[i] : 0.0;
+            invRest_[i] = (prob_[i] < 1.0) ? 1.0 / (1.0 - prob_[i]) : 0.0;
+        }
+    }
+};
+
+#endif // EMPIRICAL_DISTRIBUTION_HPP
@@ -0,0 +1,62 @@
+#ifndef FORK_QUEUE_HPP
+#define FORK_QUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// ---- FIFO queue whose contents snapshot forks share ----
+// Used like std::queue (push, front, pop, size). freeze() moves the waiting
+// items into one immutable block behind a shared_ptr; copies of the queue
+// share that block, pops from it only advance a cursor, and pushes go to a
+// deque the copy owns. A store forked from a snapshot (store_snapshot.hpp)
+// therefore pays for the customers who joined a queue after the fork, not
+// for the whole queue. Until freeze() is called the block is empty and the
+// queue is a plain deque.
+template <typename T>
+class ForkQueue {
+public:
+    bool   empty() const { return size() == 0; }
+    size_t size() const  { return sharedCount() + own_.size(); }
+
+    void push(const T& item) { own_.push_back(item); }
+
+    const T& front() const { return head_ < sharedEnd() ? (*shared_)[head_] : own_.front(); }
+
+    void pop() {
+        if (head_ < sharedEnd()) {
+            if (++head_ == shared_->size()) {
+                shared_.reset();   // the last fork to drain it frees the block
+                head_ = 0;
+            }
+        } else {
+            own_.pop_front();
+        }
+    }
+
+    // Move every waiting item into a new shared block (O(size), once per snapshot).
+    void freeze() {
+        if (own_.empty() && head_ == 0) return;
+        auto block = std::make_shared<std::vector<T>>();
+        block->reserve(size());
+        for (size_t i = head_; i < sharedEnd(); ++i) block->push_back((*shared_)[i]);
+        for (T& item : own_) block->push_back(std::move(item));
+        own_.clear();
+        head_ = 0;
+        if (block->empty()) shared_.reset();
+        else                shared_ = std::move(block);
+    }
+
+    // Items still read from a shared block (the rest are owned by this copy)
+    size_t sharedCount() const { return sharedEnd() - head_; }
+
+private:
+    std::shared_ptr<const std::vector<T>> shared_;
+    size_t        head_ = 0;   // first item of shared_ still waiting
+    std::deque<T> own_;        // pushed since the last freeze(), in order, after shared_
+
+    size_t sharedEnd() const { return shared_ ? shared_->size() : 0; }
+};
+
+#endif // FORK_QUEUE_HPP
@@ -0,0 +1,63 @@
+#ifndef IPA_GRADIENT_HPP
+#define IPA_GRADIENT_HPP
+
+#include <array>
+#include <cstddef>
+
+// ---- Infinitesimal perturbation analysis (IPA) ----
+// Every service parameter is perturbed as a scale: all the service times it
+// governs are multiplied by lambda, at lambda = 1. A service time S then has
+// dS/dlambda = S, and each customer carries the derivative of the time it
+// left its last station. The stations propagate it with the usual FIFO
+// recursions:
+//
+//   start     = max(arrival, time a server frees)   -> d(start) is d of the max
+//   departure = start + S                           -> d(departure) = d(start) + S e_k
+//
+// so the sinks can sum d(sojourn) for every parameter in one run. Divide by
+// the parameter's nominal value for the derivative per unit of it (e.g. per
+// second of cashTimePerItem). Reneging, routing choices and lane closures
+// are treated as locally constant, as IPA always does; their effect on who
+// is served is not in the estimate.
+
+enum class IpaParam : int {
+    CASH_ITEM,    // staffed lanes' time per item
+    SELF_ITEM,    // self-checkout time per item
+    CARD_PAY,     // card / tap payment time
+    CASH_PAY,     // cash payment time
+    PACK,         // packing time (the order's searchTime)
+    PICKUP,       // curbside pickup time (the order's travelTime)
+    COUNT
+};
+
+static constexpr size_t IPA_PARAMS = static_cast<size_t>(IpaParam::COUNT);
+
+inline const char* ipaParamName(IpaParam p) {
+    static const char* const names[] = {
+        "cashTimePerItem", "selfTimePerItem", "cardPayTime", "cashPayTime", "packTime", "pickupTime"
+    };
+    const auto i = static_cast<size_t>(p);
+    return i < IPA_PARAMS ? names[i] : "unknown";
+}
+
+// d(time)/d(lambda_k) for every parameter k
+struct IpaGradient {
+    std::array<double, IPA_PARAMS> d{};
+
+    double  operator[](IpaParam p) const { return d[static_cast<size_t>(p)]; }
+    double& operator[](IpaParam p)       { return d[static_cast<size_t>(p)]; }
+
+    IpaGradient& operator+=(const IpaGradient& o) {
+        for (size_t k = 0; k < IPA_PARAMS; ++k) d[k] += o.d[k];
+        return *this;
+    }
+
+    // Departure after a service of length `s` that scales with `p`
+    IpaGradient plusService(IpaParam p, double s) const {
+        IpaGradient g = *this;
+        g[p] += s;
+        return g;
+    }
+};
+
+#endif // IPA_GRADIENT_HPP
@@ -0,0 +1,153 @@
+#ifndef LIFECYCLE_TRACE_HPP
+#define LIFECYCLE_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "customer_data.hpp"
+
+// ---- Sampled customer lifecycle tracing ----
+// One customer in N (chosen by a hash of customerId, so the same customers are
+// traced in every run) records timestamped span events as it moves through
+// the store. Generator marks those customers with CustomerData::traced, and the
+// atomics call traceBegin/traceEnd/traceInstant. For anyone else each call is a
+// single branch on that flag.
+//
+// Records go into a per-thread buffer and are appended to one binary file in
+// blocks, so forked runs on worker threads never contend per event.
+// tools/trace_to_json converts the file to a Chrome / Perfetto trace.
+//
+// File layout: TraceFileHeader, then TraceRecords in per-thread blocks.
+
+enum class TraceStage : uint8_t {
+    ARRIVE,       // instant: entered the store (Distributor)
+    ENTRY_QUEUE,  // waiting in the Distributor entry queue
+    LANE_QUEUE,   // waiting behind another customer at a lane (detail = lane)
+    CHECKOUT,     // being checked out (detail = lane)
+    PAY_QUEUE,
+    PAYMENT,
+    TRAVEL,       // walking to the exit
+    PACK_QUEUE,   // online order waiting for a packer
+    PACKING,
+    CURB_QUEUE,   // waiting for the curbside dispatcher
+    PICKUP,
+    RENEGED,      // instant: gave up (detail = stage it was waiting in)
+    LOST,         // instant: turned away at a full entry queue
+    DONE,         // instant: reached a sink
+    COUNT
+};
+
+inline const char* traceStageName(TraceStage stage) {
+    static const char* const names[] = {
+        "arrive", "entry_queue", "lane_queue", "checkout", "pay_queue", "payment",
+        "travel", "pack_queue", "packing", "curb_queue", "pickup", "reneged", "lost", "done"
+    };
+    const auto i = static_cast<size_t>(stage);
+    return i < static_cast<size_t>(TraceStage::COUNT) ? names[i] : "unknown";
+}
+
+enum class TracePhase : uint8_t { BEGIN, END, INSTANT };
+
+struct TraceRecord {
+    double   time;          // simulated seconds
+    int32_t  customerId;
+    int32_t  detail;        // lane id or stage, -1 if unused
+    uint16_t thread;        // which buffer (one per simulating thread)
+    uint8_t  stage;         // TraceStage
+    uint8_t  phase;         // TracePhase
+    uint32_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord is written to disk as-is");
+
+struct TraceFileHeader {
+    char     magic[8];      // "GROCTRC1"
+    uint32_t recordSize;
+    uint32_t sampleEvery;
+};
+
+class LifecycleTrace {
+public:
+    // Start tracing 1 in `sampleEvery` customers into `path` (truncated).
+    static void open(const std::string& path, int sampleEvery) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_) std::fclose(file_);
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("cannot open trace file " + path);
+
+        TraceFileHeader header{};
+        std::memcpy(header.magic, "GROCTRC1", 8);
+        header.recordSize  = sizeof(TraceRecord);
+        header.sampleEvery = static_cast<uint32_t>(sampleEvery);
+        std::fwrite(&header, sizeof(header), 1, file_);
+        every_.store(sampleEvery > 0 ? sampleEvery : 0, std::memory_order_relaxed);
+    }
+
+    // Flush the calling thread's buffer and close the file. Worker threads
+    // flush their own buffers when they exit, so join them first.
+    static void close() {
+        flush(buffer());
+        std::lock_guard<std::mutex> lock(mutex_);
+        every_.store(0, std::memory_order_relaxed);
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    // Deterministic 1-in-N selection; false whenever tracing is off.
+    static bool sampled(int customerId) {
+        const int every = every_.load(std::memory_order_relaxed);
+        if (every <= 0) return false;
+        const uint32_t h = static_cast<uint32_t>(customerId) * 0x9E3779B1u;  // spread consecutive ids
+        return (h >> 7) % static_cast<uint32_t>(every) == 0;
+    }
+
+    static void record(double time, int customerId, TraceStage stage, TracePhase phase, int detail) {
+        Buffer& b = buffer();
+        b.records.push_back({time, customerId, detail, b.thread,
+                             static_cast<uint8_t>(stage), static_cast<uint8_t>(phase), 0});
+        if (b.records.size() >= FLUSH_RECORDS) flush(b);
+    }
+
+private:
+    static constexpr size_t FLUSH_RECORDS = 4096;
+
+    struct Buffer {
+        std::vector<TraceRecord> records;
+        uint16_t thread = static_cast<uint16_t>(nextThread_.fetch_add(1, std::memory_order_relaxed));
+        ~Buffer() { flush(*this); }
+    };
+
+    inline static std::mutex        mutex_;
+    inline static std::FILE*        file_ = nullptr;
+    inline static std::atomic<int>  every_{0};
+    inline static std::atomic<int>  nextThread_{0};
+
+    static Buffer& buffer() {
+        thread_local Buffer b;
+        return b;
+    }
+
+    static void flush(Buffer& b) {
+        if (b.records.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_) std::fwrite(b.records.data(), sizeof(TraceRecord), b.records.size(), file_);
+        b.records.clear();
+    }
+};
+
+// Call sites in the atomics: one branch for customers that are not traced.
+inline void traceBegin(double time, const CustomerData& c, TraceStage stage, int detail = -1) {
+    if (c.traced) LifecycleTrace::record(time, c.customerId, stage, TracePhase::BEGIN, detail);
+}
+inline void traceEnd(double time, const CustomerData& c, TraceStage stage, int detail = -1) {
+    if (c.traced) LifecycleTrace::record(time, c.customerId, stage, TracePhase::END, detail);
+}
+inline void traceInstant(double time, const CustomerData& c, TraceStage stage, int detail = -1) {
+    if (c.traced) LifecycleTrace::record(time, c.customerId, stage, TracePhase::INSTANT, detail);
+}
+
+#endif // LIFECYCLE_TRACE_HPP
@@ -0,0 +1,215 @@
+#ifndef LIVE_METRICS_HPP
+#define LIVE_METRICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---- Live metrics in POSIX shared memory ----
+// A running simulation publishes queue lengths and completion counts into a
+// fixed-size LiveMetrics block at /dev/shm/<name>; tools/metrics_reader.cpp
+// samples it while the run is in progress. No CSV logger is needed.
+//
+// Concurrency is a seqlock: the (single) simulation thread bumps `seq` to odd,
+// stores the fields, and bumps it back to even. Readers retry until they see
+// the same even value before and after copying. The writer never waits, so
+// each update is a handful of relaxed stores plus two fences.
+
+static constexpr uint32_t LIVE_METRICS_MAGIC = 0x47524f43;   // "GROC"
+static constexpr int      LIVE_METRICS_LANES = 64;
+
+struct LiveMetrics {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint64_t> seq;
+
+    std::atomic<double>   simTime;                            // latest clock any model reported
+    std::atomic<int32_t>  laneCount;
+    std::atomic<int32_t>  laneQueue[LIVE_METRICS_LANES];      // Distributor: assigned per lane
+    std::atomic<int32_t>  laneBusy[LIVE_METRICS_LANES];       // Cash: 1 while serving
+    std::atomic<int32_t>  laneWaiting[LIVE_METRICS_LANES];    // Cash: waiting behind the customer in service
+    std::atomic<int32_t>  paymentQueue;
+    std::atomic<int64_t>  walkinDone;
+    std::atomic<int64_t>  onlineDone;
+    std::atomic<int32_t>  entryWaiting;                       // Distributor: walk-ins waiting for a lane
+    std::atomic<int64_t>  entryLost;                          // Distributor: turned away at a full entrance
+};
+
+static_assert(std::atomic<double>::is_always_lock_free, "LiveMetrics needs lock-free doubles");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "LiveMetrics needs lock-free 64-bit counters");
+
+// Plain copy of LiveMetrics taken by a reader.
+struct LiveMetricsSample {
+    uint64_t seq = 0;
+    double   simTime = 0.0;
+    int32_t  laneCount = 0;
+    int32_t  laneQueue[LIVE_METRICS_LANES] = {};
+    int32_t  laneBusy[LIVE_METRICS_LANES] = {};
+    int32_t  laneWaiting[LIVE_METRICS_LANES] = {};
+    int32_t  paymentQueue = 0;
+    int64_t  walkinDone = 0;
+    int64_t  onlineDone = 0;
+    int32_t  entryWaiting = 0;
+    int64_t  entryLost = 0;
+};
+
+// Owns the shared-memory segment; models hold a plain pointer to it.
+class LiveMetricsWriter {
+public:
+    enum class Sink { WALKIN, ONLINE };
+
+    explicit LiveMetricsWriter(const std::string& name)
+        : name_(name.empty() || name[0] == '/' ? name : "/" + name)
+    {
+        // O_EXCL: a segment left by a crashed run, or in use by another run
+        // with the same name, is refused rather than shared
+        const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0 && errno == EEXIST) {
+            throw std::runtime_error("live metrics segment " + name_ + " already exists (another run, or left by "
+                                     "a crashed one: remove /dev/shm" + name_ + ")");
+        }
+        if (fd < 0) throw std::runtime_error("shm_open failed for " + name_);
+        if (ftruncate(fd, sizeof(LiveMetrics)) != 0) {
+            close(fd);
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("ftruncate failed for " + name_);
+        }
+        void* p = mmap(nullptr, sizeof(LiveMetrics), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("mmap failed for " + name_);
+        }
+
+        m_ = static_cast<LiveMetrics*>(p);   // newly created, so zero-filled
+        m_->seq.store(0, std::memory_order_relaxed);
+        m_->magic.store(LIVE_METRICS_MAGIC, std::memory_order_release);
+    }
+
+    ~LiveMetricsWriter() {
+        munmap(m_, sizeof(LiveMetrics));
+        shm_unlink(name_.c_str());
+    }
+
+    LiveMetricsWriter(const LiveMetricsWriter&) = delete;
+    LiveMetricsWriter& operator=(const LiveMetricsWriter&) = delete;
+
+    void laneQueues(const std::vector<int>& queues, double time) {
+        write([&] {
+            const int n = std::min<int>(static_cast<int>(queues.size()), LIVE_METRICS_LANES);
+            m_->laneCount.store(n, std::memory_order_relaxed);
+            for (int i = 0; i < n; ++i) m_->laneQueue[i].store(queues[i], std::memory_order_relaxed);
+            advanceTime(time);
+        });
+    }
+
+    void entryQueue(size_t waiting, long lost) {
+        write([&] {
+            m_->entryWaiting.store(static_cast<int32_t>(waiting), std::memory_order_relaxed);
+            m_->entryLost.store(lost, std::memory_order_relaxed);
+        });
+    }
+
+    void lane(int laneId, bool busy, size_t waiting) {
+        if (laneId < 0 || laneId >= LIVE_METRICS_LANES) return;
+        write([&] {
+            m_->laneBusy[laneId].store(busy ? 1 : 0, std::memory_order_relaxed);
+            m_->laneWaiting[laneId].store(static_cast<int32_t>(waiting), std::memory_order_relaxed);
+        });
+    }
+
+    void paymentQueue(size_t queued) {
+        write([&] { m_->paymentQueue.store(static_cast<int32_t>(queued), std::memory_order_relaxed); });
+    }
+
+    void sinkCount(Sink sink, int count, double time) {
+        write([&] {
+            auto& field = (sink == Sink::WALKIN) ? m_->walkinDone : m_->onlineDone;
+            field.store(count, std::memory_order_relaxed);
+            advanceTime(time);
+        });
+    }
+
+private:
+    std::string  name_;
+    LiveMetrics* m_ = nullptr;
+
+    template <typename F>
+    void write(F&& body) {
+        const uint64_t s = m_->seq.load(std::memory_order_relaxed);
+        m_->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        body();
+        m_->seq.store(s + 2, std::memory_order_release);
+    }
+
+    void advanceTime(double time) {
+        if (time > m_->simTime.load(std::memory_order_relaxed)) {
+            m_->simTime.store(time, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Read-only mapping used by the reader tool.
+class LiveMetricsReader {
+public:
+    explicit LiveMetricsReader(const std::string& name) {
+        const std::string path = name.empty() || name[0] == '/' ? name : "/" + name;
+        const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+        if (fd < 0) throw std::runtime_error("no live metrics segment " + path);
+        void* p = mmap(nullptr, sizeof(LiveMetrics), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("mmap failed for " + path);
+        m_ = static_cast<const LiveMetrics*>(p);
+        if (m_->magic.load(std::memory_order_acquire) != LIVE_METRICS_MAGIC) {
+            munmap(const_cast<LiveMetrics*>(m_), sizeof(LiveMetrics));
+            throw std::runtime_error(path + " is not a live metrics segment");
+        }
+    }
+
+    ~LiveMetricsReader() { munmap(const_cast<LiveMetrics*>(m_), sizeof(LiveMetrics)); }
+
+    LiveMetricsReader(const LiveMetricsReader&) = delete;
+    LiveMetricsReader& operator=(const LiveMetricsReader&) = delete;
+
+    // Consistent copy of every field (retries while the writer is mid-update).
+    LiveMetricsSample sample() const {
+        LiveMetricsSample out;
+        uint64_t before, after;
+        do {
+            before = m_->seq.load(std::memory_order_acquire);
+            if (before & 1u) continue;
+
+            out.simTime   = m_->simTime.load(std::memory_order_relaxed);
+            out.laneCount = m_->laneCount.load(std::memory_order_relaxed);
+            for (int i = 0; i < LIVE_METRICS_LANES; ++i) {
+                out.laneQueue[i]   = m_->laneQueue[i].load(std::memory_order_relaxed);
+                out.laneBusy[i]    = m_->laneBusy[i].load(std::memory_order_relaxed);
+                out.laneWaiting[i] = m_->laneWaiting[i].load(std::memory_order_relaxed);
+            }
+            out.paymentQueue = m_->paymentQueue.load(std::memory_order_relaxed);
+            out.walkinDone   = m_->walkinDone.load(std::memory_order_relaxed);
+            out.onlineDone   = m_->onlineDone.load(std::memory_order_relaxed);
+            out.entryWaiting = m_->entryWaiting.load(std::memory_order_relaxed);
+            out.entryLost    = m_->entryLost.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_->seq.load(std::memory_order_relaxed);
+        } while ((before & 1u) || before != after);
+        out.seq = before;
+        return out;
+    }
+
+private:
+    const LiveMetrics* m_ = nullptr;
+};
+
+#endif // LIVE_METRICS_HPP
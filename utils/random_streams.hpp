@@ -0,0 +1,56 @@
+#ifndef RANDOM_STREAMS_HPP
+#define RANDOM_STREAMS_HPP
+
+#include <cstdint>
+#include <random>
+
+// ---- Random streams for common random numbers ----
+// To compare two store configurations on the same customers, each source of
+// randomness draws from its own stream: arrivals, customer attributes
+// (Generator) and service times (PaymentProcessor). Changing how one config
+// routes or serves customers then no longer shifts the draws of the others.
+//
+// Antithetic replications run a second copy of a seed with every uniform u
+// replaced by 1 - u. Draws made by inversion (exponential, bernoulli, uniform,
+// and the polar-method normal) become negatively correlated with the first copy.
+
+// std::mt19937 that optionally returns max() - x for every raw draw x,
+// which the standard distributions turn into (approximately) 1 - u.
+class RandomStream {
+public:
+    using result_type = std::mt19937::result_type;
+
+    RandomStream() : eng_(std::random_device{}()) {}
+    explicit RandomStream(result_type seed, bool antithetic = false)
+        : eng_(seed), antithetic_(antithetic) {}
+
+    void seed(result_type s) { eng_.seed(s); }
+    void setAntithetic(bool a) { antithetic_ = a; }
+    bool antithetic() const { return antithetic_; }
+
+    static constexpr result_type min() { return std::mt19937::min(); }
+    static constexpr result_type max() { return std::mt19937::max(); }
+
+    result_type operator()() {
+        const result_type x = eng_();
+        return antithetic_ ? max() - x : x;
+    }
+
+private:
+    std::mt19937 eng_;
+    bool antithetic_ = false;
+};
+
+// Uniform on [0, 1) for draw `n` of the stream `key` (splitmix64). The same
+// (key, n) always gives the same value, so a customer's service time does not
+// depend on the order in which customers reach the server.
+inline double keyedUniform(uint64_t key, uint64_t n, bool antithetic = false) {
+    uint64_t z = key + (n + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    const double u = static_cast<double>(z >> 11) * 0x1.0p-53;
+    return antithetic ? 1.0 - u : u;
+}
+
+#endif // RANDOM_STREAMS_HPP
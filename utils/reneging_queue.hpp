@@ -0,0 +1,248 @@
+#ifndef RENEGING_QUEUE_HPP
+#define RENEGING_QUEUE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// ---- FIFO queue whose members may give up before being served ----
+// Items are served from the front in arrival order, but each carries a
+// deadline (absolute simulated time) at which it leaves on its own. Deadlines
+// are kept in an indexed binary min-heap: every entry knows its heap position,
+// so serving an item cancels its deadline in O(log n), and the item whose
+// deadline expires is unlinked from the middle of the FIFO in O(1).
+//
+// Entries live in a slot pool linked front to back, with a free list, so a
+// queue that grows to tens of thousands during an overload reuses its memory
+// afterwards. Items without a deadline never enter the heap.
+//
+// For snapshot forks (store_snapshot.hpp), freeze() moves the waiting items
+// into an immutable block, in order and with a deadline-sorted index, behind
+// a shared_ptr, as ForkQueue does (fork_queue.hpp). Copies share the block;
+// serving from it advances a cursor, and an item leaving from its middle only
+// sets a bit the copy owns, so each fork pays for the items that joined it
+// after the fork. Frozen items are always ahead of the pool's.
+template <typename T>
+class RenegingQueue {
+public:
+    static constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+    bool   empty() const { return size() == 0; }
+    size_t size() const  { return frozenLive_ + size_; }
+
+    void push(const T& item, double deadline = NEVER) {
+        const int id = allocate();
+        Entry& e = slots_[id];
+        e.item     = item;
+        e.deadline = deadline;
+        e.prev     = tail_;
+        e.next     = -1;
+        e.heapPos  = -1;
+
+        if (tail_ >= 0) slots_[tail_].next = id;
+        else            head_ = id;
+        tail_ = id;
+        ++size_;
+
+        if (deadline != NEVER) {
+            e.heapPos = static_cast<int>(heap_.size());
+            heap_.push_back(id);
+            siftUp(e.heapPos);
+        }
+    }
+
+    const T& front() const { return frozenLive_ > 0 ? frozen().items[frozenHead_].item : slots_[head_].item; }
+
+    // Serve the front item; its deadline is cancelled.
+    T pop() { return frozenLive_ > 0 ? removeFrozen(frozenHead_) : remove(head_); }
+
+    // Earliest deadline among waiting items (NEVER if none can give up).
+    double nextDeadline() const { return std::min(frozenDeadline(), heap_.empty() ? NEVER : slots_[heap_[0]].deadline); }
+
+    // Remove the item whose deadline is nextDeadline(); frozen items win ties,
+    // being older.
+    T popExpired() {
+        const double frozenNext = frozenDeadline();
+        if (frozenNext < NEVER && (heap_.empty() || frozenNext <= slots_[heap_[0]].deadline)) {
+            return removeFrozen(frozen().byDeadline[deadlineNext_]);
+        }
+        return remove(heap_[0]);
+    }
+
+    // Visit waiting items front to back.
+    template <typename F>
+    void forEach(F&& visit) const {
+        for (size_t i = frozenHead_; frozenLive_ > 0 && i < frozen().items.size(); ++i) {
+            if (!gone(i)) visit(frozen().items[i].item);
+        }
+        for (int id = head_; id >= 0; id = slots_[id].next) visit(slots_[id].item);
+    }
+
+    // Move every waiting item into a new shared block (O(n log n), once per snapshot).
+    void freeze() {
+        if (size_ == 0) return;
+        auto block = std::make_shared<Frozen>();
+        block->items.reserve(size());
+        for (size_t i = frozenHead_; frozenLive_ > 0 && i < frozen().items.size(); ++i) {
+            if (!gone(i)) block->items.push_back(frozen().items[i]);
+        }
+        for (int id = head_; id >= 0; id = slots_[id].next) {
+            block->items.push_back({std::move(slots_[id].item), slots_[id].deadline});
+        }
+        for (size_t i = 0; i < block->items.size(); ++i) {
+            if (block->items[i].deadline != NEVER) block->byDeadline.push_back(static_cast<int>(i));
+        }
+        std::stable_sort(block->byDeadline.begin(), block->byDeadline.end(), [&](int a, int b) {
+            return block->items[a].deadline < block->items[b].deadline;
+        });
+
+        slots_.clear();
+        free_.clear();
+        heap_.clear();
+        head_ = tail_ = -1;
+        size_ = 0;
+        frozen_       = std::move(block);
+        frozenHead_   = 0;
+        frozenLive_   = frozen_->items.size();
+        deadlineNext_ = 0;
+        frozenGone_.clear();
+    }
+
+    // Items still read from a shared block (the rest are owned by this copy)
+    size_t sharedCount() const { return frozenLive_; }
+
+private:
+    struct Entry {
+        T      item{};
+        double deadline = NEVER;
+        int    prev = -1;
+        int    next = -1;
+        int    heapPos = -1;
+    };
+
+    struct FrozenEntry {
+        T      item{};
+        double deadline = NEVER;
+    };
+    struct Frozen {
+        std::vector<FrozenEntry> items;        // FIFO order
+        std::vector<int>         byDeadline;   // items with a deadline, earliest first
+    };
+
+    std::shared_ptr<const Frozen> frozen_;
+    size_t frozenHead_   = 0;       // first frozen item still waiting (all before it are gone)
+    size_t frozenLive_   = 0;       // frozen items still waiting
+    size_t deadlineNext_ = 0;       // first byDeadline entry still waiting
+    std::vector<bool> frozenGone_;  // frozen items that left from the middle; sized on first use
+
+    std::vector<Entry> slots_;
+    std::vector<int>   free_;
+    std::vector<int>   heap_;    // slot ids ordered by deadline
+    int    head_ = -1;
+    int    tail_ = -1;
+    size_t size_ = 0;
+
+    const Frozen& frozen() const { return *frozen_; }
+
+    bool gone(size_t i) const { return i < frozenHead_ || (!frozenGone_.empty() && frozenGone_[i]); }
+
+    double frozenDeadline() const {
+        return frozenLive_ > 0 && deadlineNext_ < frozen().byDeadline.size()
+             ? frozen().items[frozen().byDeadline[deadlineNext_]].deadline
+             : NEVER;
+    }
+
+    T removeFrozen(size_t i) {
+        T item = frozen().items[i].item;
+        if (i != frozenHead_) {
+            if (frozenGone_.empty()) frozenGone_.resize(frozen().items.size(), false);
+            frozenGone_[i] = true;
+        }
+        if (--frozenLive_ == 0) {
+            frozen_.reset();   // the last fork to drain it frees the block
+            frozenHead_ = deadlineNext_ = 0;
+            frozenGone_.clear();
+            return item;
+        }
+        while (gone(frozenHead_) || frozenHead_ == i) ++frozenHead_;
+        const auto& order = frozen().byDeadline;
+        while (deadlineNext_ < order.size() && gone(static_cast<size_t>(order[deadlineNext_]))) ++deadlineNext_;
+        return item;
+    }
+
+    int allocate() {
+        if (!free_.empty()) {
+            const int id = free_.back();
+            free_.pop_back();
+            return id;
+        }
+        slots_.emplace_back();
+        return static_cast<int>(slots_.size()) - 1;
+    }
+
+    T remove(int id) {
+        Entry& e = slots_[id];
+        if (e.prev >= 0) slots_[e.prev].next = e.next;
+        else             head_ = e.next;
+        if (e.next >= 0) slots_[e.next].prev = e.prev;
+        else             tail_ = e.prev;
+
+        if (e.heapPos >= 0) eraseHeapAt(e.heapPos);
+
+        T item = std::move(e.item);
+        e.item = T{};
+        free_.push_back(id);
+        --size_;
+        return item;
+    }
+
+    void eraseHeapAt(int pos) {
+        slots_[heap_[pos]].heapPos = -1;
+        const int last = heap_.back();
+        heap_.pop_back();
+        if (pos < static_cast<int>(heap_.size())) {
+            heap_[pos] = last;
+            slots_[last].heapPos = pos;
+            siftDown(pos);
+            siftUp(slots_[last].heapPos);
+        }
+    }
+
+    bool earlier(int a, int b) const {
+        return slots_[heap_[a]].deadline < slots_[heap_[b]].deadline;
+    }
+
+    void swapAt(int a, int b) {
+        std::swap(heap_[a], heap_[b]);
+        slots_[heap_[a]].heapPos = a;
+        slots_[heap_[b]].heapPos = b;
+    }
+
+    void siftUp(int pos) {
+        while (pos > 0) {
+            const int parent = (pos - 1) / 2;
+            if (!earlier(pos, parent)) break;
+            swapAt(pos, parent);
+            pos = parent;
+        }
+    }
+
+    void siftDown(int pos) {
+        const int n = static_cast<int>(heap_.size());
+        for (;;) {
+            const int left  = 2 * pos + 1;
+            const int right = left + 1;
+            int least = pos;
+            if (left < n && earlier(left, least))   least = left;
+            if (right < n && earlier(right, least)) least = right;
+            if (least == pos) break;
+            swapAt(pos, least);
+            pos = least;
+        }
+    }
+};
+
+#endif // RENEGING_QUEUE_HPP
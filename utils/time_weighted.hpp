@@ -0,0 +1,44 @@
+#ifndef TIME_WEIGHTED_HPP
+#define TIME_WEIGHTED_HPP
+
+#include <algorithm>
+
+// ---- Time-weighted statistics kept inside the atomics ----
+// A LevelIntegral tracks a piecewise-constant level (busy 0/1, a queue length)
+// and its integral over simulated time. Each set() folds the old level over
+// the time since the previous change into the area: O(1), with no logging. The
+// atomics call it after every transition with their own clock, which is
+// advanced by the elapsed time `e` (external) or sigma (internal). `peak` is
+// the high-water mark: the largest level seen after any transition.
+struct LevelIntegral {
+    double level = 0.0;
+    double since = 0.0;    // time of the last set()
+    double area  = 0.0;    // integral of level from `start` to `since`
+    double start = 0.0;
+    double peak  = 0.0;
+
+    void set(double now, double newLevel) {
+        if (now > since) {
+            area += level * (now - since);
+            since = now;
+        }
+        level = newLevel;
+        peak  = std::max(peak, newLevel);
+    }
+
+    // Integral and time average up to `now` (>= the last set()).
+    double integral(double now) const { return area + level * std::max(0.0, now - since); }
+    double mean(double now) const {
+        const double span = now - start;
+        return span > 0.0 ? integral(now) / span : level;
+    }
+};
+
+// What each single-queue station reports at the end of a run.
+struct StationKpis {
+    double busyTime    = 0.0;   // server-seconds spent serving
+    double utilisation = 0.0;   // busyTime / (servers x elapsed)
+    double meanQueue   = 0.0;   // time-averaged number waiting (not in service)
+};
+
+#endif // TIME_WEIGHTED_HPP